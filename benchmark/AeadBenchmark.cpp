@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <openssl/rand.h>
+#include "SessionCipher.h"
+#include "Config.h"
+
+using namespace std;
+
+/**
+ * Encrypt and decrypt messages of the given size with a cipher suite and print the per-byte cost
+ * @param suite The cipher suite to measure
+ * @param message_len The size of each message in bytes
+ * @param total_bytes The amount of data encrypted (and decrypted) during the measure
+ */
+void benchmarkSuite(CipherSuite suite, size_t message_len, size_t total_bytes) {
+    unsigned char key[Config::AES_KEY_LEN];
+    RAND_bytes(key, Config::AES_KEY_LEN);
+    SessionCipher sender(key, SessionCipher::Role::SERVER, suite);
+    SessionCipher receiver(key, SessionCipher::Role::CLIENT, suite);
+
+    auto *plaintext = new unsigned char[message_len];
+    auto *ciphertext = new unsigned char[message_len];
+    RAND_bytes(plaintext, static_cast<int>(message_len));
+    unsigned char aad[Config::AAD_LEN] = {};
+    unsigned char iv[Config::IV_LEN];
+    unsigned char tag[Config::AES_TAG_LEN];
+    size_t messages_num = max<size_t>(1, total_bytes / message_len);
+
+    // Encryption
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < messages_num; ++i) {
+        sender.encrypt(static_cast<uint32_t>(i), plaintext, static_cast<int>(message_len), aad,
+                       Config::AAD_LEN, iv, ciphertext, tag);
+    }
+    chrono::duration<double> encrypt_time = chrono::steady_clock::now() - start;
+
+    // Decryption of the last message, repeated (the tag of the other ones has been overwritten)
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < messages_num; ++i) {
+        if (receiver.decrypt(ciphertext, static_cast<int>(message_len), aad, Config::AAD_LEN, iv, tag,
+                             plaintext) == -1) {
+            cerr << "AeadBenchmark - Error during decryption" << endl;
+            break;
+        }
+    }
+    chrono::duration<double> decrypt_time = chrono::steady_clock::now() - start;
+
+    double bytes = static_cast<double>(messages_num * message_len);
+    cout << left << setw(20) << SessionCipher::getSuiteName(suite) << setw(12) << message_len
+         << fixed << setprecision(3)
+         << setw(16) << encrypt_time.count() * 1e9 / bytes
+         << setw(16) << decrypt_time.count() * 1e9 / bytes
+         << setprecision(0) << bytes / encrypt_time.count() / (Config::KB_SIZE * Config::KB_SIZE) << endl;
+
+    delete[] plaintext;
+    delete[] ciphertext;
+}
+
+/**
+ * Measure the per-byte cost of the cipher suites on this host, for the sizes of the command messages
+ * and of the chunks. The suite with the lowest cost is the one to request with the --cipher option of
+ * the client (AES-128-GCM is usually faster with AES-NI, ChaCha20-Poly1305 without it).
+ */
+int main(int argc, char *argv[]) {
+    size_t total_bytes = 256 * Config::KB_SIZE * Config::KB_SIZE;
+    if (argc > 1 && atol(argv[1]) > 0) {
+        total_bytes = atol(argv[1]) * Config::KB_SIZE * Config::KB_SIZE;
+    }
+
+    cout << left << setw(20) << "Suite" << setw(12) << "Message B" << setw(16) << "Encrypt ns/B"
+         << setw(16) << "Decrypt ns/B" << "Encrypt MB/s" << endl;
+    for (size_t message_len : {static_cast<size_t>(Config::MAX_PACKET_SIZE),
+                               static_cast<size_t>(Config::MIN_CHUNK_SIZE),
+                               static_cast<size_t>(Config::CHUNK_SIZE)}) {
+        for (CipherSuite suite : {CipherSuite::AES_128_GCM, CipherSuite::CHACHA20_POLY1305}) {
+            benchmarkSuite(suite, message_len, total_bytes);
+        }
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <ctime>
 #include <iostream>
 #include <openssl/pem.h>
 #include <openssl/x509.h>
@@ -15,27 +16,47 @@ using namespace std;
  * Without it get the error to trying to access memory not allocated.
  */
 CertificateManager* CertificateManager::m_certificate_manager_instance = nullptr;
+mutex CertificateManager::m_instance_mutex;
 
 
 /**
- * CertificateManager Constructor. Performs the following operations:
+ * CertificateManager Constructor. Loads the Certificate Store used to verify the certificates
+ */
+CertificateManager::CertificateManager() {
+    m_certificate_store = loadStore();
+}
+
+
+/**
+ * Function to build the Certificate Store, performs the following operations:
  * 1) Loads the CA Certificate from a file
  * 2) Loads the Certificate Revocation List (CRL) from a file
  * 3) Creates a new Certificate Store and stores the certificates loaded (CA and CRL)
  * 4) Frees the memory allocated for CA Certificate and CRL
+ * The modification times of the two files are saved to detect when the store has to be built again
+ * @return the Certificate Store, nullptr if an error occurred
  */
-CertificateManager::CertificateManager() {
+X509_STORE* CertificateManager::loadStore() {
+
+    //Save the modification times before reading, a change during the loading is seen by the next verification
+    error_code error;
+    m_ca_certificate_mtime = filesystem::last_write_time(CA_CERTIFICATE_PATH, error);
+    m_crl_mtime = filesystem::last_write_time(CRL_PATH, error);
 
     //1)CA Certificate reading and loading
     //Allocates the X509 CA certificate structure and loads it from a PEM file
     X509* ca_certificate = loadCertificate(CA_CERTIFICATE_PATH);
+    if (!ca_certificate) {
+        return nullptr;
+    }
 
     //2)CRL File (Certificate Revocation List) reading and loading
     //opening the Certificate Revocation List file and check the correctness
     FILE* crl_fp = fopen(CRL_PATH, "r");
     if (!crl_fp) {
         cerr << "CertificateManager - Failed to open the CRL file" << endl;
-        return;
+        X509_free(ca_certificate);
+        return nullptr;
     }
     //Allocates the X509 Certificate Revocation List structure and loads it from a PEM file
     X509_CRL* crl = PEM_read_X509_CRL(crl_fp, NULL, NULL, NULL);
@@ -44,36 +65,39 @@ CertificateManager::CertificateManager() {
     fclose(crl_fp);
     if (!crl) {
         cerr << "CertificateManager - Failed to load the CRL structure" << endl;
-        return;
+        X509_free(ca_certificate);
+        return nullptr;
     }
 
     //3)Allocate a new Certificate Store and save the certificates loaded (certificate and CRL)
     //Allocates an empty store and (returns NULL if an error occurred)
-    m_certificate_store = X509_STORE_new();
-    if (!m_certificate_store) {
+    X509_STORE* certificate_store = X509_STORE_new();
+    if (!certificate_store) {
         cerr << "CertificateManager - Failed to create the store" << endl;
-        return;
     }
     //Adds the CA certificate (trusted) to the store
-    if (X509_STORE_add_cert(m_certificate_store, ca_certificate) != 1) {
+    else if (X509_STORE_add_cert(certificate_store, ca_certificate) != 1) {
         cerr << "CertificateManager - Failed to add CA certificate to the store" << endl;
-        return;
+        X509_STORE_free(certificate_store);
+        certificate_store = nullptr;
     }
     //Adds the CRL (trusted) to the store
-    if (X509_STORE_add_crl(m_certificate_store, crl) != 1) {
+    else if (X509_STORE_add_crl(certificate_store, crl) != 1) {
         cerr << "CertificateManager - Failed to add CRL to the store" << endl;
-        return;
+        X509_STORE_free(certificate_store);
+        certificate_store = nullptr;
     }
-
     //Configures the store to check against the CRL every valid certificate before returning a successful validation
-    if (X509_STORE_set_flags(m_certificate_store, X509_V_FLAG_CRL_CHECK) != 1) {
+    else if (X509_STORE_set_flags(certificate_store, X509_V_FLAG_CRL_CHECK) != 1) {
         cerr << "CertificateManager - Failed set the store flags" << endl;
-        return;
+        X509_STORE_free(certificate_store);
+        certificate_store = nullptr;
     }
 
     //4)Free the memory allocated for the X.509 certificate and X.509 Certificate Revocation List (CRL) structures
     X509_free(ca_certificate);
     X509_CRL_free(crl);
+    return certificate_store;
 }
 
 
@@ -104,37 +128,118 @@ X509 *CertificateManager::loadCertificate(const char* certificate_path) {
 
 
 /**
- * Function to verify the received certificates
+ * Function to get the Certificate Store to verify a certificate, built again if the CA certificate or
+ * the CRL file has been modified since it was loaded (in that case the verified certificates are forgotten)
+ * @param fingerprint fingerprint of the certificate to verify
+ * @param verified set to true if the certificate has already been verified and has not expired
+ * @return the Certificate Store (to be freed by the caller), nullptr if it is not available or not needed
+ */
+X509_STORE* CertificateManager::getStore(const string& fingerprint, bool& verified) {
+    lock_guard<mutex> lock(m_store_mutex);
+
+    error_code error;
+    if (filesystem::last_write_time(CA_CERTIFICATE_PATH, error) != m_ca_certificate_mtime ||
+        filesystem::last_write_time(CRL_PATH, error) != m_crl_mtime) {
+        m_verified_certificates.clear();
+        X509_STORE_free(m_certificate_store);
+        m_certificate_store = loadStore();
+    }
+
+    auto verified_certificate = m_verified_certificates.find(fingerprint);
+    verified = verified_certificate != m_verified_certificates.end() && verified_certificate->second > time(nullptr);
+    if (verified || !m_certificate_store) {
+        return nullptr;
+    }
+
+    //The store can be replaced by another thread during the verification, a reference is taken
+    X509_STORE_up_ref(m_certificate_store);
+    return m_certificate_store;
+}
+
+
+/**
+ * Function to verify the received certificates. A certificate already verified with the current CA
+ * certificate and CRL is accepted from the cache until it expires, without building its chain again
  * @param certificate Certificate to verify
  * @return
  */
 bool CertificateManager::verifyCertificate(X509 *certificate) {
 
+    string fingerprint = getFingerprint(certificate);
+    if (fingerprint.empty()) {
+        return false;
+    }
+    bool verified = false;
+    X509_STORE* certificate_store = getStore(fingerprint, verified);
+    if (verified) {
+        return true;
+    }
+    if (!certificate_store) {
+        cerr << "CertificateManager - Certificate store not available" << endl;
+        return false;
+    }
+
     //Allocates a new certificate-verification context
     X509_STORE_CTX* certificate_verification_ctx = X509_STORE_CTX_new();
     if (!certificate_verification_ctx) {
         cerr << "CertificateManager - Failed to create the certificate-verification context" << endl;
+        X509_STORE_free(certificate_store);
         return false;
     }
 
     //Initializes the certificate-verification context (context, store and certificate to verify)
-    if (X509_STORE_CTX_init(certificate_verification_ctx, m_certificate_store, certificate,NULL) != 1) {
+    if (X509_STORE_CTX_init(certificate_verification_ctx, certificate_store, certificate,NULL) != 1) {
         cerr << "CertificateManager - Failed to initialize the certificate-verification context" << endl;
+        X509_STORE_CTX_free(certificate_verification_ctx);
+        X509_STORE_free(certificate_store);
         return false;
     }
 
     //Verifies the certificate passed at initialization time
-    if (X509_verify_cert(certificate_verification_ctx) != 1) {
+    int result = X509_verify_cert(certificate_verification_ctx);
+
+    //Deallocates the certificate-verification context
+    X509_STORE_CTX_free(certificate_verification_ctx);
+    if (result != 1) {
         cerr << "CertificateManager - Certificate verification failed!" << endl;
+        X509_STORE_free(certificate_store);
         return false;
     }
 
-    //Deallocates the certificate-verification context
-    X509_STORE_CTX_free(certificate_verification_ctx);
+    //Save the verification, unless the store has been replaced in the meantime
+    ASN1_TIME* not_after = X509_get_notAfter(certificate);
+    time_t expiration_time = 0;
+    struct tm expiration_tm = {};
+    if (ASN1_TIME_to_tm(not_after, &expiration_tm) == 1) {
+        expiration_time = timegm(&expiration_tm);
+    }
+    {
+        lock_guard<mutex> lock(m_store_mutex);
+        if (certificate_store == m_certificate_store) {
+            m_verified_certificates[fingerprint] = expiration_time;
+        }
+    }
+    X509_STORE_free(certificate_store);
     return true;
 }
 
 
+/**
+ * Function to compute the SHA-256 fingerprint of a certificate
+ * @param certificate certificate from which compute the fingerprint
+ * @return the fingerprint, an empty string if an error occurred
+ */
+string CertificateManager::getFingerprint(X509 *certificate) {
+    unsigned char fingerprint[EVP_MAX_MD_SIZE];
+    unsigned int fingerprint_len = 0;
+    if (!certificate || X509_digest(certificate, EVP_sha256(), fingerprint, &fingerprint_len) != 1) {
+        cerr << "CertificateManager - Failed to compute the certificate fingerprint" << endl;
+        return "";
+    }
+    return string(reinterpret_cast<char*>(fingerprint), fingerprint_len);
+}
+
+
 /**
  * Function to extract the public key from the certificate
  * @param certificate certificate from which extract the public key
@@ -149,7 +254,7 @@ EVP_PKEY *CertificateManager::getPublicKey(X509 *certificate) {
 
 
 /**
- * Function to serializeLogoutMessage a certificate (when has to be sent)
+ * Function to serialize a certificate (when has to be sent) in DER format
  * @param certificate_to_serialize certificate to be serialized
  * @param certificate_pointer pointer to the certificate structure which has to be serialized
  * @param certificate_size_pointer pointer to the size value of the certificate (to be updated with the serialized size value)
@@ -157,87 +262,104 @@ EVP_PKEY *CertificateManager::getPublicKey(X509 *certificate) {
  */
 int CertificateManager::serializeCertificate(X509* certificate_to_serialize, uint8_t*& certificate_pointer, int& certificate_size_pointer) {
 
-    // Create a BIO (memory-based I/O) object to store serialized data
-    BIO* bio = BIO_new(BIO_s_mem());
-    if (!bio) {
-        cerr << "CertificateManager - Failed to create BIO" << endl;
-        return -1;
-    }
-
-    // Write the X.509 certificate to the BIO in PEM format
-    if (!PEM_write_bio_X509(bio, certificate_to_serialize)) {
-        cerr << "CertificateManager - Failed to write the certificate in the BIO" << endl;
-        BIO_free(bio);
+    // Determine the size of the DER encoding and update the certificate size variable
+    certificate_size_pointer = i2d_X509(certificate_to_serialize, nullptr);
+    if (certificate_size_pointer <= 0) {
+        cerr << "CertificateManager - Failed to encode the certificate" << endl;
         return -1;
     }
 
-    // Determine the size of the serialized data in the BIO and update the certificate size variable
-    certificate_size_pointer = BIO_pending(bio);
-
     // Allocate memory for the serialized certificate (array of uint8_t) and update the certificate pointer
     certificate_pointer = new uint8_t[certificate_size_pointer];
 
-    // Check if the serialized data written in the BIO allocated memory was successful
-    if (BIO_read(bio, certificate_pointer, certificate_size_pointer) != certificate_size_pointer) {
-        cerr << "CertificateManager - Failed to read the serialized certificate" << endl;
-        //Free the memory associated with the BIO
-        BIO_free(bio);
+    // Write the DER encoding (i2d_X509 advances the pointer it receives, so a copy is passed)
+    uint8_t* write_pointer = certificate_pointer;
+    if (i2d_X509(certificate_to_serialize, &write_pointer) != certificate_size_pointer) {
+        cerr << "CertificateManager - Failed to write the serialized certificate" << endl;
         //Free the memory allocated for the serialized certificate
         delete[] certificate_pointer;
+        certificate_pointer = nullptr;
         return -1;
     }
 
-    //Free the memory associated with the BIO
-    BIO_free(bio);
-
     // Return success status
     return 0;
 }
 
 
 /**
- * Function to deserialize a certificate (when it is received)
+ * Function to deserialize a certificate (when it is received) from DER format
  * @param certificate_pointer pointer to the certificate structure which has to be deserialized
  * @param certificate_size_pointer pointer to the size value of the certificate (to be updated with the deserialized size value)
  * @return the pointer to the deserialized certificate
  */
-X509* CertificateManager::deserializeCertificate(uint8_t* certificate_pointer, int certificate_size_pointer) {
+X509* CertificateManager::deserializeCertificate(const uint8_t* certificate_pointer, int certificate_size_pointer) {
 
-    // Create a BIO (memory-based I/O) object to read serialized data and deserialize it
-    BIO* bio = BIO_new_mem_buf(certificate_pointer, certificate_size_pointer);
-    if (!bio) {
-        cerr << "CertificateManager - Failed to create BIO" << endl;
-        return nullptr;  // nullptr indicates failure
-    }
-
-    // Initialize the pointer for the deserialized X.509 certificate
-    X509* deserialized_certificate = nullptr;
-
-    //Read the X.509 certificate from the BIO in PEM format
-    deserialized_certificate = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    //Read the X.509 certificate from the DER encoding (d2i_X509 advances the pointer it receives)
+    const uint8_t* read_pointer = certificate_pointer;
+    X509* deserialized_certificate = d2i_X509(nullptr, &read_pointer, certificate_size_pointer);
 
     // Check if the certificate deserialization was successful
     if (!deserialized_certificate) {
         cerr << "CertificateManager - Failed to deserialize the certificate" << endl;
-        //Free the memory associated with the BIO
-        BIO_free(bio);
         return nullptr;
     }
 
-    //Free the memory associated with the BIO
-    BIO_free(bio);
-
     // Return the pointer to the deserialized X.509 certificate
     return deserialized_certificate;
 }
 
 
+/**
+ * Function to get the serialized server certificate. The certificate is loaded and serialized by the
+ * first call only, the following calls (from any session thread) return the same read-only buffer.
+ * @param certificate_pointer pointer to the serialized certificate, owned by the certificate manager
+ * @param certificate_size_pointer size of the serialized certificate
+ * @return 0 if the certificate is available, -1 otherwise
+ */
+int CertificateManager::getServerCertificate(const uint8_t*& certificate_pointer, int& certificate_size_pointer) {
+    call_once(m_server_certificate_flag, [this] {
+        X509* certificate = loadCertificate(SERVER_CERTIFICATE_PATH);
+        if (!certificate) {
+            return;
+        }
+        if (serializeCertificate(certificate, m_server_certificate, m_server_certificate_len) != 0) {
+            m_server_certificate = nullptr;
+            m_server_certificate_len = 0;
+        }
+        X509_free(certificate);
+    });
+
+    if (!m_server_certificate) {
+        return -1;
+    }
+    certificate_pointer = m_server_certificate;
+    certificate_size_pointer = m_server_certificate_len;
+    return 0;
+}
+
+
 /**
  * CertificateManager Destructor. Free the memory for the allocated Certificate Store
  */
 CertificateManager::~CertificateManager() {
-    //Deallocates the Certificate Store
+    //Deallocates the Certificate Store and the serialized server certificate
     X509_STORE_free(m_certificate_store);
+    delete[] m_server_certificate;
+}
+
+
+/**
+ * Function to manage the singleton (check and allocate the singleton class), safe to be called
+ * by many session threads at the same time
+ * @return the certificate manager instance
+ */
+CertificateManager* CertificateManager::getInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    if (!m_certificate_manager_instance) {
+        m_certificate_manager_instance = new CertificateManager();
+    }
+    return m_certificate_manager_instance;
 }
 
 
@@ -245,6 +367,7 @@ CertificateManager::~CertificateManager() {
  * Function to deallocate the singleton from memory
  */
 void CertificateManager::deleteInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
     //Deletes the certificate manager instance pointer
     delete m_certificate_manager_instance;
     //Set the instance pointer to null in order to allocate again the singleton
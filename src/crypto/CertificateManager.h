@@ -1,7 +1,10 @@
 #ifndef SECURE_CLOUD_STORAGE_CERTIFICATEMANAGER_H
 #define SECURE_CLOUD_STORAGE_CERTIFICATEMANAGER_H
 
+#include <filesystem>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <openssl/x509.h>
 #include <openssl/x509_vfy.h>
 
@@ -10,11 +13,28 @@ using namespace std;
 
 class CertificateManager {
 private:
-    X509_STORE* m_certificate_store;
+    X509_STORE* m_certificate_store = nullptr;
     static CertificateManager* m_certificate_manager_instance;
+    static mutex m_instance_mutex;
+
+    // Fingerprints (SHA-256) of the certificates already verified, with their expiration time. The cache and
+    // the store are rebuilt when the CA certificate or the CRL file is modified
+    unordered_map<string, time_t> m_verified_certificates;
+    filesystem::file_time_type m_ca_certificate_mtime;
+    filesystem::file_time_type m_crl_mtime;
+    mutex m_store_mutex;
+
+    // Server certificate serialized once and sent unchanged in every AuthenticationM3 message
+    uint8_t* m_server_certificate = nullptr;
+    int m_server_certificate_len = 0;
+    once_flag m_server_certificate_flag;
 
     const char* CA_CERTIFICATE_PATH = "../resources/certificates/CA_cert.pem";
     const char* CRL_PATH = "../resources/certificates/CA_crl.pem";
+    const char* SERVER_CERTIFICATE_PATH = "../resources/certificates/Server_cert.pem";
+
+    X509_STORE* loadStore();
+    X509_STORE* getStore(const string& fingerprint, bool& verified);
 
 public:
     CertificateManager();
@@ -22,20 +42,15 @@ public:
 
     X509* loadCertificate(const char* certificate_path);
     bool verifyCertificate(X509* certificate);
+    static string getFingerprint(X509* certificate);
     EVP_PKEY* getPublicKey(X509* certificate);
     int serializeCertificate(X509 *certificate, uint8_t *&certificate_pointer, int &certificate_size_pointer);
-    X509* deserializeCertificate(uint8_t* certificate_pointer, int certificate_size_pointer);
+    X509* deserializeCertificate(const uint8_t* certificate_pointer, int certificate_size_pointer);
+    int getServerCertificate(const uint8_t*& certificate_pointer, int& certificate_size_pointer);
 
+    static CertificateManager* getInstance();
     static void deleteInstance();
 
-    //Function to manage the singleton (check and allocate the singleton class)
-    static CertificateManager* getInstance() {
-        if(!m_certificate_manager_instance) {
-            m_certificate_manager_instance = new CertificateManager();
-        }
-        return m_certificate_manager_instance;
-    }
-
 };
 
 
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <future>
+#include "CryptoExecutor.h"
+#include "Config.h"
+
+CryptoExecutor* CryptoExecutor::m_crypto_executor_instance = nullptr;
+mutex CryptoExecutor::m_instance_mutex;
+
+/**
+ * @brief Constructor for the CryptoExecutor class, starts the workers.
+ * @param workers_num The number of threads running the cryptographic tasks.
+ * @param queue_capacity The max number of tasks waiting for a worker.
+ */
+CryptoExecutor::CryptoExecutor(unsigned int workers_num, size_t queue_capacity)
+        : m_workers(workers_num, queue_capacity) {}
+
+/**
+ * @brief Destructor for the CryptoExecutor class, runs the queued tasks and joins the workers.
+ */
+CryptoExecutor::~CryptoExecutor() {
+    m_workers.shutdown();
+}
+
+/**
+ * @brief Run a task on a crypto worker and wait for its result.
+ * @param task The cryptographic operation, returning its result code.
+ * @return The result of the task.
+ * @details If the executor is shutting down the task is run by the caller.
+ */
+int CryptoExecutor::run(const function<int()>& task) {
+    using clock = chrono::steady_clock;
+    auto queued_time = clock::now();
+    promise<int> result;
+    future<int> future_result = result.get_future();
+
+    bool submitted = m_workers.submit([this, &task, &result, queued_time] {
+        auto start_time = clock::now();
+        int task_result = task();
+        auto end_time = clock::now();
+
+        // Update the metrics before waking the caller up
+        auto wait_time = static_cast<uint64_t>(
+                chrono::duration_cast<chrono::microseconds>(start_time - queued_time).count());
+        m_tasks_num++;
+        m_total_wait_time += wait_time;
+        m_total_run_time += static_cast<uint64_t>(
+                chrono::duration_cast<chrono::microseconds>(end_time - start_time).count());
+        uint64_t max_wait_time = m_max_wait_time;
+        while (wait_time > max_wait_time && !m_max_wait_time.compare_exchange_weak(max_wait_time, wait_time)) {}
+
+        result.set_value(task_result);
+    });
+    if (!submitted) {
+        return task();
+    }
+    return future_result.get();
+}
+
+/**
+ * @brief Get the metrics of the executor.
+ * @return The counters of the executed tasks and the current load of the queue and of the workers.
+ */
+CryptoExecutor::Metrics CryptoExecutor::getMetrics() {
+    return {m_tasks_num, m_total_wait_time, m_max_wait_time, m_total_run_time,
+            m_workers.getPendingTasksNum(), m_workers.getActiveTasksNum()};
+}
+
+/**
+ * @brief Get the number of crypto workers.
+ * @return The number of threads running the cryptographic tasks.
+ */
+unsigned int CryptoExecutor::getWorkersNum() const {
+    return m_workers.getWorkersNum();
+}
+
+/**
+ * @brief Get the executor shared by the sessions, starting its workers on the first call.
+ * @return The CryptoExecutor instance.
+ */
+CryptoExecutor* CryptoExecutor::getInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    if (!m_crypto_executor_instance) {
+        m_crypto_executor_instance = new CryptoExecutor(Config::CRYPTO_WORKERS, Config::CRYPTO_QUEUE_LEN);
+    }
+    return m_crypto_executor_instance;
+}
+
+/**
+ * @brief Stop the workers and delete the executor instance.
+ */
+void CryptoExecutor::deleteInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    delete m_crypto_executor_instance;
+    m_crypto_executor_instance = nullptr;
+}
@@ -0,0 +1,52 @@
+#ifndef SECURE_CLOUD_STORAGE_CRYPTOEXECUTOR_H
+#define SECURE_CLOUD_STORAGE_CRYPTOEXECUTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include "WorkerPool.h"
+
+using namespace std;
+
+/**
+ * Bounded executor of the public-key operations of the handshakes (key derivation, signature and
+ * verification). A burst of logins is queued to a few dedicated threads instead of taking every core,
+ * so the sessions already transferring files keep their share of the CPU. The caller waits for the
+ * result of its task; when the queue is full it waits for a free slot.
+ */
+class CryptoExecutor {
+public:
+    // Counters of the executed tasks, in microseconds for the times
+    struct Metrics {
+        uint64_t tasks_num;
+        uint64_t total_wait_time;   // Time spent by the tasks in the queue
+        uint64_t max_wait_time;
+        uint64_t total_run_time;    // Time spent by the workers running the tasks
+        size_t pending_tasks_num;
+        size_t active_tasks_num;
+    };
+
+    int run(const function<int()>& task);
+    Metrics getMetrics();
+    unsigned int getWorkersNum() const;
+
+    static CryptoExecutor* getInstance();
+    static void deleteInstance();
+
+private:
+    static CryptoExecutor* m_crypto_executor_instance;
+    static mutex m_instance_mutex;
+
+    WorkerPool m_workers;
+    atomic<uint64_t> m_tasks_num{0};
+    atomic<uint64_t> m_total_wait_time{0};
+    atomic<uint64_t> m_max_wait_time{0};
+    atomic<uint64_t> m_total_run_time{0};
+
+    CryptoExecutor(unsigned int workers_num, size_t queue_capacity);
+    ~CryptoExecutor();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_CRYPTOEXECUTOR_H
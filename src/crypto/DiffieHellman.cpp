@@ -3,15 +3,19 @@
 #include <openssl/evp.h>
 #include <openssl/pem.h>
 #include "DiffieHellman.h"
+#include "Config.h"
 
 using namespace std;
 
 /**
  * @brief DiffieHellman class constructor
+ * @param key_exchange The group of the key exchange: the 2048-bit finite field group or X25519
  */
-DiffieHellman::DiffieHellman() {
-    DH* dh_structure = generateLowLevelStructure();
-    loadDHParameters(dh_structure);
+DiffieHellman::DiffieHellman(KeyExchange key_exchange) : m_key_exchange(key_exchange) {
+    if (m_key_exchange == KeyExchange::FFDHE_2048) {
+        DH* dh_structure = generateLowLevelStructure();
+        loadDHParameters(dh_structure);
+    }
 }
 
 /**
@@ -28,6 +32,23 @@ EVP_PKEY *DiffieHellman::getDhParameters() const {
     return m_dh_parameters;
 }
 
+/**
+ * @brief Get the group of the key exchange
+ */
+KeyExchange DiffieHellman::getKeyExchange() const {
+    return m_key_exchange;
+}
+
+/**
+ * @brief Check if a key exchange group received from the peer is known
+ * @param key_exchange The key exchange code
+ * @return true if the group can be used for the handshake, false otherwise
+ */
+bool DiffieHellman::isSupported(uint8_t key_exchange) {
+    return key_exchange == static_cast<uint8_t>(KeyExchange::FFDHE_2048) ||
+           key_exchange == static_cast<uint8_t>(KeyExchange::X25519);
+}
+
 /**
  * @brief Create a new low-level DH structure and sets its parameters using predefined values
  */
@@ -109,9 +130,14 @@ void DiffieHellman::loadDHParameters(DH *dh_structure) {
  * @brief Generates an ephemeral key pair for Diffie-Hellman key exchange
  */
 EVP_PKEY * DiffieHellman::generateEphemeralKey() {
-    // Create context for the key generation
+    // Create context for the key generation, from the parameters or from the X25519 key type
     EVP_PKEY_CTX *dh_context;
-    if(!(dh_context = EVP_PKEY_CTX_new(m_dh_parameters, NULL))) {
+    if (m_key_exchange == KeyExchange::X25519) {
+        dh_context = EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, NULL);
+    } else {
+        dh_context = EVP_PKEY_CTX_new(m_dh_parameters, NULL);
+    }
+    if(!dh_context) {
         cerr << "DiffieHellman - Error in creating the key generation context" << endl;
     }
     // Generate a new key
@@ -128,7 +154,7 @@ EVP_PKEY * DiffieHellman::generateEphemeralKey() {
 }
 
 /**
- * @brief Serializes the provided ephemeral key into PEM format.
+ * @brief Serializes the provided ephemeral key into PEM format, or into its 32 raw bytes for X25519.
  * @param ephemeral_key The ephemeral key to be serialized (EVP_PKEY structure)
  * @param serialized_ephemeral_key The pointer to the buffer that will store the serialized key
  * @param serialized_ephemeral_key_length The integer reference that will store the size of the serialized key
@@ -136,6 +162,19 @@ EVP_PKEY * DiffieHellman::generateEphemeralKey() {
  */
 int DiffieHellman::serializeEphemeralKey(EVP_PKEY* ephemeral_key, uint8_t*& serialized_ephemeral_key,
                                          int& serialized_ephemeral_key_length) {
+    // The X25519 public value is sent as is
+    if (m_key_exchange == KeyExchange::X25519) {
+        size_t raw_key_length = Config::X25519_KEY_LEN;
+        serialized_ephemeral_key = new uint8_t[Config::X25519_KEY_LEN];
+        if (EVP_PKEY_get_raw_public_key(ephemeral_key, serialized_ephemeral_key, &raw_key_length) != 1) {
+            cerr << "DiffieHellman - Error in getting the raw X25519 public key" << endl;
+            delete[] serialized_ephemeral_key;
+            return -1;
+        }
+        serialized_ephemeral_key_length = static_cast<int>(raw_key_length);
+        return 0;
+    }
+
     // Create a new memory BIO structure
     BIO *bio = BIO_new(BIO_s_mem());
     if (!bio) {
@@ -179,6 +218,19 @@ int DiffieHellman::serializeEphemeralKey(EVP_PKEY* ephemeral_key, uint8_t*& seri
  * @return The deserialized ephemeral key (EVP_PKEY*), or nullptr on failure
  */
 EVP_PKEY* DiffieHellman::deserializeEphemeralKey(uint8_t* serialized_ephemeral_key, int serialized_ephemeral_key_length) {
+    if (m_key_exchange == KeyExchange::X25519) {
+        if (serialized_ephemeral_key_length != static_cast<int>(Config::X25519_KEY_LEN)) {
+            cerr << "DiffieHellman - Error! Invalid size of the X25519 public key" << endl;
+            return nullptr;
+        }
+        EVP_PKEY* deserialized_key = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, NULL, serialized_ephemeral_key,
+                                                                 Config::X25519_KEY_LEN);
+        if (!deserialized_key) {
+            cerr << "DiffieHellman - Error in reading the X25519 public key" << endl;
+        }
+        return deserialized_key;
+    }
+
     // Create a new memory BIO structure
     BIO *bio = BIO_new(BIO_s_mem());
     if (!bio) {
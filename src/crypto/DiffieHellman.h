@@ -5,17 +5,22 @@
 #include <openssl/evp.h>
 #include <openssl/pem.h>
 #include <cstdint>
+#include "CodesManager.h"
 
 class DiffieHellman {
 
 private:
-    // Diffie-Hellman parameters
-    EVP_PKEY *m_dh_parameters;
+    // Group of the key exchange
+    KeyExchange m_key_exchange;
+    // Diffie-Hellman parameters (nullptr for X25519, whose group is implied by the key type)
+    EVP_PKEY *m_dh_parameters = nullptr;
 
 public:
-    DiffieHellman();
+    explicit DiffieHellman(KeyExchange key_exchange = KeyExchange::FFDHE_2048);
     ~DiffieHellman();
     EVP_PKEY *getDhParameters() const;
+    KeyExchange getKeyExchange() const;
+    static bool isSupported(uint8_t key_exchange);
     DH * generateLowLevelStructure();
     void loadDHParameters(DH *pSt);
     EVP_PKEY * generateEphemeralKey();
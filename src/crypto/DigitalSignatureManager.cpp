@@ -3,31 +3,65 @@
 
 using namespace std;
 
-void DigitalSignatureManager::generateDS(unsigned char* input_buffer,
-                                         long int input_buffer_size,
-                                         unsigned char*& digital_signature,
-                                         unsigned int& digital_signature_size,
-                                         EVP_PKEY* private_key) {
+/**
+ * Get the digest to be used with a key: RSA keys sign a SHA-256 digest of the data, while Ed25519 signs
+ * the data itself and requires no digest
+ * @param key private or public key of the signature
+ * @return the digest, nullptr for Ed25519 keys
+ */
+static const EVP_MD* getDigest(EVP_PKEY* key) {
+    return EVP_PKEY_get_id(key) == EVP_PKEY_ED25519 ? nullptr : EVP_sha256();
+}
+
+/**
+ * Generate the digital signature of a buffer with the one-shot EVP_DigestSign API, using RSA with SHA-256
+ * or Ed25519 depending on the type of the private key
+ * @param input_buffer data to be signed
+ * @param input_buffer_size size of the data
+ * @param digital_signature buffer allocated with the signature (EVP_PKEY_size bytes at most)
+ * @param digital_signature_size actual size of the signature, 0 on failure
+ * @param private_key private key of the signer
+ * @return 0 on success, -1 on failure
+ */
+int DigitalSignatureManager::generateDS(unsigned char* input_buffer,
+                                        long int input_buffer_size,
+                                        unsigned char*& digital_signature,
+                                        unsigned int& digital_signature_size,
+                                        EVP_PKEY* private_key) {
 
     // Allocate memory for the digital signature buffer
-    digital_signature = new unsigned char[EVP_PKEY_size(private_key)];
+    size_t signature_size = EVP_PKEY_size(private_key);
+    digital_signature = new unsigned char[signature_size];
+    digital_signature_size = 0;
 
     // Create a new message digest context
     EVP_MD_CTX* ctx = EVP_MD_CTX_new();
 
-    // Initialize the signing process with SHA-256 algorithm
-    EVP_SignInit(ctx, EVP_sha256());
-
-    // Update the context with the input data
-    EVP_SignUpdate(ctx, input_buffer, input_buffer_size);
-
-    // Finalize the signing process and store the result in the digital signature buffer
-    EVP_SignFinal(ctx, digital_signature, &digital_signature_size, private_key);
+    // Initialize the signing process with the digest of the key type, then sign the input data in one shot
+    int result = 0;
+    if (!ctx || EVP_DigestSignInit(ctx, nullptr, getDigest(private_key), nullptr, private_key) != 1 ||
+        EVP_DigestSign(ctx, digital_signature, &signature_size, input_buffer, input_buffer_size) != 1) {
+        cerr << "DigitalSignatureManager - Failed to generate the digital signature" << endl;
+        result = -1;
+    } else {
+        digital_signature_size = static_cast<unsigned int>(signature_size);
+    }
 
     // Free the message digest context
     EVP_MD_CTX_free(ctx);
+    return result;
 }
 
+/**
+ * Verify the digital signature of a buffer with the one-shot EVP_DigestVerify API, using RSA with SHA-256
+ * or Ed25519 depending on the type of the public key
+ * @param input_buffer signed data
+ * @param input_buffer_size size of the data
+ * @param digital_signature signature to be verified
+ * @param digital_signature_size size of the signature
+ * @param public_key public key of the signer
+ * @return true if the signature is valid, false otherwise
+ */
 bool DigitalSignatureManager::isDSverified(unsigned char* input_buffer,
                                            long int input_buffer_size,
                                            unsigned char* digital_signature,
@@ -37,14 +71,11 @@ bool DigitalSignatureManager::isDSverified(unsigned char* input_buffer,
     // Create a new message digest context
     EVP_MD_CTX* ctx = EVP_MD_CTX_new();
 
-    // Initialize the verification process with SHA-256 algorithm
-    EVP_VerifyInit(ctx, EVP_sha256());
-
-    // Update the context with the input data
-    EVP_VerifyUpdate(ctx, input_buffer, input_buffer_size);
-
-    // Perform the verification and check the result
-    int res = EVP_VerifyFinal(ctx, digital_signature, digital_signature_size, public_key);
+    // Initialize the verification process with the digest of the key type, then verify the signature in one shot
+    int res = 0;
+    if (ctx && EVP_DigestVerifyInit(ctx, nullptr, getDigest(public_key), nullptr, public_key) == 1) {
+        res = EVP_DigestVerify(ctx, digital_signature, digital_signature_size, input_buffer, input_buffer_size);
+    }
 
     // Free the message digest context
     EVP_MD_CTX_free(ctx);
@@ -55,4 +86,4 @@ bool DigitalSignatureManager::isDSverified(unsigned char* input_buffer,
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -8,7 +8,7 @@ class DigitalSignatureManager {
 
 
 public:
-    void generateDS(unsigned char *input_buffer, long input_buffer_size, unsigned char *&digital_signature,
+    int generateDS(unsigned char *input_buffer, long input_buffer_size, unsigned char *&digital_signature,
                     unsigned int &digital_signature_size, EVP_PKEY *private_key);
 
     bool isDSverified(unsigned char *input_buffer, long input_buffer_size, unsigned char *digital_signature,
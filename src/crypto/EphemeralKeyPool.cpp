@@ -0,0 +1,147 @@
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "EphemeralKeyPool.h"
+#include "DiffieHellman.h"
+#include "Config.h"
+
+EphemeralKeyPool* EphemeralKeyPool::m_ephemeral_key_pool_instance = nullptr;
+mutex EphemeralKeyPool::m_instance_mutex;
+
+/**
+ * @brief Constructor for the EphemeralKeyPool class, starts the generator threads.
+ * @param generators_num The number of generator threads (at least one is always started).
+ * @param capacity The max number of ready keys of each key exchange group.
+ */
+EphemeralKeyPool::EphemeralKeyPool(unsigned int generators_num, size_t capacity) : m_capacity(capacity) {
+    if (generators_num == 0) {
+        generators_num = 1;
+    }
+    m_generators.reserve(generators_num);
+    for (unsigned int i = 0; i < generators_num; ++i) {
+        m_generators.emplace_back(&EphemeralKeyPool::generatorLoop, this);
+    }
+}
+
+/**
+ * @brief Destructor for the EphemeralKeyPool class, joins the generators and frees the unused keys.
+ */
+EphemeralKeyPool::~EphemeralKeyPool() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_refill_cv.notify_all();
+    for (auto &generator : m_generators) {
+        if (generator.joinable()) {
+            generator.join();
+        }
+    }
+    for (auto &keys : m_keys) {
+        for (EVP_PKEY* key : keys) {
+            EVP_PKEY_free(key);
+        }
+        keys.clear();
+    }
+}
+
+/**
+ * @brief Loop of a generator thread: refill the emptiest pool until both are full, then wait for a key to
+ * be taken.
+ */
+void EphemeralKeyPool::generatorLoop() {
+    // Lowest priority, the sessions are served first (on Linux the nice value is per thread)
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+
+    DiffieHellman ffdhe_instance(KeyExchange::FFDHE_2048);
+    DiffieHellman x25519_instance(KeyExchange::X25519);
+    DiffieHellman* dh_instances[2] = {&ffdhe_instance, &x25519_instance};
+    while (true) {
+        size_t group;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_refill_cv.wait(lock, [this] {
+                return m_stopping || m_keys[0].size() < m_capacity || m_keys[1].size() < m_capacity;
+            });
+            if (m_stopping) {
+                return;
+            }
+            group = m_keys[0].size() <= m_keys[1].size() ? 0 : 1;
+        }
+
+        // Generate the key without holding the lock
+        EVP_PKEY* key = dh_instances[group]->generateEphemeralKey();
+        if (key == nullptr) {
+            continue;
+        }
+
+        lock_guard<mutex> lock(m_mutex);
+        if (m_stopping || m_keys[group].size() >= m_capacity) {
+            EVP_PKEY_free(key);
+            continue;
+        }
+        m_keys[group].push_back(key);
+    }
+}
+
+/**
+ * @brief Take a ready ephemeral key pair of a key exchange group.
+ * @param key_exchange The group of the key exchange.
+ * @return The key pair, owned by the caller, or nullptr on failure.
+ * @details If no key is ready the key is generated by the caller.
+ */
+EVP_PKEY* EphemeralKeyPool::acquire(KeyExchange key_exchange) {
+    auto group = static_cast<size_t>(key_exchange);
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_keys[group].empty()) {
+            EVP_PKEY* key = m_keys[group].front();
+            m_keys[group].pop_front();
+            m_refill_cv.notify_one();
+            return key;
+        }
+    }
+    DiffieHellman dh_instance(key_exchange);
+    return dh_instance.generateEphemeralKey();
+}
+
+/**
+ * @brief Get the number of keys of a key exchange group ready to be taken.
+ * @param key_exchange The group of the key exchange.
+ * @return The number of ready keys.
+ */
+size_t EphemeralKeyPool::getAvailableKeysNum(KeyExchange key_exchange) {
+    lock_guard<mutex> lock(m_mutex);
+    return m_keys[static_cast<size_t>(key_exchange)].size();
+}
+
+/**
+ * @brief Get the max number of ready keys of each key exchange group.
+ * @return The capacity of the pool of a group.
+ */
+size_t EphemeralKeyPool::getCapacity() const {
+    return m_capacity;
+}
+
+/**
+ * @brief Get the pool shared by the sessions, starting its generators on the first call.
+ * @return The EphemeralKeyPool instance.
+ */
+EphemeralKeyPool* EphemeralKeyPool::getInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    if (!m_ephemeral_key_pool_instance) {
+        m_ephemeral_key_pool_instance = new EphemeralKeyPool(Config::EPHEMERAL_KEY_GENERATORS,
+                                                             Config::EPHEMERAL_KEY_POOL_LEN);
+    }
+    return m_ephemeral_key_pool_instance;
+}
+
+/**
+ * @brief Stop the generators and delete the pool instance.
+ */
+void EphemeralKeyPool::deleteInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    delete m_ephemeral_key_pool_instance;
+    m_ephemeral_key_pool_instance = nullptr;
+}
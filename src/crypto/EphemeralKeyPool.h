@@ -0,0 +1,50 @@
+#ifndef SECURE_CLOUD_STORAGE_EPHEMERALKEYPOOL_H
+#define SECURE_CLOUD_STORAGE_EPHEMERALKEYPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <openssl/evp.h>
+#include "CodesManager.h"
+
+using namespace std;
+
+/**
+ * Bounded pool of ephemeral key pairs generated ahead of the handshakes. Background threads with the lowest
+ * scheduling priority keep the pool of each key exchange group full, so they only run on idle cores, and a
+ * handshake pops a ready key instead of generating it before answering the AuthenticationM1 message.
+ * When a pool is empty the key is generated by the caller, as without the pool.
+ */
+class EphemeralKeyPool {
+private:
+    static EphemeralKeyPool* m_ephemeral_key_pool_instance;
+    static mutex m_instance_mutex;
+
+    vector<thread> m_generators;
+    // One queue of ready keys for each KeyExchange group, indexed by its code
+    deque<EVP_PKEY*> m_keys[2];
+    size_t m_capacity;
+    bool m_stopping = false;
+
+    mutex m_mutex;
+    condition_variable m_refill_cv;   // Signaled when a key is taken or the pool is stopped
+
+    EphemeralKeyPool(unsigned int generators_num, size_t capacity);
+    ~EphemeralKeyPool();
+
+    void generatorLoop();
+
+public:
+    EVP_PKEY* acquire(KeyExchange key_exchange);
+    size_t getAvailableKeysNum(KeyExchange key_exchange);
+    size_t getCapacity() const;
+
+    static EphemeralKeyPool* getInstance();
+    static void deleteInstance();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_EPHEMERALKEYPOOL_H
@@ -1,5 +1,69 @@
 #include "Hash.h"
-#include <openssl/evp.h>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Prefixes of the tree hash inputs, so that a leaf digest cannot be taken for the root digest
+    const unsigned char LEAF_PREFIX = 0x00;
+    const unsigned char ROOT_PREFIX = 0x01;
+}
+
+/**
+ * @brief Constructor of the streaming hasher, ready to receive the data.
+ */
+Hash::Hash() : m_ctx(EVP_MD_CTX_new()) {
+    init();
+}
+
+/**
+ * @brief Destructor of the streaming hasher.
+ */
+Hash::~Hash() {
+    EVP_MD_CTX_free(m_ctx);
+}
+
+/**
+ * @brief Start a new digest, discarding the data received so far.
+ * @return 0 on success, -1 on failure.
+ */
+int Hash::init() {
+    if (!m_ctx || EVP_DigestInit_ex(m_ctx, EVP_sha256(), nullptr) != 1) {
+        cerr << "Hash - Error during the initialization of the digest" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Add a piece of data to the digest.
+ * @param input_buffer The data.
+ * @param input_buffer_size The size of the data.
+ * @return 0 on success, -1 on failure.
+ */
+int Hash::update(const unsigned char *input_buffer, size_t input_buffer_size) {
+    if (EVP_DigestUpdate(m_ctx, input_buffer, input_buffer_size) != 1) {
+        cerr << "Hash - Error during the update of the digest" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Complete the digest of the data received since the last init.
+ * @param digest The buffer receiving the digest, DIGEST_LEN bytes.
+ * @return 0 on success, -1 on failure.
+ */
+int Hash::finalize(unsigned char *digest) {
+    unsigned int digest_size = 0;
+    if (EVP_DigestFinal_ex(m_ctx, digest, &digest_size) != 1 || digest_size != DIGEST_LEN) {
+        cerr << "Hash - Error during the finalization of the digest" << endl;
+        return -1;
+    }
+    return 0;
+}
 
 void Hash::generateSHA256(unsigned char* input,
                           size_t input_size,
@@ -24,3 +88,88 @@ void Hash::generateSHA256(unsigned char* input,
     // Free the memory associated with the context
     EVP_MD_CTX_free(ctx);
 }
+
+/**
+ * @brief Constructor of the tree hash.
+ * @param leaves_num The number of leaves of the data.
+ */
+TreeHash::TreeHash(size_t leaves_num) : m_leaf_digests(leaves_num), m_hashed_leaves(leaves_num, 0) {}
+
+/**
+ * @brief Hash a leaf of the data. Different leaves can be hashed at the same time by different threads.
+ * @param leaf_index The position of the leaf in the data.
+ * @param input_buffer The data of the leaf.
+ * @param input_buffer_size The size of the leaf.
+ * @return 0 on success, -1 on failure.
+ */
+int TreeHash::hashLeaf(size_t leaf_index, const unsigned char *input_buffer, size_t input_buffer_size) {
+    if (leaf_index >= m_leaf_digests.size()) {
+        cerr << "TreeHash - Error! Leaf " << leaf_index << " out of range" << endl;
+        return -1;
+    }
+    Hash hash;
+    if (hash.update(&LEAF_PREFIX, sizeof(LEAF_PREFIX)) != 0 ||
+        hash.update(input_buffer, input_buffer_size) != 0 ||
+        hash.finalize(m_leaf_digests[leaf_index].data()) != 0) {
+        return -1;
+    }
+    m_hashed_leaves[leaf_index] = 1;
+    return 0;
+}
+
+/**
+ * @brief Compute the root digest, once every leaf has been hashed.
+ * @param digest The buffer receiving the digest, Hash::DIGEST_LEN bytes.
+ * @return 0 on success, -1 if a leaf is missing or on failure.
+ */
+int TreeHash::finalize(unsigned char *digest) {
+    if (find(m_hashed_leaves.begin(), m_hashed_leaves.end(), 0) != m_hashed_leaves.end()) {
+        cerr << "TreeHash - Error! Not every leaf has been hashed" << endl;
+        return -1;
+    }
+    Hash hash;
+    if (hash.update(&ROOT_PREFIX, sizeof(ROOT_PREFIX)) != 0) {
+        return -1;
+    }
+    for (const auto& leaf_digest : m_leaf_digests) {
+        if (hash.update(leaf_digest.data(), leaf_digest.size()) != 0) {
+            return -1;
+        }
+    }
+    return hash.finalize(digest);
+}
+
+/**
+ * @brief Compute the tree hash of a buffer, hashing its leaves on several threads.
+ * @param input_buffer The data.
+ * @param input_buffer_size The size of the data.
+ * @param leaf_size The size of the leaves.
+ * @param threads_num The number of threads hashing the leaves.
+ * @param digest The buffer receiving the digest, Hash::DIGEST_LEN bytes.
+ * @return 0 on success, -1 on failure.
+ */
+int TreeHash::generateTreeSHA256(const unsigned char *input_buffer, size_t input_buffer_size, size_t leaf_size,
+                                 unsigned int threads_num, unsigned char *digest) {
+    if (leaf_size == 0) {
+        return -1;
+    }
+    // Empty data has a single empty leaf
+    size_t leaves_num = max<size_t>(1, (input_buffer_size + leaf_size - 1) / leaf_size);
+    TreeHash tree_hash(leaves_num);
+    threads_num = static_cast<unsigned int>(min<size_t>(max(threads_num, 1U), leaves_num));
+
+    // Each thread hashes the leaves with its index modulo the number of threads
+    vector<thread> threads;
+    for (unsigned int t = 0; t < threads_num; ++t) {
+        threads.emplace_back([&tree_hash, input_buffer, input_buffer_size, leaf_size, leaves_num, threads_num, t] {
+            for (size_t i = t; i < leaves_num; i += threads_num) {
+                size_t offset = i * leaf_size;
+                tree_hash.hashLeaf(i, input_buffer + offset, min(leaf_size, input_buffer_size - offset));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return tree_hash.finalize(digest);
+}
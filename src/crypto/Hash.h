@@ -1,13 +1,57 @@
 #ifndef SECURE_CLOUD_STORAGE_HASH_H
 #define SECURE_CLOUD_STORAGE_HASH_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <openssl/evp.h>
 
+using namespace std;
+
+/**
+ * SHA-256 hasher. The one-shot generateSHA256 derives the keys, while a Hash object computes the digest of
+ * data received in several pieces (init, update for each piece, finalize) into a caller-provided buffer.
+ */
 class Hash {
+private:
+    EVP_MD_CTX* m_ctx;
 
 public:
+    static constexpr unsigned int DIGEST_LEN = 32;
+
+    Hash();
+    ~Hash();
+    Hash(const Hash&) = delete;
+    Hash& operator=(const Hash&) = delete;
+
+    int init();
+    int update(const unsigned char *input_buffer, size_t input_buffer_size);
+    int finalize(unsigned char *digest);
+
     static void generateSHA256(unsigned char *input_buffer, unsigned long input_buffer_size, unsigned char *&digest,
                                unsigned int &digest_size);
 };
 
+/**
+ * Two-level SHA-256 tree hash of data split in leaves of the same size (the last one can be shorter).
+ * Each leaf is hashed on its own, SHA-256(0x00 || leaf), so the leaves can be hashed in any order by
+ * different threads as their data arrives; the root is SHA-256(0x01 || leaf digests in order).
+ */
+class TreeHash {
+private:
+    vector<array<unsigned char, Hash::DIGEST_LEN>> m_leaf_digests;
+    vector<uint8_t> m_hashed_leaves;
+
+public:
+    explicit TreeHash(size_t leaves_num);
+
+    int hashLeaf(size_t leaf_index, const unsigned char *input_buffer, size_t input_buffer_size);
+    int finalize(unsigned char *digest);
+
+    static int generateTreeSHA256(const unsigned char *input_buffer, size_t input_buffer_size, size_t leaf_size,
+                                  unsigned int threads_num, unsigned char *digest);
+};
+
 
 #endif //SECURE_CLOUD_STORAGE_HASH_H
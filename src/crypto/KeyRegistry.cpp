@@ -0,0 +1,219 @@
+#include <iostream>
+#include <filesystem>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <openssl/pem.h>
+#include "KeyRegistry.h"
+
+KeyRegistry* KeyRegistry::m_key_registry_instance = nullptr;
+mutex KeyRegistry::m_instance_mutex;
+
+namespace {
+    const char* PUBLIC_KEYS_PATH = "../resources/public_keys/";
+    const char* SERVER_PRIVATE_KEY_PATH = "../resources/private_keys/Server_key.pem";
+    const char* PUBLIC_KEY_SUFFIX = "_key.pem";
+    // Max time the watcher waits for a change before checking if the registry is being deleted
+    const int WATCHER_POLL_TIMEOUT_MS = 500;
+}
+
+/**
+ * @brief Destructor of a snapshot, frees the parsed keys.
+ */
+KeyRegistry::Snapshot::~Snapshot() {
+    EVP_PKEY_free(server_private_key);
+    for (auto& entry : public_keys) {
+        EVP_PKEY_free(entry.second);
+    }
+}
+
+/**
+ * @brief Constructor for the KeyRegistry class, loads the keys.
+ * @param public_keys_path The directory of the public keys of the users, named <username>_key.pem.
+ * @param server_private_key_path The file of the private key of the server.
+ */
+KeyRegistry::KeyRegistry(const string &public_keys_path, const string &server_private_key_path)
+        : m_public_keys_path(public_keys_path), m_server_private_key_path(server_private_key_path) {
+    reload();
+}
+
+/**
+ * @brief Destructor for the KeyRegistry class, stops the watcher of the key directories.
+ */
+KeyRegistry::~KeyRegistry() {
+    m_stopping = true;
+    if (m_watcher.joinable()) {
+        m_watcher.join();
+    }
+}
+
+/**
+ * @brief Parse the key files into a new snapshot and make it the current one.
+ * @return 0 on success, -1 if the server private key cannot be loaded (the current snapshot is kept).
+ */
+int KeyRegistry::reload() {
+    auto snapshot = make_shared<Snapshot>();
+
+    // Load the private key of the server
+    BIO* bio = BIO_new_file(m_server_private_key_path.c_str(), "r");
+    if (bio) {
+        snapshot->server_private_key = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+        BIO_free(bio);
+    }
+    if (!snapshot->server_private_key) {
+        cerr << "KeyRegistry - Error in loading the server private key!" << endl;
+        return -1;
+    }
+
+    // Load the public key of every registered user
+    error_code error;
+    for (const auto& entry : filesystem::directory_iterator(m_public_keys_path, error)) {
+        string filename = entry.path().filename().string();
+        size_t suffix_len = string(PUBLIC_KEY_SUFFIX).length();
+        if (filename.length() <= suffix_len ||
+            filename.compare(filename.length() - suffix_len, suffix_len, PUBLIC_KEY_SUFFIX) != 0) {
+            continue;
+        }
+        bio = BIO_new_file(entry.path().c_str(), "r");
+        if (!bio) {
+            continue;
+        }
+        EVP_PKEY* public_key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+        BIO_free(bio);
+        if (!public_key) {
+            cerr << "KeyRegistry - Error in loading the public key " << filename << endl;
+            continue;
+        }
+        snapshot->public_keys[filename.substr(0, filename.length() - suffix_len)] = public_key;
+    }
+    if (error) {
+        cerr << "KeyRegistry - Error in listing the public keys: " << error.message() << endl;
+    }
+
+    cout << "KeyRegistry - Loaded the keys of " << snapshot->public_keys.size() << " users" << endl;
+    lock_guard<mutex> lock(m_snapshot_mutex);
+    m_snapshot = std::move(snapshot);
+    return 0;
+}
+
+/**
+ * @brief Get the current snapshot, which stays valid for the caller even if the registry is reloaded.
+ * @return The current snapshot, nullptr if the keys have never been loaded.
+ */
+shared_ptr<const KeyRegistry::Snapshot> KeyRegistry::getSnapshot() {
+    lock_guard<mutex> lock(m_snapshot_mutex);
+    return m_snapshot;
+}
+
+/**
+ * @brief Start a thread reloading the registry whenever a key file is written, moved or removed.
+ */
+void KeyRegistry::startWatcher() {
+    if (!m_watcher.joinable()) {
+        m_watcher = thread(&KeyRegistry::watchDirectories, this);
+    }
+}
+
+/**
+ * @brief Loop of the watcher thread, based on inotify.
+ */
+void KeyRegistry::watchDirectories() {
+    int inotify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_descriptor == -1) {
+        cerr << "KeyRegistry - Error in creating the inotify instance" << endl;
+        return;
+    }
+    const uint32_t events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    string private_keys_path = filesystem::path(m_server_private_key_path).parent_path().string();
+    if (inotify_add_watch(inotify_descriptor, m_public_keys_path.c_str(), events) == -1 ||
+        inotify_add_watch(inotify_descriptor, private_keys_path.c_str(), events) == -1) {
+        cerr << "KeyRegistry - Error in watching the key directories" << endl;
+        close(inotify_descriptor);
+        return;
+    }
+
+    char buffer[4096];
+    while (!m_stopping) {
+        pollfd descriptor = {inotify_descriptor, POLLIN, 0};
+        if (poll(&descriptor, 1, WATCHER_POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+        // Drain the events: a batch of changes causes a single reload
+        while (read(inotify_descriptor, buffer, sizeof(buffer)) > 0) {
+        }
+        reload();
+    }
+    close(inotify_descriptor);
+}
+
+/**
+ * @brief Get the public key of a registered user.
+ * @param username The username of the user.
+ * @return The public key, to be freed by the caller with EVP_PKEY_free, or nullptr if the user is unknown.
+ */
+EVP_PKEY* KeyRegistry::getUserPublicKey(const string &username) {
+    shared_ptr<const Snapshot> snapshot = getSnapshot();
+    if (!snapshot) {
+        return nullptr;
+    }
+    auto entry = snapshot->public_keys.find(username);
+    if (entry == snapshot->public_keys.end()) {
+        return nullptr;
+    }
+    EVP_PKEY_up_ref(entry->second);
+    return entry->second;
+}
+
+/**
+ * @brief Get the private key of the server.
+ * @return The private key, to be freed by the caller with EVP_PKEY_free, or nullptr if it has not been loaded.
+ */
+EVP_PKEY* KeyRegistry::getServerPrivateKey() {
+    shared_ptr<const Snapshot> snapshot = getSnapshot();
+    if (!snapshot) {
+        return nullptr;
+    }
+    EVP_PKEY_up_ref(snapshot->server_private_key);
+    return snapshot->server_private_key;
+}
+
+/**
+ * @brief Check if a user is registered.
+ * @param username The username of the user.
+ * @return true if the public key of the user is in the registry, false otherwise.
+ */
+bool KeyRegistry::hasUser(const string &username) {
+    shared_ptr<const Snapshot> snapshot = getSnapshot();
+    return snapshot && snapshot->public_keys.count(username) != 0;
+}
+
+/**
+ * @brief Get the number of registered users.
+ * @return The number of public keys in the registry.
+ */
+size_t KeyRegistry::getUsersNum() {
+    shared_ptr<const Snapshot> snapshot = getSnapshot();
+    return snapshot ? snapshot->public_keys.size() : 0;
+}
+
+/**
+ * @brief Get the registry of the server keys, loading it and starting its watcher on the first call.
+ * @return The KeyRegistry instance.
+ */
+KeyRegistry* KeyRegistry::getInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    if (!m_key_registry_instance) {
+        m_key_registry_instance = new KeyRegistry(PUBLIC_KEYS_PATH, SERVER_PRIVATE_KEY_PATH);
+        m_key_registry_instance->startWatcher();
+    }
+    return m_key_registry_instance;
+}
+
+/**
+ * @brief Stop the watcher and delete the registry instance.
+ */
+void KeyRegistry::deleteInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    delete m_key_registry_instance;
+    m_key_registry_instance = nullptr;
+}
@@ -0,0 +1,64 @@
+#ifndef SECURE_CLOUD_STORAGE_KEYREGISTRY_H
+#define SECURE_CLOUD_STORAGE_KEYREGISTRY_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <openssl/evp.h>
+
+using namespace std;
+
+/**
+ * Registry of the keys used by the server during the handshakes: its private key and the public key of
+ * every registered user, parsed once and kept in memory. A reload parses the key files into a new snapshot
+ * which replaces the current one at once, so a handshake sees either all the old keys or all the new ones.
+ * The registry is reloaded when the key directories change, or on request (SIGHUP in the server).
+ */
+class KeyRegistry {
+private:
+    // Parsed keys of a registry version, freed when the last handshake using it releases it
+    struct Snapshot {
+        EVP_PKEY* server_private_key = nullptr;
+        unordered_map<string, EVP_PKEY*> public_keys;
+
+        ~Snapshot();
+    };
+
+    static KeyRegistry* m_key_registry_instance;
+    static mutex m_instance_mutex;
+
+    string m_public_keys_path;
+    string m_server_private_key_path;
+    shared_ptr<const Snapshot> m_snapshot;
+    mutex m_snapshot_mutex;
+
+    thread m_watcher;
+    atomic<bool> m_stopping{false};
+
+    shared_ptr<const Snapshot> getSnapshot();
+    void watchDirectories();
+
+public:
+    KeyRegistry(const string& public_keys_path, const string& server_private_key_path);
+    ~KeyRegistry();
+
+    KeyRegistry(const KeyRegistry&) = delete;
+    KeyRegistry& operator=(const KeyRegistry&) = delete;
+
+    int reload();
+    void startWatcher();
+
+    EVP_PKEY* getUserPublicKey(const string& username);
+    EVP_PKEY* getServerPrivateKey();
+    bool hasUser(const string& username);
+    size_t getUsersNum();
+
+    static KeyRegistry* getInstance();
+    static void deleteInstance();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_KEYREGISTRY_H
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <netinet/in.h>
+#include <openssl/core_names.h>
+#include <openssl/kdf.h>
+
+#include "SessionCipher.h"
+#include "Hash.h"
+
+using namespace std;
+
+/**
+ * Constructor for SessionCipher class
+ * Expands the session key in the encryption and decryption contexts and derives the salts of the two
+ * directions from the digest of the session key
+ * @param session_key The session key
+ * @param role The side of the session using this cipher
+ * @param suite The AEAD algorithm negotiated for the session
+ */
+SessionCipher::SessionCipher(const unsigned char *session_key, Role role, CipherSuite suite) : m_suite(suite) {
+    // The first half of the digest salts the client messages, the second half the server messages
+    unsigned char key_material[Config::AES_KEY_LEN + 1];
+    memcpy(key_material, session_key, Config::AES_KEY_LEN);
+    unsigned char *digest = nullptr;
+    unsigned int digest_size;
+    Hash::generateSHA256(key_material, Config::AES_KEY_LEN, digest, digest_size);
+    size_t salt_position = role == Role::CLIENT ? 0 : Config::IV_SALT_LEN;
+    memcpy(m_send_salt, digest + salt_position, Config::IV_SALT_LEN);
+    OPENSSL_cleanse(digest, digest_size);
+    delete[] digest;
+
+    // ChaCha20 takes a 256 bit key: it is the digest of the session key followed by a label byte,
+    // which is independent of the digest of the salts
+    const EVP_CIPHER *cipher = EVP_aes_128_gcm();
+    unsigned char *cipher_key = key_material;
+    if (suite == CipherSuite::CHACHA20_POLY1305) {
+        cipher = EVP_chacha20_poly1305();
+        key_material[Config::AES_KEY_LEN] = 0x01;
+        Hash::generateSHA256(key_material, Config::AES_KEY_LEN + 1, digest, digest_size);
+        cipher_key = digest;
+    }
+
+    m_encrypt_ctx = EVP_CIPHER_CTX_new();
+    m_decrypt_ctx = EVP_CIPHER_CTX_new();
+    if (!m_encrypt_ctx || !m_decrypt_ctx ||
+        !EVP_EncryptInit_ex(m_encrypt_ctx, cipher, nullptr, cipher_key, nullptr) ||
+        !EVP_DecryptInit_ex(m_decrypt_ctx, cipher, nullptr, cipher_key, nullptr)) {
+        cerr << "SessionCipher - Error during the initialization of the contexts" << endl;
+    }
+    OPENSSL_cleanse(key_material, sizeof(key_material));
+    if (cipher_key != key_material) {
+        OPENSSL_cleanse(digest, digest_size);
+        delete[] digest;
+    }
+}
+
+/**
+ * Copy constructor for SessionCipher class
+ * The contexts are copied with the expanded key, so that the copy can be used by another thread
+ * without expanding the key again
+ * @param other The cipher to copy
+ */
+SessionCipher::SessionCipher(const SessionCipher &other) : SessionCipher(other, false) {
+}
+
+/**
+ * Copy constructor for SessionCipher class, optionally copying only the encryption context
+ * An encrypt-only copy seals messages on another thread without allocating a decryption context that
+ * would never be used; its decrypt function always fails
+ * @param other The cipher to copy
+ * @param encrypt_only true to copy only the encryption context
+ */
+SessionCipher::SessionCipher(const SessionCipher &other, bool encrypt_only) : m_suite(other.m_suite) {
+    m_encrypt_ctx = EVP_CIPHER_CTX_new();
+    m_decrypt_ctx = encrypt_only ? nullptr : EVP_CIPHER_CTX_new();
+    if (!m_encrypt_ctx || !EVP_CIPHER_CTX_copy(m_encrypt_ctx, other.m_encrypt_ctx) ||
+        (!encrypt_only && (!m_decrypt_ctx || !EVP_CIPHER_CTX_copy(m_decrypt_ctx, other.m_decrypt_ctx)))) {
+        cerr << "SessionCipher - Error during the copy of the contexts" << endl;
+    }
+    memcpy(m_send_salt, other.m_send_salt, Config::IV_SALT_LEN);
+}
+
+/**
+ * Destructor for SessionCipher class
+ * Frees the contexts, which also clears the expanded key
+ */
+SessionCipher::~SessionCipher() {
+    EVP_CIPHER_CTX_free(m_encrypt_ctx);
+    EVP_CIPHER_CTX_free(m_decrypt_ctx);
+    OPENSSL_cleanse(m_send_salt, Config::IV_SALT_LEN);
+}
+
+/**
+ * Get the AEAD algorithm of the cipher
+ * @return The cipher suite negotiated for the session
+ */
+CipherSuite SessionCipher::getSuite() const {
+    return m_suite;
+}
+
+/**
+ * Check if a cipher suite received from the peer is known and provided by the OpenSSL library
+ * @param suite The cipher suite code
+ * @return true if the suite can be used for a session, false otherwise
+ */
+bool SessionCipher::isSupported(uint8_t suite) {
+    switch (static_cast<CipherSuite>(suite)) {
+        case CipherSuite::AES_128_GCM:
+            return EVP_aes_128_gcm() != nullptr;
+        case CipherSuite::CHACHA20_POLY1305:
+            return EVP_chacha20_poly1305() != nullptr;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Get the printable name of a cipher suite
+ * @param suite The cipher suite
+ * @return The name of the AEAD algorithm
+ */
+const char *SessionCipher::getSuiteName(CipherSuite suite) {
+    return suite == CipherSuite::CHACHA20_POLY1305 ? "ChaCha20-Poly1305" : "AES-128-GCM";
+}
+
+/**
+ * Build the IV of a sent message: the salt of the sending direction followed by the big endian counter
+ * @param counter The counter of the message
+ * @param iv Buffer of IV_LEN bytes filled with the IV
+ */
+void SessionCipher::buildIV(uint32_t counter, unsigned char *iv) const {
+    memcpy(iv, m_send_salt, Config::IV_SALT_LEN);
+    uint32_t counter_big_end = htonl(counter);
+    memcpy(iv + Config::IV_SALT_LEN, &counter_big_end, sizeof(uint32_t));
+}
+
+/**
+ * Encryption function, reusing the expanded key of the encryption context
+ * @param counter The counter of the message, used to build the IV
+ * @param plaintext The input plaintext
+ * @param plaintext_len Length of the plaintext
+ * @param aad Additional authenticated data
+ * @param aad_len Length of the additional authenticated data
+ * @param iv Buffer of IV_LEN bytes filled with the IV of the message
+ * @param ciphertext Buffer of plaintext_len bytes filled with the ciphertext
+ * @param tag Buffer of AES_TAG_LEN bytes filled with the tag
+ * @return Length of the ciphertext on success, -1 on failure
+ */
+int SessionCipher::encrypt(uint32_t counter, const unsigned char *plaintext, int plaintext_len,
+                           const unsigned char *aad, int aad_len, unsigned char *iv,
+                           unsigned char *ciphertext, unsigned char *tag) {
+    return encrypt(counter, nullptr, 0, plaintext, plaintext_len, aad, aad_len, iv, ciphertext, tag);
+}
+
+/**
+ * Encryption function for a plaintext made of two separate parts, so that a message header and a
+ * chunk read in place from a file are encrypted without being first copied in a single buffer
+ * @param counter The counter of the message, used to build the IV
+ * @param prefix The first part of the plaintext
+ * @param prefix_len Length of the first part
+ * @param plaintext The second part of the plaintext
+ * @param plaintext_len Length of the second part
+ * @param aad Additional authenticated data
+ * @param aad_len Length of the additional authenticated data
+ * @param iv Buffer of IV_LEN bytes filled with the IV of the message
+ * @param ciphertext Buffer of prefix_len + plaintext_len bytes filled with the ciphertext
+ * @param tag Buffer of AES_TAG_LEN bytes filled with the tag
+ * @return Length of the ciphertext on success, -1 on failure
+ */
+int SessionCipher::encrypt(uint32_t counter, const unsigned char *prefix, int prefix_len,
+                           const unsigned char *plaintext, int plaintext_len, const unsigned char *aad,
+                           int aad_len, unsigned char *iv, unsigned char *ciphertext, unsigned char *tag) {
+    int len;
+    int ciphertext_len = 0;
+    buildIV(counter, iv);
+    // Set the IV only, the key schedule of the context is kept
+    if (!EVP_EncryptInit_ex(m_encrypt_ctx, nullptr, nullptr, nullptr, iv) ||
+        !EVP_EncryptUpdate(m_encrypt_ctx, nullptr, &len, aad, aad_len)) {
+        cerr << "SessionCipher - Error during encryption" << endl;
+        return -1;
+    }
+    if (prefix_len > 0) {
+        if (!EVP_EncryptUpdate(m_encrypt_ctx, ciphertext, &len, prefix, prefix_len)) {
+            cerr << "SessionCipher - Error during encryption" << endl;
+            return -1;
+        }
+        ciphertext_len = len;
+    }
+    if (!EVP_EncryptUpdate(m_encrypt_ctx, ciphertext + ciphertext_len, &len, plaintext, plaintext_len)) {
+        cerr << "SessionCipher - Error during encryption" << endl;
+        return -1;
+    }
+    ciphertext_len += len;
+    if (!EVP_EncryptFinal_ex(m_encrypt_ctx, ciphertext + ciphertext_len, &len) ||
+        !EVP_CIPHER_CTX_ctrl(m_encrypt_ctx, EVP_CTRL_AEAD_GET_TAG, Config::AES_TAG_LEN, tag)) {
+        cerr << "SessionCipher - Error during encryption" << endl;
+        return -1;
+    }
+    return ciphertext_len + len;
+}
+
+/**
+ * Decryption function, reusing the expanded key of the decryption context
+ * @param ciphertext The input ciphertext
+ * @param ciphertext_len Length of the ciphertext
+ * @param aad Additional authenticated data
+ * @param aad_len Length of the additional authenticated data
+ * @param iv The IV received with the message
+ * @param tag The tag received with the message
+ * @param plaintext Buffer of ciphertext_len bytes filled with the plaintext
+ * @return Length of the plaintext on success, -1 on failure
+ */
+int SessionCipher::decrypt(const unsigned char *ciphertext, int ciphertext_len, const unsigned char *aad,
+                           int aad_len, const unsigned char *iv, const unsigned char *tag,
+                           unsigned char *plaintext) {
+    int len;
+    int plaintext_len;
+    if (!m_decrypt_ctx || !EVP_DecryptInit_ex(m_decrypt_ctx, nullptr, nullptr, nullptr, iv) ||
+        !EVP_DecryptUpdate(m_decrypt_ctx, nullptr, &len, aad, aad_len) ||
+        !EVP_DecryptUpdate(m_decrypt_ctx, plaintext, &len, ciphertext, ciphertext_len) ||
+        !EVP_CIPHER_CTX_ctrl(m_decrypt_ctx, EVP_CTRL_AEAD_SET_TAG, Config::AES_TAG_LEN,
+                             const_cast<unsigned char *>(tag))) {
+        cerr << "SessionCipher - Error during decryption" << endl;
+        return -1;
+    }
+    plaintext_len = len;
+    if (EVP_DecryptFinal_ex(m_decrypt_ctx, plaintext + len, &len) <= 0) {
+        // Verify failed
+        OPENSSL_cleanse(plaintext, ciphertext_len);
+        cerr << "SessionCipher - Error during decryption: EVP_DecryptFinal_ex failed" << endl;
+        return -1;
+    }
+    return plaintext_len + len;
+}
+
+/**
+ * Derive the next key of a session from the current one with HKDF-SHA256, so that both sides change key
+ * without a new handshake. The current key cannot be computed back from the next one
+ * @param session_key The current session key
+ * @param next_session_key The buffer receiving the next session key, AES_KEY_LEN bytes
+ * @return 0 on success, -1 on failure
+ */
+int SessionCipher::deriveNextKey(const unsigned char *session_key, unsigned char *next_session_key) {
+    static const char REKEY_LABEL[] = "Secure-Cloud-Storage rekey";
+
+    EVP_KDF *kdf = EVP_KDF_fetch(nullptr, OSSL_KDF_NAME_HKDF, nullptr);
+    EVP_KDF_CTX *ctx = kdf ? EVP_KDF_CTX_new(kdf) : nullptr;
+    EVP_KDF_free(kdf);
+    if (!ctx) {
+        cerr << "SessionCipher - Error during the creation of the HKDF context" << endl;
+        return -1;
+    }
+
+    OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char *>(SN_sha256), 0),
+            OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<unsigned char *>(session_key),
+                                              Config::AES_KEY_LEN),
+            OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, const_cast<char *>(REKEY_LABEL),
+                                              sizeof(REKEY_LABEL) - 1),
+            OSSL_PARAM_construct_end()
+    };
+    int result = EVP_KDF_derive(ctx, next_session_key, Config::AES_KEY_LEN, params);
+    EVP_KDF_CTX_free(ctx);
+    if (result != 1) {
+        cerr << "SessionCipher - Error during the derivation of the next session key" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Get the number of session messages protected by a session key before the next key is derived.
+ * A message carries at most about one chunk, so the byte limit is turned into a number of messages:
+ * both sides know the chunk size of the session and change key after the same message
+ * @param chunk_size The chunk size of the session
+ * @return The number of messages sent with the same key
+ */
+uint32_t SessionCipher::getRekeyInterval(uint32_t chunk_size) {
+    uint64_t interval = Config::REKEY_BYTES / max<uint64_t>(chunk_size, 1);
+    return static_cast<uint32_t>(min<uint64_t>(max<uint64_t>(interval, 1), Config::REKEY_MESSAGES));
+}
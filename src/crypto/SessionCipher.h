@@ -0,0 +1,64 @@
+#ifndef SECURE_CLOUD_STORAGE_SESSIONCIPHER_H
+#define SECURE_CLOUD_STORAGE_SESSIONCIPHER_H
+
+#include <cstdint>
+#include <openssl/evp.h>
+#include "Config.h"
+#include "CodesManager.h"
+
+/**
+ * AEAD cipher of a session, AES-128-GCM or ChaCha20-Poly1305 as negotiated during the authentication.
+ * The key is expanded once in an encryption and a decryption context, which are reused for every message
+ * of the session. The IV of each sent message is built from a salt of
+ * the sending direction and the message counter, so no random bytes are generated per message:
+ * the counter is never reused in a direction with the same key, hence neither is the IV.
+ */
+class SessionCipher {
+
+public:
+    // Side of the session, which selects the salt of the sent messages
+    enum class Role {
+        CLIENT,
+        SERVER
+    };
+
+    SessionCipher(const unsigned char *session_key, Role role, CipherSuite suite = CipherSuite::AES_128_GCM);
+
+    SessionCipher(const SessionCipher &other);
+
+    SessionCipher(const SessionCipher &other, bool encrypt_only);
+
+    SessionCipher &operator=(const SessionCipher &) = delete;
+
+    ~SessionCipher();
+
+    int encrypt(uint32_t counter, const unsigned char *plaintext, int plaintext_len, const unsigned char *aad,
+                int aad_len, unsigned char *iv, unsigned char *ciphertext, unsigned char *tag);
+
+    int encrypt(uint32_t counter, const unsigned char *prefix, int prefix_len, const unsigned char *plaintext,
+                int plaintext_len, const unsigned char *aad, int aad_len, unsigned char *iv,
+                unsigned char *ciphertext, unsigned char *tag);
+
+    int decrypt(const unsigned char *ciphertext, int ciphertext_len, const unsigned char *aad, int aad_len,
+                const unsigned char *iv, const unsigned char *tag, unsigned char *plaintext);
+
+    void buildIV(uint32_t counter, unsigned char *iv) const;
+
+    CipherSuite getSuite() const;
+
+    static bool isSupported(uint8_t suite);
+
+    static const char *getSuiteName(CipherSuite suite);
+
+    static int deriveNextKey(const unsigned char *session_key, unsigned char *next_session_key);
+
+    static uint32_t getRekeyInterval(uint32_t chunk_size);
+
+private:
+    CipherSuite m_suite;
+    EVP_CIPHER_CTX *m_encrypt_ctx;
+    EVP_CIPHER_CTX *m_decrypt_ctx;
+    unsigned char m_send_salt[Config::IV_SALT_LEN]{};
+};
+
+#endif //SECURE_CLOUD_STORAGE_SESSIONCIPHER_H
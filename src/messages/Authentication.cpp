@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <netinet/in.h>
+#include <openssl/rand.h>
 #include "Authentication.h"
 #include "CodesManager.h"
 
@@ -16,9 +18,14 @@ AuthenticationM1::AuthenticationM1() = default;
  * @param ephemeral_key The ephemeral key to be stored in the AuthenticationM1 object.
  * @param ephemeral_key_len The size of the ephemeral key.
  * @param username The username to be stored in the AuthenticationM1 object.
+ * @param chunk_size The chunk size requested by the client for the session.
+ * @param cipher_suite The AEAD algorithm requested by the client for the session messages.
+ * @param key_exchange The group of the ephemeral key exchange.
  */
-AuthenticationM1::AuthenticationM1(uint8_t* ephemeral_key, int ephemeral_key_len, const string &username) {
+AuthenticationM1::AuthenticationM1(uint8_t* ephemeral_key, int ephemeral_key_len, const string &username,
+                                   uint32_t chunk_size, uint8_t cipher_suite, uint8_t key_exchange) {
     m_message_code = static_cast<uint8_t>(Message::AUTHENTICATION_REQUEST);
+    m_key_exchange = key_exchange;
     // Initialize the ephemeral key with the provided data, and set the size
     memset(m_ephemeral_key, 0, sizeof(m_ephemeral_key));
     memcpy(m_ephemeral_key, ephemeral_key, ephemeral_key_len);
@@ -27,30 +34,57 @@ AuthenticationM1::AuthenticationM1(uint8_t* ephemeral_key, int ephemeral_key_len
     // Initialize the username with the provided data
     memset(m_username, 0, sizeof(m_username));
     strncpy(m_username, username.c_str(), Config::USERNAME_LEN);
+
+    m_chunk_size = chunk_size;
+    m_cipher_suite = cipher_suite;
 }
 
 /**
- * @brief Get the total size of the AuthenticationM1 message.
- * @return The total size of the AuthenticationM1 message in bytes.
+ * @brief Get the size of the fixed fields of the AuthenticationM1 message, which precede the ephemeral key.
+ * @return The size of the fixed fields in bytes.
  */
-size_t AuthenticationM1::getMessageSize() {
+size_t AuthenticationM1::getHeaderSize() {
     size_t message_size = 0;
 
     // Calculate the total size by summing the sizes of individual components
     message_size += sizeof(uint8_t);
-    message_size += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
-    message_size += sizeof(uint32_t);
+    message_size += sizeof(uint8_t);
     message_size += Config::USERNAME_LEN * sizeof(char);
+    message_size += sizeof(uint32_t);
+    message_size += sizeof(uint8_t);
+    message_size += sizeof(uint32_t);
     return message_size;
 }
 
+/**
+ * @brief Get the size of the ephemeral key field: the raw X25519 public value, or the padded PEM of the
+ * finite field public key.
+ * @param key_exchange The group of the key exchange.
+ * @return The size of the ephemeral key field in bytes.
+ */
+size_t AuthenticationM1::getEphemeralKeyFieldSize(uint8_t key_exchange) {
+    if (key_exchange == static_cast<uint8_t>(KeyExchange::X25519)) {
+        return Config::X25519_KEY_LEN;
+    }
+    return EPHEMERAL_KEY_LEN;
+}
+
+/**
+ * @brief Get the total size of the AuthenticationM1 message.
+ * @param key_exchange The group of the key exchange.
+ * @return The total size of the AuthenticationM1 message in bytes.
+ */
+size_t AuthenticationM1::getMessageSize(uint8_t key_exchange) {
+    return getHeaderSize() + getEphemeralKeyFieldSize(key_exchange) * sizeof(uint8_t);
+}
+
 /**
  * @brief Serialize the AuthenticationM1 object into a byte buffer.
  * @return A dynamically allocated byte buffer containing the serialized data.
  */
 uint8_t *AuthenticationM1::serialize() {
     // Allocate memory for the message buffer
-    uint8_t* message_buffer = new (nothrow) uint8_t[AuthenticationM1::getMessageSize()];
+    uint8_t* message_buffer = new (nothrow) uint8_t[AuthenticationM1::getMessageSize(m_key_exchange)];
     // Check if memory allocation was successful
     if (!message_buffer) {
         cerr << "AuthenticationM1 - Error during the serialization: Failed to allocate memory!" << endl;
@@ -58,20 +92,33 @@ uint8_t *AuthenticationM1::serialize() {
     }
 
     size_t current_buffer_position = 0;
-    // Copy the message code into the buffer
+    // Copy the message code and the key exchange group into the buffer
     memcpy(message_buffer, &m_message_code, sizeof(uint8_t));
     current_buffer_position += sizeof(uint8_t);
-    // Copy the ephemeral key into the buffer
-    memcpy(message_buffer + current_buffer_position, &m_ephemeral_key, EPHEMERAL_KEY_LEN * sizeof(uint8_t));
-    current_buffer_position += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
+    memcpy(message_buffer + current_buffer_position, &m_key_exchange, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+
+    // Copy the username into the buffer
+    memcpy(message_buffer + current_buffer_position, m_username, Config::USERNAME_LEN * sizeof(char));
+    current_buffer_position += Config::USERNAME_LEN * sizeof(char);
+
+    // Convert the requested chunk size to network byte order and copy to the buffer
+    uint32_t chunk_size_big_end = htonl(m_chunk_size);
+    memcpy(message_buffer + current_buffer_position, &chunk_size_big_end, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+
+    // Copy the requested cipher suite into the buffer
+    memcpy(message_buffer + current_buffer_position, &m_cipher_suite, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
 
     // Convert the ephemeral key size to network byte order and copy to the buffer
     uint32_t ephemeral_key_len_big_end = htonl(m_ephemeral_key_len);
     memcpy(message_buffer + current_buffer_position, &ephemeral_key_len_big_end, sizeof(uint32_t));
     current_buffer_position += sizeof(uint32_t);
 
-    // Copy the username into the buffer
-    memcpy(message_buffer + current_buffer_position, m_username, Config::USERNAME_LEN * sizeof(char));
+    // Copy the ephemeral key into the buffer
+    memcpy(message_buffer + current_buffer_position, &m_ephemeral_key,
+           getEphemeralKeyFieldSize(m_key_exchange) * sizeof(uint8_t));
 
     // Return the serialized AuthenticationM1 message
     return message_buffer;
@@ -79,7 +126,8 @@ uint8_t *AuthenticationM1::serialize() {
 
 /**
  * @brief Deserialize a byte buffer into an AuthenticationM1 object.
- * @param message_buffer The byte buffer containing the serialized data.
+ * @param message_buffer The byte buffer containing the serialized data, of getMessageSize() bytes for the
+ * key exchange group in the buffer.
  * @return An AuthenticationM1 object with deserialized data.
  */
 AuthenticationM1 AuthenticationM1::deserialize(uint8_t *message_buffer) {
@@ -87,27 +135,47 @@ AuthenticationM1 AuthenticationM1::deserialize(uint8_t *message_buffer) {
 
     size_t current_buffer_position = 0;
 
-    // Copy the message code from the buffer
+    // Copy the message code and the key exchange group from the buffer
     memcpy(&authenticationM1.m_message_code, message_buffer, sizeof(uint8_t));
     current_buffer_position += sizeof(uint8_t);
-    // Copy the ephemeral key from the buffer
-    memcpy(&authenticationM1.m_ephemeral_key, message_buffer + current_buffer_position,
-           EPHEMERAL_KEY_LEN * sizeof(uint8_t));
-    current_buffer_position += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
+    memcpy(&authenticationM1.m_key_exchange, message_buffer + current_buffer_position, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+
+    // Copy the username from the buffer
+    memcpy(authenticationM1.m_username, message_buffer + current_buffer_position,
+           Config::USERNAME_LEN * sizeof(char));
+    current_buffer_position += Config::USERNAME_LEN * sizeof(char);
+
+    // Convert the requested chunk size from network byte order and copy to the object
+    uint32_t chunk_size_big_end = 0;
+    memcpy(&chunk_size_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
+    authenticationM1.m_chunk_size = ntohl(chunk_size_big_end);
+    current_buffer_position += sizeof(uint32_t);
+
+    // Copy the requested cipher suite from the buffer
+    memcpy(&authenticationM1.m_cipher_suite, message_buffer + current_buffer_position, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
 
     // Convert the ephemeral key size from network byte order and copy to the object
     uint32_t ephemeral_key_len_big_end = 0;
     memcpy(&ephemeral_key_len_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
-    authenticationM1.m_ephemeral_key_len = ntohl(ephemeral_key_len_big_end);
+    size_t ephemeral_key_field_size = getEphemeralKeyFieldSize(authenticationM1.m_key_exchange);
+    authenticationM1.m_ephemeral_key_len = min<uint32_t>(ntohl(ephemeral_key_len_big_end),
+                                                         static_cast<uint32_t>(ephemeral_key_field_size));
     current_buffer_position += sizeof(uint32_t);
 
-    // Copy the username from the buffer
-    memcpy(authenticationM1.m_username, message_buffer + current_buffer_position,
-           Config::USERNAME_LEN * sizeof(char));
+    // Copy the ephemeral key from the buffer
+    memset(authenticationM1.m_ephemeral_key, 0, sizeof(authenticationM1.m_ephemeral_key));
+    memcpy(&authenticationM1.m_ephemeral_key, message_buffer + current_buffer_position,
+           ephemeral_key_field_size * sizeof(uint8_t));
     // Return the deserialized AuthenticationM1 message
     return authenticationM1;
 }
 
+uint8_t AuthenticationM1::getMKeyExchange() const {
+    return m_key_exchange;
+}
+
 const char *AuthenticationM1::getMUsername() const {
     return m_username;
 }
@@ -120,6 +188,14 @@ uint32_t AuthenticationM1::getMEphemeralKeyLen() const {
     return m_ephemeral_key_len;
 }
 
+uint32_t AuthenticationM1::getMChunkSize() const {
+    return m_chunk_size;
+}
+
+uint8_t AuthenticationM1::getMCipherSuite() const {
+    return m_cipher_suite;
+}
+
 
 /**
  * @brief Default constructor for the AuthenticationM3 class.
@@ -134,12 +210,14 @@ AuthenticationM3::AuthenticationM3() = default;
  * @param aad The additional authenticated data.
  * @param tag The authenticationRequest tag generated during encryption.
  * @param encrypted_digital_signature The encrypted digital signature.
+ * @param encrypted_digital_signature_len The size of the encrypted digital signature.
  * @param serialized_certificate The serialized certificate.
  * @param serialized_certificate_len The size of the serialized certificate.
  */
 AuthenticationM3::AuthenticationM3(uint8_t *ephemeral_key, uint32_t ephemeral_key_len, unsigned char *iv,
                                    unsigned char *aad, unsigned char *tag, unsigned char *encrypted_digital_signature,
-                                   uint8_t *serialized_certificate, uint32_t serialized_certificate_len) {
+                                   uint32_t encrypted_digital_signature_len, const uint8_t *serialized_certificate,
+                                   uint32_t serialized_certificate_len) {
     // Initialize ephemeral key with provided data and set its size
     memset(m_ephemeral_key, 0, sizeof(m_ephemeral_key));
     memcpy(m_ephemeral_key, ephemeral_key, ephemeral_key_len);
@@ -149,8 +227,10 @@ AuthenticationM3::AuthenticationM3(uint8_t *ephemeral_key, uint32_t ephemeral_ke
     memcpy(m_iv, iv, Config::IV_LEN * sizeof(uint8_t));
     memcpy(m_aad, aad, Config::AAD_LEN * sizeof(char));
     memcpy(m_tag, tag, Config::AES_TAG_LEN * sizeof(char));
-    memcpy(m_encrypted_digital_signature, encrypted_digital_signature,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    m_encrypted_digital_signature_len = min<uint32_t>(encrypted_digital_signature_len,
+                                                      MAX_ENCRYPTED_SIGNATURE_LEN);
+    memset(m_encrypted_digital_signature, 0, sizeof(m_encrypted_digital_signature));
+    memcpy(m_encrypted_digital_signature, encrypted_digital_signature, m_encrypted_digital_signature_len);
 
     // Copy serialized certificate and zero-pad the remaining space
     memcpy(m_serialized_certificate, serialized_certificate, serialized_certificate_len);
@@ -161,18 +241,20 @@ AuthenticationM3::AuthenticationM3(uint8_t *ephemeral_key, uint32_t ephemeral_ke
 
 /**
  * @brief Get the total size of the AuthenticationM3 message.
+ * @param key_exchange The group of the key exchange, which sets the size of the ephemeral key field.
  * @return The total size of the AuthenticationM3 message in bytes.
  */
-int AuthenticationM3::getMessageSize() {
+int AuthenticationM3::getMessageSize(uint8_t key_exchange) {
     int message_size = 0;
 
     // Calculate the total size by summing the sizes of individual components
-    message_size += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
+    message_size += static_cast<int>(AuthenticationM1::getEphemeralKeyFieldSize(key_exchange) * sizeof(uint8_t));
     message_size += sizeof(uint32_t);
     message_size += Config::IV_LEN * sizeof(uint8_t);
     message_size += Config::AAD_LEN * sizeof(char);
     message_size += Config::AES_TAG_LEN * sizeof(char);
-    message_size += ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    message_size += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    message_size += sizeof(uint32_t);
     message_size += MAX_SERIALIZED_CERTIFICATE_LEN * sizeof(uint8_t);
     message_size += sizeof(uint32_t);
 
@@ -181,11 +263,12 @@ int AuthenticationM3::getMessageSize() {
 
 /**
  * @brief Serialize the AuthenticationM3 object into a byte buffer.
+ * @param key_exchange The group of the key exchange, which sets the size of the ephemeral key field.
  * @return A dynamically allocated byte buffer containing the serialized data.
  */
-uint8_t *AuthenticationM3::serialize() {
+uint8_t *AuthenticationM3::serialize(uint8_t key_exchange) {
     // Allocate memory for the message buffer
-    uint8_t* message_buffer = new (nothrow) uint8_t[AuthenticationM3::getMessageSize()];
+    uint8_t* message_buffer = new (nothrow) uint8_t[AuthenticationM3::getMessageSize(key_exchange)];
     // Check if memory allocation was successful
     if (!message_buffer) {
         cerr << "AuthenticationM3 - Error during the serialization: Failed to allocate memory!" << endl;
@@ -195,8 +278,9 @@ uint8_t *AuthenticationM3::serialize() {
     size_t current_buffer_position = 0;
 
     // Copy ephemeral key and its size to the buffer
-    memcpy(message_buffer + current_buffer_position, &m_ephemeral_key, EPHEMERAL_KEY_LEN * sizeof(uint8_t));
-    current_buffer_position += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
+    size_t ephemeral_key_field_size = AuthenticationM1::getEphemeralKeyFieldSize(key_exchange);
+    memcpy(message_buffer + current_buffer_position, &m_ephemeral_key, ephemeral_key_field_size * sizeof(uint8_t));
+    current_buffer_position += ephemeral_key_field_size * sizeof(uint8_t);
     uint32_t ephemeral_key_len_big_end = htonl(m_ephemeral_key_len);
     memcpy(message_buffer + current_buffer_position, &ephemeral_key_len_big_end, sizeof(uint32_t));
     current_buffer_position += sizeof(uint32_t);
@@ -210,8 +294,11 @@ uint8_t *AuthenticationM3::serialize() {
     memcpy(message_buffer + current_buffer_position, &m_tag, Config::AES_TAG_LEN * sizeof(char));
     current_buffer_position += Config::AES_TAG_LEN * sizeof(char);
     memcpy(message_buffer + current_buffer_position, &m_encrypted_digital_signature,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
-    current_buffer_position += ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+           MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    current_buffer_position += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    uint32_t encrypted_digital_signature_len_big_end = htonl(m_encrypted_digital_signature_len);
+    memcpy(message_buffer + current_buffer_position, &encrypted_digital_signature_len_big_end, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
     memcpy(message_buffer + current_buffer_position, &m_serialized_certificate,
            MAX_SERIALIZED_CERTIFICATE_LEN * sizeof(uint8_t));
     current_buffer_position += MAX_SERIALIZED_CERTIFICATE_LEN * sizeof(uint8_t);
@@ -224,22 +311,26 @@ uint8_t *AuthenticationM3::serialize() {
 /**
  * @brief Deserialize a byte buffer into an AuthenticationM3 object.
  * @param message_buffer The byte buffer containing the serialized data.
+ * @param key_exchange The group of the key exchange, which sets the size of the ephemeral key field.
  * @return An AuthenticationM3 object with deserialized data.
  */
-AuthenticationM3 AuthenticationM3::deserialize(uint8_t *message_buffer) {
+AuthenticationM3 AuthenticationM3::deserialize(uint8_t *message_buffer, uint8_t key_exchange) {
     AuthenticationM3 authenticationM3;
 
     size_t current_buffer_position = 0;
 
     // Copy ephemeral key from the buffer
+    size_t ephemeral_key_field_size = AuthenticationM1::getEphemeralKeyFieldSize(key_exchange);
+    memset(authenticationM3.m_ephemeral_key, 0, sizeof(authenticationM3.m_ephemeral_key));
     memcpy(&authenticationM3.m_ephemeral_key, message_buffer + current_buffer_position,
-           EPHEMERAL_KEY_LEN * sizeof(uint8_t));
-    current_buffer_position += EPHEMERAL_KEY_LEN * sizeof(uint8_t);
+           ephemeral_key_field_size * sizeof(uint8_t));
+    current_buffer_position += ephemeral_key_field_size * sizeof(uint8_t);
 
     // Convert ephemeral key size from network byte order and copy to the object
     uint32_t ephemeral_key_len_big_end = 0;
     memcpy(&ephemeral_key_len_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
-    authenticationM3.m_ephemeral_key_len = ntohl(ephemeral_key_len_big_end);
+    authenticationM3.m_ephemeral_key_len = min<uint32_t>(ntohl(ephemeral_key_len_big_end),
+                                                         static_cast<uint32_t>(ephemeral_key_field_size));
     current_buffer_position += sizeof(uint32_t);
 
     // Copy IV, AAD, Tag, encrypted digital signature, serialized certificate, and its size
@@ -253,8 +344,13 @@ AuthenticationM3 AuthenticationM3::deserialize(uint8_t *message_buffer) {
            Config::AES_TAG_LEN * sizeof(char));
     current_buffer_position += Config::AES_TAG_LEN * sizeof(char);
     memcpy(&authenticationM3.m_encrypted_digital_signature, message_buffer + current_buffer_position,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
-    current_buffer_position += ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+           MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    current_buffer_position += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    uint32_t encrypted_digital_signature_len_big_end = 0;
+    memcpy(&encrypted_digital_signature_len_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
+    authenticationM3.m_encrypted_digital_signature_len = min<uint32_t>(
+            ntohl(encrypted_digital_signature_len_big_end), MAX_ENCRYPTED_SIGNATURE_LEN);
+    current_buffer_position += sizeof(uint32_t);
     memcpy(&authenticationM3.m_serialized_certificate, message_buffer + current_buffer_position,
            MAX_SERIALIZED_CERTIFICATE_LEN * sizeof(uint8_t));
     current_buffer_position += MAX_SERIALIZED_CERTIFICATE_LEN * sizeof(uint8_t);
@@ -298,6 +394,10 @@ const uint8_t *AuthenticationM3::getMEncryptedDigitalSignature() const {
     return m_encrypted_digital_signature;
 }
 
+uint32_t AuthenticationM3::getMEncryptedDigitalSignatureLen() const {
+    return m_encrypted_digital_signature_len;
+}
+
 bool AuthenticationM3::checkCounter(uint32_t counter) {
     uint32_t aad_counter;
     memcpy(&aad_counter, m_aad, Config::AAD_LEN);
@@ -316,15 +416,18 @@ AuthenticationM4::AuthenticationM4() = default;
  * @param aad The additional authenticated data.
  * @param tag The authenticationRequest tag generated during encryption.
  * @param encrypted_digital_signature The encrypted digital signature.
+ * @param encrypted_digital_signature_len The size of the encrypted digital signature.
  */
 AuthenticationM4::AuthenticationM4(unsigned char *iv, unsigned char *aad, unsigned char *tag,
-                                   uint8_t *encrypted_digital_signature) {
+                                   uint8_t *encrypted_digital_signature, uint32_t encrypted_digital_signature_len) {
     // Copy IV, AAD, Tag, and encrypted digital signature
     memcpy(m_iv, iv, Config::IV_LEN * sizeof(uint8_t));
     memcpy(m_aad, aad, Config::AAD_LEN * sizeof(char));
     memcpy(m_tag, tag, Config::AES_TAG_LEN * sizeof(char));
-    memcpy(m_encrypted_digital_signature, encrypted_digital_signature,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    m_encrypted_digital_signature_len = min<uint32_t>(encrypted_digital_signature_len,
+                                                      MAX_ENCRYPTED_SIGNATURE_LEN);
+    memset(m_encrypted_digital_signature, 0, sizeof(m_encrypted_digital_signature));
+    memcpy(m_encrypted_digital_signature, encrypted_digital_signature, m_encrypted_digital_signature_len);
 }
 
 /**
@@ -338,7 +441,8 @@ int AuthenticationM4::getMessageSize() {
     message_size += Config::IV_LEN * sizeof(uint8_t);
     message_size += Config::AAD_LEN * sizeof(char);
     message_size += Config::AES_TAG_LEN * sizeof(char);
-    message_size += ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    message_size += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    message_size += sizeof(uint32_t);
 
     return message_size;
 }
@@ -367,7 +471,10 @@ uint8_t *AuthenticationM4::serialize() {
     memcpy(message_buffer + current_buffer_position, &m_tag, Config::AES_TAG_LEN * sizeof(char));
     current_buffer_position += Config::AES_TAG_LEN * sizeof(char);
     memcpy(message_buffer + current_buffer_position, &m_encrypted_digital_signature,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+           MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    current_buffer_position += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    uint32_t encrypted_digital_signature_len_big_end = htonl(m_encrypted_digital_signature_len);
+    memcpy(message_buffer + current_buffer_position, &encrypted_digital_signature_len_big_end, sizeof(uint32_t));
     return message_buffer;
 }
 
@@ -392,7 +499,12 @@ AuthenticationM4 AuthenticationM4::deserialize(uint8_t *message_buffer) {
            Config::AES_TAG_LEN * sizeof(char));
     current_buffer_position += Config::AES_TAG_LEN * sizeof(char);
     memcpy(&authenticationM4.m_encrypted_digital_signature, message_buffer + current_buffer_position,
-           ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+           MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t));
+    current_buffer_position += MAX_ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t);
+    uint32_t encrypted_digital_signature_len_big_end = 0;
+    memcpy(&encrypted_digital_signature_len_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
+    authenticationM4.m_encrypted_digital_signature_len = min<uint32_t>(
+            ntohl(encrypted_digital_signature_len_big_end), MAX_ENCRYPTED_SIGNATURE_LEN);
 
     return authenticationM4;
 }
@@ -418,3 +530,178 @@ const unsigned char *AuthenticationM4::getMTag() const {
 const uint8_t *AuthenticationM4::getMEncryptedDigitalSignature() const {
     return m_encrypted_digital_signature;
 }
+
+uint32_t AuthenticationM4::getMEncryptedDigitalSignatureLen() const {
+    return m_encrypted_digital_signature_len;
+}
+
+
+/**
+ * @brief Default constructor for the AuthenticationM5 class.
+ */
+AuthenticationM5::AuthenticationM5() = default;
+
+/**
+ * @brief Parameterized constructor for the AuthenticationM5 class.
+ * @param message_code The result of the authentication (ACK or NACK).
+ * @param chunk_size The chunk size chosen by the server for the session.
+ * @param cipher_suite The AEAD algorithm chosen by the server for the session messages.
+ */
+AuthenticationM5::AuthenticationM5(uint8_t message_code, uint32_t chunk_size, uint8_t cipher_suite) {
+    m_message_code = message_code;
+    m_chunk_size = chunk_size;
+    m_cipher_suite = cipher_suite;
+}
+
+/**
+ * @brief Get the total size of the AuthenticationM5 message, padded as the other encrypted commands.
+ * @return The total size of the AuthenticationM5 message in bytes.
+ */
+size_t AuthenticationM5::getMessageSize() {
+    return Config::MAX_PACKET_SIZE;
+}
+
+/**
+ * @brief Serialize the AuthenticationM5 object into a byte buffer, filling the remaining space with random bytes.
+ * @return A dynamically allocated byte buffer containing the serialized data.
+ */
+uint8_t *AuthenticationM5::serialize() {
+    auto* message_buffer = new uint8_t[Config::MAX_PACKET_SIZE];
+
+    size_t current_buffer_position = 0;
+    // Copy the message code into the buffer
+    memcpy(message_buffer, &m_message_code, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+
+    // Convert the chunk size to network byte order and copy to the buffer
+    uint32_t chunk_size_big_end = htonl(m_chunk_size);
+    memcpy(message_buffer + current_buffer_position, &chunk_size_big_end, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+
+    // Copy the cipher suite into the buffer
+    memcpy(message_buffer + current_buffer_position, &m_cipher_suite, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+
+    // Fill the remaining space with random bytes
+    RAND_bytes(message_buffer + current_buffer_position, Config::MAX_PACKET_SIZE - current_buffer_position);
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a byte buffer into an AuthenticationM5 object.
+ * @param message_buffer The byte buffer containing the serialized data.
+ * @return An AuthenticationM5 object with deserialized data.
+ */
+AuthenticationM5 AuthenticationM5::deserialize(uint8_t *message_buffer) {
+    AuthenticationM5 authenticationM5;
+
+    // Copy the message code from the buffer
+    memcpy(&authenticationM5.m_message_code, message_buffer, sizeof(uint8_t));
+
+    // Convert the chunk size from network byte order and copy to the object
+    uint32_t chunk_size_big_end = 0;
+    memcpy(&chunk_size_big_end, message_buffer + sizeof(uint8_t), sizeof(uint32_t));
+    authenticationM5.m_chunk_size = ntohl(chunk_size_big_end);
+
+    // Copy the cipher suite from the buffer
+    memcpy(&authenticationM5.m_cipher_suite, message_buffer + sizeof(uint8_t) + sizeof(uint32_t), sizeof(uint8_t));
+    return authenticationM5;
+}
+
+uint8_t AuthenticationM5::getMMessageCode() const {
+    return m_message_code;
+}
+
+uint32_t AuthenticationM5::getMChunkSize() const {
+    return m_chunk_size;
+}
+
+uint8_t AuthenticationM5::getMCipherSuite() const {
+    return m_cipher_suite;
+}
+
+
+/**
+ * @brief Default constructor for the AuthenticationM6 class.
+ */
+AuthenticationM6::AuthenticationM6() = default;
+
+/**
+ * @brief Parameterized constructor for the AuthenticationM6 class.
+ * @param sealed_ticket The session ticket sealed by the server.
+ * @param resumption_secret The secret contained in the ticket, used by the client to derive the resumed session keys.
+ * @param ticket_lifetime The seconds the ticket is accepted by the server.
+ */
+AuthenticationM6::AuthenticationM6(const uint8_t *sealed_ticket, const uint8_t *resumption_secret,
+                                   uint32_t ticket_lifetime) {
+    memcpy(m_sealed_ticket, sealed_ticket, SEALED_TICKET_LEN);
+    memcpy(m_resumption_secret, resumption_secret, RESUMPTION_SECRET_LEN);
+    m_ticket_lifetime = ticket_lifetime;
+}
+
+/**
+ * @brief Destructor for the AuthenticationM6 class, clears the resumption secret.
+ */
+AuthenticationM6::~AuthenticationM6() {
+    OPENSSL_cleanse(m_resumption_secret, RESUMPTION_SECRET_LEN);
+}
+
+/**
+ * @brief Get the total size of the AuthenticationM6 message.
+ * @return The total size of the AuthenticationM6 message in bytes.
+ */
+size_t AuthenticationM6::getMessageSize() {
+    return SEALED_TICKET_LEN + RESUMPTION_SECRET_LEN + sizeof(uint32_t);
+}
+
+/**
+ * @brief Serialize the AuthenticationM6 object into a byte buffer.
+ * @return A dynamically allocated byte buffer containing the serialized data.
+ */
+uint8_t *AuthenticationM6::serialize() {
+    auto* message_buffer = new uint8_t[getMessageSize()];
+
+    size_t current_buffer_position = 0;
+    memcpy(message_buffer, m_sealed_ticket, SEALED_TICKET_LEN);
+    current_buffer_position += SEALED_TICKET_LEN;
+    memcpy(message_buffer + current_buffer_position, m_resumption_secret, RESUMPTION_SECRET_LEN);
+    current_buffer_position += RESUMPTION_SECRET_LEN;
+
+    // Convert the ticket lifetime to network byte order and copy to the buffer
+    uint32_t ticket_lifetime_big_end = htonl(m_ticket_lifetime);
+    memcpy(message_buffer + current_buffer_position, &ticket_lifetime_big_end, sizeof(uint32_t));
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a byte buffer into an AuthenticationM6 object.
+ * @param message_buffer The byte buffer containing the serialized data.
+ * @return An AuthenticationM6 object with deserialized data.
+ */
+AuthenticationM6 AuthenticationM6::deserialize(uint8_t *message_buffer) {
+    AuthenticationM6 authenticationM6;
+
+    size_t current_buffer_position = 0;
+    memcpy(authenticationM6.m_sealed_ticket, message_buffer, SEALED_TICKET_LEN);
+    current_buffer_position += SEALED_TICKET_LEN;
+    memcpy(authenticationM6.m_resumption_secret, message_buffer + current_buffer_position, RESUMPTION_SECRET_LEN);
+    current_buffer_position += RESUMPTION_SECRET_LEN;
+
+    // Convert the ticket lifetime from network byte order and copy to the object
+    uint32_t ticket_lifetime_big_end = 0;
+    memcpy(&ticket_lifetime_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
+    authenticationM6.m_ticket_lifetime = ntohl(ticket_lifetime_big_end);
+    return authenticationM6;
+}
+
+const uint8_t *AuthenticationM6::getMSealedTicket() const {
+    return m_sealed_ticket;
+}
+
+const uint8_t *AuthenticationM6::getMResumptionSecret() const {
+    return m_resumption_secret;
+}
+
+uint32_t AuthenticationM6::getMTicketLifetime() const {
+    return m_ticket_lifetime;
+}
@@ -5,36 +5,55 @@
 #include <string>
 #include <openssl/evp.h>
 #include "Config.h"
+#include "CodesManager.h"
+#include "Resumption.h"
 
 using namespace std;
 
 namespace {
     const uint16_t EPHEMERAL_KEY_LEN = 1024;
-    const uint16_t ENCRYPTED_SIGNATURE_LEN = 128;
+    // Largest signature carried by AuthenticationM3 and M4 (RSA-4096), Ed25519 signatures take 64 bytes
+    const uint16_t MAX_ENCRYPTED_SIGNATURE_LEN = 512;
     const uint16_t MAX_SERIALIZED_CERTIFICATE_LEN = 1500;
 }
 
+/**
+ * First message of the handshake. The fixed fields come first, so the server reads them, learns the key
+ * exchange group and then reads the ephemeral key field, whose size depends on the group.
+ */
 class AuthenticationM1 {
 private:
     uint8_t m_message_code;
-    uint8_t m_ephemeral_key[EPHEMERAL_KEY_LEN];
-    uint32_t m_ephemeral_key_len;
+    uint8_t m_key_exchange;
     char m_username[Config::USERNAME_LEN];
+    uint32_t m_chunk_size;
+    uint8_t m_cipher_suite;
+    uint32_t m_ephemeral_key_len;
+    uint8_t m_ephemeral_key[EPHEMERAL_KEY_LEN];
 
 public:
     AuthenticationM1();
-    AuthenticationM1(uint8_t* ephemeral_key, int ephemeral_key_len, const string& username);
+    AuthenticationM1(uint8_t* ephemeral_key, int ephemeral_key_len, const string& username, uint32_t chunk_size,
+                     uint8_t cipher_suite, uint8_t key_exchange);
 
-    static size_t getMessageSize();
+    static size_t getHeaderSize();
+    static size_t getMessageSize(uint8_t key_exchange);
+    static size_t getEphemeralKeyFieldSize(uint8_t key_exchange);
 
     uint8_t* serialize();
     static AuthenticationM1 deserialize(uint8_t* message_buffer);
 
+    uint8_t getMKeyExchange() const;
+
     const char *getMUsername() const;
 
     const uint8_t *getMEphemeralKey() const;
 
     uint32_t getMEphemeralKeyLen() const;
+
+    uint32_t getMChunkSize() const;
+
+    uint8_t getMCipherSuite() const;
 };
 
 class AuthenticationM3 {
@@ -44,30 +63,33 @@ private:
     unsigned char m_iv[Config::IV_LEN];
     unsigned char m_aad[Config::AAD_LEN];
     unsigned char m_tag[Config::AES_TAG_LEN];
-    uint8_t m_encrypted_digital_signature[ENCRYPTED_SIGNATURE_LEN];
+    uint8_t m_encrypted_digital_signature[MAX_ENCRYPTED_SIGNATURE_LEN];
+    uint32_t m_encrypted_digital_signature_len;
     uint8_t m_serialized_certificate[MAX_SERIALIZED_CERTIFICATE_LEN];
     uint32_t m_serialized_certificate_len;
 
 public:
     AuthenticationM3();
     AuthenticationM3(uint8_t *ephemeral_key, uint32_t ephemeral_key_len, unsigned char *iv, unsigned char *aad,
-                     unsigned char *tag, unsigned char *encrypted_digital_signature, uint8_t *serialized_certificate,
+                     unsigned char *tag, unsigned char *encrypted_digital_signature,
+                     uint32_t encrypted_digital_signature_len, const uint8_t *serialized_certificate,
                      uint32_t serialized_certificate_len);
 
-    static int getMessageSize();
+    static int getMessageSize(uint8_t key_exchange);
     const unsigned char *getMEphemeralKey() const;
     uint32_t getMEphemeralKeyLen() const;
     const uint8_t *getMSerializedCertificate() const;
     uint32_t getMSerializedCertificateLen() const;
 
     const uint8_t *getMEncryptedDigitalSignature() const;
+    uint32_t getMEncryptedDigitalSignatureLen() const;
 
     const unsigned char *getMIv() const;
     const unsigned char *getMAad() const;
     const unsigned char *getMTag() const;
 
-    uint8_t* serialize();
-    static AuthenticationM3 deserialize(uint8_t* message_buffer);
+    uint8_t* serialize(uint8_t key_exchange);
+    static AuthenticationM3 deserialize(uint8_t* message_buffer, uint8_t key_exchange);
 
     bool checkCounter(uint32_t i);
 };
@@ -77,11 +99,13 @@ private:
     unsigned char m_iv[Config::IV_LEN];
     unsigned char m_aad[Config::AAD_LEN];
     unsigned char m_tag[Config::AES_TAG_LEN];
-    uint8_t m_encrypted_digital_signature[ENCRYPTED_SIGNATURE_LEN];
+    uint8_t m_encrypted_digital_signature[MAX_ENCRYPTED_SIGNATURE_LEN];
+    uint32_t m_encrypted_digital_signature_len;
 
 public:
     AuthenticationM4();
-    AuthenticationM4(unsigned char *iv, unsigned char *aad, unsigned char *tag, uint8_t *encrypted_digital_signature);
+    AuthenticationM4(unsigned char *iv, unsigned char *aad, unsigned char *tag, uint8_t *encrypted_digital_signature,
+                     uint32_t encrypted_digital_signature_len);
 
     static int getMessageSize();
 
@@ -93,6 +117,48 @@ public:
     const unsigned char *getMAad() const;
     const unsigned char *getMTag() const;
     const uint8_t *getMEncryptedDigitalSignature() const;
+    uint32_t getMEncryptedDigitalSignatureLen() const;
+};
+
+class AuthenticationM5 {
+private:
+    uint8_t m_message_code;
+    uint32_t m_chunk_size;
+    uint8_t m_cipher_suite;
+
+public:
+    AuthenticationM5();
+    AuthenticationM5(uint8_t message_code, uint32_t chunk_size, uint8_t cipher_suite);
+
+    static size_t getMessageSize();
+
+    uint8_t* serialize();
+    static AuthenticationM5 deserialize(uint8_t* message_buffer);
+
+    uint8_t getMMessageCode() const;
+    uint32_t getMChunkSize() const;
+    uint8_t getMCipherSuite() const;
+};
+
+class AuthenticationM6 {
+private:
+    uint8_t m_sealed_ticket[SEALED_TICKET_LEN]{};
+    uint8_t m_resumption_secret[RESUMPTION_SECRET_LEN]{};
+    uint32_t m_ticket_lifetime{};
+
+public:
+    AuthenticationM6();
+    AuthenticationM6(const uint8_t* sealed_ticket, const uint8_t* resumption_secret, uint32_t ticket_lifetime);
+    ~AuthenticationM6();
+
+    static size_t getMessageSize();
+
+    uint8_t* serialize();
+    static AuthenticationM6 deserialize(uint8_t* message_buffer);
+
+    const uint8_t* getMSealedTicket() const;
+    const uint8_t* getMResumptionSecret() const;
+    uint32_t getMTicketLifetime() const;
 };
 
 #endif //SECURE_CLOUD_STORAGE_AUTHENTICATION_H
\ No newline at end of file
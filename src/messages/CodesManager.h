@@ -25,7 +25,24 @@ enum class Message : int {
     LIST_RESPONSE = 13,
     RENAME_REQUEST = 14,
     LOGOUT_REQUEST = 15,
-    NO_DELETE_CONFIRM
+    NO_DELETE_CONFIRM,
+    // Range transfers (codes outside the Error and Return ranges)
+    UPLOAD_RANGE_REQUEST = 40,
+    DOWNLOAD_RANGE_REQUEST = 41,
+    // First message of a session resumed with a ticket, instead of AuthenticationM1
+    RESUMPTION_REQUEST = 42
+};
+
+// Group of the ephemeral key exchange, requested by the client in AuthenticationM1
+enum class KeyExchange : uint8_t {
+    FFDHE_2048 = 0,
+    X25519 = 1
+};
+
+// AEAD algorithm of the session messages, negotiated during the authentication
+enum class CipherSuite : uint8_t {
+    AES_128_GCM = 0,
+    CHACHA20_POLY1305 = 1
 };
 
 // Error message code
@@ -55,7 +72,8 @@ enum class Return : int {
     WRITE_CHUNK_FAILURE,
     WRONG_FILE_SIZE,
     NO_DELETE_CONFIRM,
-    RENAME_FAILURE
+    RENAME_FAILURE,
+    TICKET_NOT_FOUND
 };
 
 #endif //SECURE_CLOUD_STORAGE_CODESMANAGER_H
\ No newline at end of file
@@ -82,6 +82,103 @@ const char *DownloadM1::getFilename() const {
 }
 
 
+/**
+ * @brief Default constructor for the DownloadRangeM1 class.
+ */
+DownloadRangeM1::DownloadRangeM1() = default;
+
+/**
+ * @brief Constructor for creating a DOWNLOAD_RANGE_REQUEST message (Download Range M1).
+ * @param filename The filename associated with the download request.
+ * @param offset The offset of the first byte of the range.
+ * @param length The length of the range in bytes, 0 to only ask for the file size.
+ */
+DownloadRangeM1::DownloadRangeM1(const string& filename, uint32_t offset, uint32_t length) {
+    m_message_code = static_cast<uint8_t>(Message::DOWNLOAD_RANGE_REQUEST);
+    strncpy(m_filename, filename.c_str(), Config::FILE_NAME_LEN);
+    m_offset = offset;
+    m_length = length;
+}
+
+/**
+ * @brief Serialize the Download Range M1 message.
+ * @return A dynamically allocated buffer containing the serialized message.
+ */
+uint8_t* DownloadRangeM1::serialize() {
+    // Allocate memory for the message buffer
+    uint8_t* message_buffer = new (nothrow) uint8_t[Config::MAX_PACKET_SIZE];
+    // Check if memory allocation was successful
+    if (!message_buffer) {
+        cerr << "Download - Error during the serialization: Failed to allocate memory!" << endl;
+        return nullptr;
+    }
+    size_t current_buffer_position = 0;
+    // Copy the message code into the buffer
+    memcpy(message_buffer, &m_message_code, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+    // Copy the filename into the buffer
+    memcpy(message_buffer + current_buffer_position, m_filename, Config::FILE_NAME_LEN * sizeof(char));
+    current_buffer_position += Config::FILE_NAME_LEN * sizeof(char);
+    // Copy the range offset and length into the buffer
+    memcpy(message_buffer + current_buffer_position, &m_offset, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    memcpy(message_buffer + current_buffer_position, &m_length, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    // Generate random bytes to fill the remaining space in the buffer
+    if (RAND_bytes(message_buffer + current_buffer_position,
+                   Config::MAX_PACKET_SIZE - current_buffer_position) != 1) {
+        cerr << "Download - Error during serialization: RAND_bytes failed!" << endl;
+        delete[] message_buffer; // Release memory in case of failure
+        return nullptr;
+    }
+    // Return the serialized message buffer
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a Download Range M1 message from a buffer.
+ * @param message_buffer The buffer containing the serialized message.
+ * @return A DownloadRangeM1 object representing the deserialized message.
+ */
+DownloadRangeM1 DownloadRangeM1::deserialize(uint8_t* message_buffer) {
+    DownloadRangeM1 downloadMessage;
+
+    size_t current_buffer_position = 0;
+
+    // Copy the message code from the buffer
+    memcpy(&downloadMessage.m_message_code, message_buffer, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+    // Copy the filename from the buffer
+    memcpy(&downloadMessage.m_filename, message_buffer + current_buffer_position,
+           Config::FILE_NAME_LEN * sizeof(char));
+    current_buffer_position += Config::FILE_NAME_LEN * sizeof(char);
+    // Copy the range offset and length from the buffer
+    memcpy(&downloadMessage.m_offset, message_buffer + current_buffer_position, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    memcpy(&downloadMessage.m_length, message_buffer + current_buffer_position, sizeof(uint32_t));
+    return downloadMessage;
+}
+
+size_t DownloadRangeM1::getMessageSize() {
+    return sizeof(m_message_code) +
+           Config::FILE_NAME_LEN +
+           sizeof(m_offset) +
+           sizeof(m_length);
+}
+
+const char *DownloadRangeM1::getFilename() const {
+    return m_filename;
+}
+
+uint32_t DownloadRangeM1::getOffset() const {
+    return m_offset;
+}
+
+uint32_t DownloadRangeM1::getLength() const {
+    return m_length;
+}
+
+
 /**
  * @brief Default constructor for the DownloadM2 class.
  */
@@ -91,10 +188,13 @@ DownloadM2::DownloadM2() = default;
  * @brief Constructor for creating a DownloadM2 message.
  * @param message_code Is set to DOWNLOAD_ACK or FILE_NOT_FOUND.
  * @param file_size The size of the file being acknowledged.
+ * @param version The modification time of the file, which tells the client if a partial download of the file
+ * can be resumed.
  */
-DownloadM2::DownloadM2(uint8_t message_code, const size_t& file_size) {
+DownloadM2::DownloadM2(uint8_t message_code, const size_t& file_size, uint64_t version) {
     m_message_code = message_code;
     m_file_size = static_cast<uint32_t>(file_size);
+    m_version = version;
 }
 
 /**
@@ -103,7 +203,7 @@ DownloadM2::DownloadM2(uint8_t message_code, const size_t& file_size) {
  */
 uint8_t* DownloadM2::serialize() {
     // Allocate memory for the message buffer
-    uint8_t* message_buffer = new (nothrow) uint8_t[sizeof(uint8_t) + sizeof(uint32_t)];
+    uint8_t* message_buffer = new (nothrow) uint8_t[getMessageSize()];
     // Check if memory allocation was successful
     if (!message_buffer) {
         cerr << "Download - Error during the serialization: Failed to allocate memory!" << endl;
@@ -116,6 +216,9 @@ uint8_t* DownloadM2::serialize() {
     current_buffer_position += sizeof(uint8_t);
     // Copy the size of the file to be downloaded into the buffer
     memcpy(message_buffer + current_buffer_position, &m_file_size, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    // Copy the version of the file into the buffer
+    memcpy(message_buffer + current_buffer_position, &m_version, sizeof(uint64_t));
     // Return the serialized message buffer
     return message_buffer;
 }
@@ -137,13 +240,17 @@ DownloadM2 DownloadM2::deserialize(uint8_t* message_buffer) {
     current_buffer_position += sizeof(uint8_t);
     // Copy the size of the file to be downloaded from the buffer
     memcpy(&downloadM2.m_file_size, message_buffer + current_buffer_position, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    // Copy the version of the file from the buffer
+    memcpy(&downloadM2.m_version, message_buffer + current_buffer_position, sizeof(uint64_t));
     // Return the deserialized Download message
     return downloadM2;
 }
 
 size_t DownloadM2::getMessageSize() {
     return sizeof(m_message_code)+
-           sizeof(m_file_size);
+           sizeof(m_file_size)+
+           sizeof(m_version);
 }
 
 uint8_t DownloadM2::getMessageCode() const {
@@ -154,6 +261,10 @@ uint32_t DownloadM2::getFileSize() const {
     return m_file_size;
 }
 
+uint64_t DownloadM2::getVersion() const {
+    return m_version;
+}
+
 /**
  * @brief Constructor for creating a Download object for a DOWNLOAD_CHUNK message (Download M3+i).
  * @param file_chunk The file chunk data.
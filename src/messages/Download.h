@@ -22,20 +22,41 @@ public:
     const char *getFilename() const;
 };
 
+class DownloadRangeM1 {
+private:
+    uint8_t m_message_code{};
+    char m_filename[Config::FILE_NAME_LEN]{};
+    uint32_t m_offset{};
+    uint32_t m_length{};
+
+public:
+    DownloadRangeM1();
+    DownloadRangeM1(const string& filename, uint32_t offset, uint32_t length);
+
+    uint8_t* serialize();
+    static DownloadRangeM1 deserialize(uint8_t* message_buffer);
+    static size_t getMessageSize();
+    const char *getFilename() const;
+    uint32_t getOffset() const;
+    uint32_t getLength() const;
+};
+
 class DownloadM2 {
 private:
     uint8_t m_message_code{};
     uint32_t m_file_size{};
+    uint64_t m_version{};
 
 public:
     DownloadM2();
-    DownloadM2(uint8_t message_code, const size_t &file_size);
+    DownloadM2(uint8_t message_code, const size_t &file_size, uint64_t version = 0);
 
     uint8_t* serialize();
     static DownloadM2 deserialize(uint8_t* message_buffer);
     static size_t getMessageSize();
     uint8_t getMessageCode() const;
     uint32_t getFileSize() const;
+    uint64_t getVersion() const;
 };
 
 class DownloadMi {
@@ -1,8 +1,10 @@
 #include "Generic.h"
 #include "AesGcm.h"
+#include "SessionCipher.h"
 #include "Config.h"
 #include <cstring>
 #include <netinet/in.h>
+#include <sys/uio.h>
 #include <iomanip>
 
 using namespace std;
@@ -65,6 +67,45 @@ int Generic::decrypt(unsigned char *session_key, unsigned char *&plaintext) {
                           m_iv, m_tag, plaintext);
 }
 
+/**
+ * Encrypts plaintext with the cipher of the session, using an IV derived from the counter of the message.
+ * @param cipher The cipher of the session
+ * @param plaintext The plaintext to encrypt, deleted after the encryption
+ * @param plaintext_len The length of the plaintext
+ * @return The length of the ciphertext or -1 if encryption fails
+ */
+int Generic::encrypt(SessionCipher &cipher, unsigned char *plaintext, int plaintext_len) {
+    m_ciphertext = new unsigned char[plaintext_len];
+    m_ciphertext_len = cipher.encrypt(getCounter(), plaintext, plaintext_len, m_aad, Config::AAD_LEN,
+                                      m_iv, m_ciphertext, m_tag);
+    // Safely delete plaintext
+    OPENSSL_cleanse(plaintext, plaintext_len);
+    delete[] plaintext;
+
+    return m_ciphertext_len;
+}
+
+/**
+ * Decrypts ciphertext with the cipher of the session.
+ * @param cipher The cipher of the session
+ * @param plaintext The buffer to store the decrypted plaintext, of the length of the ciphertext.
+ * If it is null, the buffer is allocated (and released if decryption fails)
+ * @return The length of the decrypted plaintext or -1 if decryption fails
+ */
+int Generic::decrypt(SessionCipher &cipher, unsigned char *&plaintext) {
+    bool is_allocated = plaintext == nullptr;
+    if (is_allocated) {
+        plaintext = new unsigned char[m_ciphertext_len];
+    }
+    int plaintext_len = cipher.decrypt(m_ciphertext, m_ciphertext_len, m_aad, Config::AAD_LEN,
+                                       m_iv, m_tag, plaintext);
+    if (plaintext_len == -1 && is_allocated) {
+        delete[] plaintext;
+        plaintext = nullptr;
+    }
+    return plaintext_len;
+}
+
 /**
  * Serialize the Generic message into a byte buffer
  * @return A dynamically allocated byte buffer containing the serialized message
@@ -93,6 +134,19 @@ uint8_t *Generic::serialize() {
     return buffer;
 }
 
+/**
+ * Describe the serialized Generic message as its fields in place, so that it can be sent with a
+ * vectored send without copying the ciphertext in a new buffer.
+ * The buffers point to this object and are valid while it is alive.
+ * @param buffers Array of BUFFERS_NUM elements filled with the IV, AAD, tag and ciphertext buffers
+ */
+void Generic::getBuffers(iovec *buffers) {
+    buffers[0] = {m_iv, Config::IV_LEN};
+    buffers[1] = {m_aad, Config::AAD_LEN};
+    buffers[2] = {m_tag, Config::AES_TAG_LEN};
+    buffers[3] = {m_ciphertext, static_cast<size_t>(m_ciphertext_len)};
+}
+
 /**
  * Deserialize a byte buffer into a Generic message
  * @param buffer The byte buffer to deserialize
@@ -124,6 +178,64 @@ Generic Generic::deserialize(uint8_t *buffer, size_t ciphertext_len) {
     return genericMessage;
 }
 
+/**
+ * Encrypt a message in its serialized Generic buffer, without any allocation or copy.
+ * @param cipher The cipher of the session
+ * @param counter The counter value of the message
+ * @param message_buffer Buffer of getMessageSize(plaintext_len) bytes holding the plaintext at HEADER_LEN.
+ * On success it holds the serialized Generic message (IV, AAD, tag and ciphertext)
+ * @param plaintext_len The length of the plaintext
+ * @return The length of the ciphertext or -1 if encryption fails
+ */
+int Generic::sealInPlace(SessionCipher &cipher, uint32_t counter, uint8_t *message_buffer, size_t plaintext_len) {
+    uint8_t *aad = message_buffer + Config::IV_LEN;
+    uint32_t counter_big_end = htonl(counter);
+    memcpy(aad, &counter_big_end, Config::AAD_LEN);
+    uint8_t *text = message_buffer + HEADER_LEN;
+    return cipher.encrypt(counter, text, static_cast<int>(plaintext_len), aad, Config::AAD_LEN,
+                          message_buffer, text, aad + Config::AAD_LEN);
+}
+
+/**
+ * Encrypt a message made of a message code and data stored elsewhere (e.g. a chunk in the mapping of a
+ * file) in a serialized Generic buffer: the data is read once by the cipher and never copied in plaintext.
+ * @param cipher The cipher of the session
+ * @param counter The counter value of the message
+ * @param message_buffer Buffer of getMessageSize(1 + data_len) bytes, on success it holds the serialized
+ * Generic message (IV, AAD, tag and ciphertext)
+ * @param message_code The message code, first byte of the plaintext
+ * @param data The rest of the plaintext
+ * @param data_len The length of the data
+ * @return The length of the ciphertext or -1 if encryption fails
+ */
+int Generic::sealFrom(SessionCipher &cipher, uint32_t counter, uint8_t *message_buffer, uint8_t message_code,
+                      const uint8_t *data, size_t data_len) {
+    uint8_t *aad = message_buffer + Config::IV_LEN;
+    uint32_t counter_big_end = htonl(counter);
+    memcpy(aad, &counter_big_end, Config::AAD_LEN);
+    return cipher.encrypt(counter, &message_code, sizeof(uint8_t), data, static_cast<int>(data_len),
+                          aad, Config::AAD_LEN, message_buffer, message_buffer + HEADER_LEN, aad + Config::AAD_LEN);
+}
+
+/**
+ * Decrypt a serialized Generic message in its buffer, without any allocation or copy.
+ * @param cipher The cipher of the session
+ * @param message_buffer Buffer of getMessageSize(plaintext_len) bytes holding the received message.
+ * On success the plaintext is at HEADER_LEN
+ * @param plaintext_len The length of the plaintext
+ * @param counter Set to the counter value of the message
+ * @return The length of the plaintext or -1 if decryption fails
+ */
+int Generic::openInPlace(SessionCipher &cipher, uint8_t *message_buffer, size_t plaintext_len, uint32_t &counter) {
+    uint8_t *aad = message_buffer + Config::IV_LEN;
+    uint32_t counter_big_end;
+    memcpy(&counter_big_end, aad, Config::AAD_LEN);
+    counter = ntohl(counter_big_end);
+    uint8_t *text = message_buffer + HEADER_LEN;
+    return cipher.decrypt(text, static_cast<int>(plaintext_len), aad, Config::AAD_LEN,
+                          message_buffer, aad + Config::AAD_LEN, text);
+}
+
 /**
  * Get the size of the Generic message in bytes
  * @param plaintext_len The length of the plaintext
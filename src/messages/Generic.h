@@ -5,6 +5,9 @@
 #include <openssl/evp.h>
 #include "Config.h"
 
+struct iovec;
+class SessionCipher;
+
 class Generic {
 
 private:
@@ -15,6 +18,11 @@ private:
     int m_ciphertext_len{};
 
 public:
+    // Number of buffers describing a serialized Generic message (IV, AAD, tag and ciphertext)
+    static constexpr int BUFFERS_NUM = 4;
+    // Bytes preceding the ciphertext in a serialized Generic message (IV, AAD and tag)
+    static constexpr size_t HEADER_LEN = Config::IV_LEN + Config::AAD_LEN + Config::AES_TAG_LEN;
+
     Generic();
 
     explicit Generic(uint32_t counter);
@@ -25,10 +33,24 @@ public:
 
     int decrypt(unsigned char *session_key, unsigned char *&plaintext);
 
+    int encrypt(SessionCipher &cipher, unsigned char *plaintext, int plaintext_len);
+
+    int decrypt(SessionCipher &cipher, unsigned char *&plaintext);
+
     uint8_t *serialize();
 
+    void getBuffers(iovec *buffers);
+
     static Generic deserialize(uint8_t *message_buffer, size_t ciphertext_len);
 
+    static int sealInPlace(SessionCipher &cipher, uint32_t counter, uint8_t *message_buffer, size_t plaintext_len);
+
+    static int sealFrom(SessionCipher &cipher, uint32_t counter, uint8_t *message_buffer, uint8_t message_code,
+                        const uint8_t *data, size_t data_len);
+
+    static int openInPlace(SessionCipher &cipher, uint8_t *message_buffer, size_t plaintext_len,
+                           uint32_t &counter);
+
     static size_t getMessageSize(size_t plaintext_len);
 
     void print(size_t plaintext_len) const;
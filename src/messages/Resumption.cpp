@@ -0,0 +1,296 @@
+#include <cstring>
+#include <iostream>
+#include <endian.h>
+#include <netinet/in.h>
+#include "Resumption.h"
+#include "CodesManager.h"
+#include "Generic.h"
+#include "Hash.h"
+
+using namespace std;
+
+/**
+ * @brief Default constructor for the SessionTicket class.
+ */
+SessionTicket::SessionTicket() = default;
+
+/**
+ * @brief Parameterized constructor for the SessionTicket class.
+ * @param username The username of the authenticated user.
+ * @param resumption_secret The secret shared with the client, used to derive the keys of the resumed sessions.
+ * @param expiration_time The time (seconds since the epoch) after which the ticket is rejected.
+ * @param chunk_size The chunk size negotiated during the full handshake.
+ * @param cipher_suite The AEAD algorithm negotiated during the full handshake.
+ */
+SessionTicket::SessionTicket(const string &username, const uint8_t *resumption_secret, uint64_t expiration_time,
+                             uint32_t chunk_size, uint8_t cipher_suite) {
+    strncpy(m_username, username.c_str(), Config::USERNAME_LEN - 1);
+    memcpy(m_resumption_secret, resumption_secret, RESUMPTION_SECRET_LEN);
+    m_expiration_time = expiration_time;
+    m_chunk_size = chunk_size;
+    m_cipher_suite = cipher_suite;
+}
+
+/**
+ * @brief Get the size of the serialized ticket content.
+ * @return The size of the ticket content in bytes.
+ */
+size_t SessionTicket::getMessageSize() {
+    return Config::USERNAME_LEN * sizeof(char) + RESUMPTION_SECRET_LEN + sizeof(uint64_t) + sizeof(uint32_t) +
+           sizeof(uint8_t);
+}
+
+/**
+ * @brief Serialize the ticket content into a byte buffer.
+ * @return A dynamically allocated byte buffer containing the serialized data.
+ */
+uint8_t *SessionTicket::serialize() {
+    auto *message_buffer = new uint8_t[getMessageSize()];
+    size_t current_buffer_position = 0;
+
+    memcpy(message_buffer, m_username, Config::USERNAME_LEN * sizeof(char));
+    current_buffer_position += Config::USERNAME_LEN * sizeof(char);
+    memcpy(message_buffer + current_buffer_position, m_resumption_secret, RESUMPTION_SECRET_LEN);
+    current_buffer_position += RESUMPTION_SECRET_LEN;
+
+    // Convert the expiration time and the chunk size to network byte order and copy to the buffer
+    uint64_t expiration_time_big_end = htobe64(m_expiration_time);
+    memcpy(message_buffer + current_buffer_position, &expiration_time_big_end, sizeof(uint64_t));
+    current_buffer_position += sizeof(uint64_t);
+    uint32_t chunk_size_big_end = htonl(m_chunk_size);
+    memcpy(message_buffer + current_buffer_position, &chunk_size_big_end, sizeof(uint32_t));
+    current_buffer_position += sizeof(uint32_t);
+    memcpy(message_buffer + current_buffer_position, &m_cipher_suite, sizeof(uint8_t));
+
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a byte buffer into a SessionTicket object.
+ * @param message_buffer The byte buffer containing the serialized data.
+ * @return A SessionTicket object with deserialized data.
+ */
+SessionTicket SessionTicket::deserialize(uint8_t *message_buffer) {
+    SessionTicket ticket;
+    size_t current_buffer_position = 0;
+
+    memcpy(ticket.m_username, message_buffer, Config::USERNAME_LEN * sizeof(char));
+    ticket.m_username[Config::USERNAME_LEN - 1] = '\0';
+    current_buffer_position += Config::USERNAME_LEN * sizeof(char);
+    memcpy(ticket.m_resumption_secret, message_buffer + current_buffer_position, RESUMPTION_SECRET_LEN);
+    current_buffer_position += RESUMPTION_SECRET_LEN;
+
+    uint64_t expiration_time_big_end = 0;
+    memcpy(&expiration_time_big_end, message_buffer + current_buffer_position, sizeof(uint64_t));
+    ticket.m_expiration_time = be64toh(expiration_time_big_end);
+    current_buffer_position += sizeof(uint64_t);
+    uint32_t chunk_size_big_end = 0;
+    memcpy(&chunk_size_big_end, message_buffer + current_buffer_position, sizeof(uint32_t));
+    ticket.m_chunk_size = ntohl(chunk_size_big_end);
+    current_buffer_position += sizeof(uint32_t);
+    memcpy(&ticket.m_cipher_suite, message_buffer + current_buffer_position, sizeof(uint8_t));
+
+    return ticket;
+}
+
+/**
+ * @brief Encrypt the ticket content with the ticket key of the server.
+ * @param ticket_key The key used by the server to seal its tickets.
+ * @return A dynamically allocated buffer of SEALED_TICKET_LEN bytes, nullptr on failure.
+ */
+uint8_t *SessionTicket::seal(unsigned char *ticket_key) {
+    Generic sealed_ticket(0);
+    if (sealed_ticket.encrypt(ticket_key, serialize(), static_cast<int>(getMessageSize())) == -1) {
+        return nullptr;
+    }
+    return sealed_ticket.serialize();
+}
+
+/**
+ * @brief Decrypt and authenticate a sealed ticket.
+ * @param ticket_key The key used by the server to seal its tickets.
+ * @param sealed_ticket The buffer of SEALED_TICKET_LEN bytes received from the client.
+ * @param ticket Set to the ticket content on success.
+ * @return 0 on success, -1 if the ticket has not been sealed with the ticket key.
+ */
+int SessionTicket::unseal(unsigned char *ticket_key, uint8_t *sealed_ticket, SessionTicket &ticket) {
+    Generic generic_ticket = Generic::deserialize(sealed_ticket, getMessageSize());
+    uint8_t *plaintext = nullptr;
+    if (generic_ticket.decrypt(ticket_key, plaintext) == -1) {
+        return -1;
+    }
+    ticket = deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, getMessageSize());
+    delete[] plaintext;
+    return 0;
+}
+
+/**
+ * @brief Derive the key of a resumed session from the resumption secret and the nonces of both peers.
+ * @param resumption_secret The secret of the ticket.
+ * @param client_nonce The nonce sent in the ResumptionM1 message.
+ * @param server_nonce The nonce sent in the ResumptionM2 message.
+ * @param session_key Buffer of AES_KEY_LEN bytes filled with the session key.
+ * @return 0 on success.
+ */
+int SessionTicket::deriveSessionKey(const uint8_t *resumption_secret, const uint8_t *client_nonce,
+                                    const uint8_t *server_nonce, unsigned char *session_key) {
+    // session key = SHA-256(secret || client nonce || server nonce), truncated to the AES key length
+    unsigned char key_material[RESUMPTION_SECRET_LEN + 2 * RESUMPTION_NONCE_LEN];
+    memcpy(key_material, resumption_secret, RESUMPTION_SECRET_LEN);
+    memcpy(key_material + RESUMPTION_SECRET_LEN, client_nonce, RESUMPTION_NONCE_LEN);
+    memcpy(key_material + RESUMPTION_SECRET_LEN + RESUMPTION_NONCE_LEN, server_nonce, RESUMPTION_NONCE_LEN);
+
+    unsigned char *digest = nullptr;
+    unsigned int digest_length;
+    Hash::generateSHA256(key_material, sizeof(key_material), digest, digest_length);
+    memcpy(session_key, digest, Config::AES_KEY_LEN);
+
+    OPENSSL_cleanse(key_material, sizeof(key_material));
+    OPENSSL_cleanse(digest, digest_length);
+    delete[] digest;
+    return 0;
+}
+
+const char *SessionTicket::getMUsername() const {
+    return m_username;
+}
+
+const uint8_t *SessionTicket::getMResumptionSecret() const {
+    return m_resumption_secret;
+}
+
+uint64_t SessionTicket::getMExpirationTime() const {
+    return m_expiration_time;
+}
+
+uint32_t SessionTicket::getMChunkSize() const {
+    return m_chunk_size;
+}
+
+uint8_t SessionTicket::getMCipherSuite() const {
+    return m_cipher_suite;
+}
+
+
+/**
+ * @brief Default constructor for the ResumptionM1 class.
+ */
+ResumptionM1::ResumptionM1() = default;
+
+/**
+ * @brief Parameterized constructor for the ResumptionM1 class.
+ * @param sealed_ticket The ticket received at the end of the last full handshake.
+ * @param client_nonce A fresh random nonce.
+ */
+ResumptionM1::ResumptionM1(const uint8_t *sealed_ticket, const uint8_t *client_nonce) {
+    m_message_code = static_cast<uint8_t>(Message::RESUMPTION_REQUEST);
+    memcpy(m_sealed_ticket, sealed_ticket, SEALED_TICKET_LEN);
+    memcpy(m_client_nonce, client_nonce, RESUMPTION_NONCE_LEN);
+}
+
+/**
+ * @brief Get the size of the ResumptionM1 message.
+ * @return The size of the ResumptionM1 message in bytes.
+ */
+size_t ResumptionM1::getMessageSize() {
+    return sizeof(uint8_t) + SEALED_TICKET_LEN + RESUMPTION_NONCE_LEN;
+}
+
+/**
+ * @brief Serialize the ResumptionM1 object into a byte buffer.
+ * @return A dynamically allocated byte buffer containing the serialized data.
+ */
+uint8_t *ResumptionM1::serialize() {
+    auto *message_buffer = new uint8_t[getMessageSize()];
+    size_t current_buffer_position = 0;
+
+    memcpy(message_buffer, &m_message_code, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+    memcpy(message_buffer + current_buffer_position, m_sealed_ticket, SEALED_TICKET_LEN);
+    current_buffer_position += SEALED_TICKET_LEN;
+    memcpy(message_buffer + current_buffer_position, m_client_nonce, RESUMPTION_NONCE_LEN);
+
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a byte buffer into a ResumptionM1 object.
+ * @param message_buffer The byte buffer containing the serialized data.
+ * @return A ResumptionM1 object with deserialized data.
+ */
+ResumptionM1 ResumptionM1::deserialize(uint8_t *message_buffer) {
+    ResumptionM1 resumptionM1;
+    size_t current_buffer_position = 0;
+
+    memcpy(&resumptionM1.m_message_code, message_buffer, sizeof(uint8_t));
+    current_buffer_position += sizeof(uint8_t);
+    memcpy(resumptionM1.m_sealed_ticket, message_buffer + current_buffer_position, SEALED_TICKET_LEN);
+    current_buffer_position += SEALED_TICKET_LEN;
+    memcpy(resumptionM1.m_client_nonce, message_buffer + current_buffer_position, RESUMPTION_NONCE_LEN);
+
+    return resumptionM1;
+}
+
+const uint8_t *ResumptionM1::getMSealedTicket() const {
+    return m_sealed_ticket;
+}
+
+const uint8_t *ResumptionM1::getMClientNonce() const {
+    return m_client_nonce;
+}
+
+
+/**
+ * @brief Default constructor for the ResumptionM2 class.
+ */
+ResumptionM2::ResumptionM2() = default;
+
+/**
+ * @brief Parameterized constructor for the ResumptionM2 class.
+ * @param message_code ACK if the ticket has been accepted, NACK otherwise.
+ * @param server_nonce A fresh random nonce.
+ */
+ResumptionM2::ResumptionM2(uint8_t message_code, const uint8_t *server_nonce) {
+    m_message_code = message_code;
+    memcpy(m_server_nonce, server_nonce, RESUMPTION_NONCE_LEN);
+}
+
+/**
+ * @brief Get the size of the ResumptionM2 message.
+ * @return The size of the ResumptionM2 message in bytes.
+ */
+size_t ResumptionM2::getMessageSize() {
+    return sizeof(uint8_t) + RESUMPTION_NONCE_LEN;
+}
+
+/**
+ * @brief Serialize the ResumptionM2 object into a byte buffer.
+ * @return A dynamically allocated byte buffer containing the serialized data.
+ */
+uint8_t *ResumptionM2::serialize() {
+    auto *message_buffer = new uint8_t[getMessageSize()];
+    memcpy(message_buffer, &m_message_code, sizeof(uint8_t));
+    memcpy(message_buffer + sizeof(uint8_t), m_server_nonce, RESUMPTION_NONCE_LEN);
+    return message_buffer;
+}
+
+/**
+ * @brief Deserialize a byte buffer into a ResumptionM2 object.
+ * @param message_buffer The byte buffer containing the serialized data.
+ * @return A ResumptionM2 object with deserialized data.
+ */
+ResumptionM2 ResumptionM2::deserialize(uint8_t *message_buffer) {
+    ResumptionM2 resumptionM2;
+    memcpy(&resumptionM2.m_message_code, message_buffer, sizeof(uint8_t));
+    memcpy(resumptionM2.m_server_nonce, message_buffer + sizeof(uint8_t), RESUMPTION_NONCE_LEN);
+    return resumptionM2;
+}
+
+uint8_t ResumptionM2::getMMessageCode() const {
+    return m_message_code;
+}
+
+const uint8_t *ResumptionM2::getMServerNonce() const {
+    return m_server_nonce;
+}
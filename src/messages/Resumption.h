@@ -0,0 +1,99 @@
+#ifndef SECURE_CLOUD_STORAGE_RESUMPTION_H
+#define SECURE_CLOUD_STORAGE_RESUMPTION_H
+
+#include <cstdint>
+#include <string>
+#include "Config.h"
+
+using namespace std;
+
+namespace {
+    const uint16_t RESUMPTION_SECRET_LEN = 32;
+    const uint16_t RESUMPTION_NONCE_LEN = 16;
+    // Ticket content encrypted as a Generic message (IV, AAD, tag and ciphertext)
+    const uint16_t SEALED_TICKET_LEN = Config::IV_LEN + Config::AAD_LEN + Config::AES_TAG_LEN +
+                                       Config::USERNAME_LEN + RESUMPTION_SECRET_LEN +
+                                       sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+}
+
+/**
+ * Content of a session resumption ticket. The ticket is sealed by the server with a key known only to
+ * itself, so the server does not keep any state for the issued tickets.
+ */
+class SessionTicket {
+private:
+    char m_username[Config::USERNAME_LEN]{};
+    uint8_t m_resumption_secret[RESUMPTION_SECRET_LEN]{};
+    uint64_t m_expiration_time{};
+    uint32_t m_chunk_size{};
+    uint8_t m_cipher_suite{};
+
+public:
+    SessionTicket();
+    SessionTicket(const string& username, const uint8_t* resumption_secret, uint64_t expiration_time,
+                  uint32_t chunk_size, uint8_t cipher_suite);
+
+    static size_t getMessageSize();
+
+    uint8_t* serialize();
+    static SessionTicket deserialize(uint8_t* message_buffer);
+
+    uint8_t* seal(unsigned char* ticket_key);
+    static int unseal(unsigned char* ticket_key, uint8_t* sealed_ticket, SessionTicket& ticket);
+
+    static int deriveSessionKey(const uint8_t* resumption_secret, const uint8_t* client_nonce,
+                                const uint8_t* server_nonce, unsigned char* session_key);
+
+    const char* getMUsername() const;
+    const uint8_t* getMResumptionSecret() const;
+    uint64_t getMExpirationTime() const;
+    uint32_t getMChunkSize() const;
+    uint8_t getMCipherSuite() const;
+};
+
+/**
+ * First message of a resumed session: the sealed ticket and a fresh client nonce.
+ * It is longer than the fixed fields of AuthenticationM1, so the server reads those fields for every session,
+ * tells the two messages apart by the message code and then reads the rest of the message.
+ */
+class ResumptionM1 {
+private:
+    uint8_t m_message_code{};
+    uint8_t m_sealed_ticket[SEALED_TICKET_LEN]{};
+    uint8_t m_client_nonce[RESUMPTION_NONCE_LEN]{};
+
+public:
+    ResumptionM1();
+    ResumptionM1(const uint8_t* sealed_ticket, const uint8_t* client_nonce);
+
+    static size_t getMessageSize();
+
+    uint8_t* serialize();
+    static ResumptionM1 deserialize(uint8_t* message_buffer);
+
+    const uint8_t* getMSealedTicket() const;
+    const uint8_t* getMClientNonce() const;
+};
+
+/**
+ * Answer of the server to a ResumptionM1: ACK with the server nonce if the ticket is accepted, NACK otherwise.
+ */
+class ResumptionM2 {
+private:
+    uint8_t m_message_code{};
+    uint8_t m_server_nonce[RESUMPTION_NONCE_LEN]{};
+
+public:
+    ResumptionM2();
+    ResumptionM2(uint8_t message_code, const uint8_t* server_nonce);
+
+    static size_t getMessageSize();
+
+    uint8_t* serialize();
+    static ResumptionM2 deserialize(uint8_t* message_buffer);
+
+    uint8_t getMMessageCode() const;
+    const uint8_t* getMServerNonce() const;
+};
+
+#endif //SECURE_CLOUD_STORAGE_RESUMPTION_H
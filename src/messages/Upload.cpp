@@ -20,8 +20,9 @@ UploadM1::UploadM1() = default;
  * Constructor of UploadM1 class object. Used to create a type 1 upload request message (UploadM1).
  * @param file_name a string containing the name of the file to be uploaded.
  * @param file_size a size_t representing the size of the file to be uploaded.
+ * @param version the modification time of the file, an interrupted upload is resumed only for the same version.
  */
-UploadM1::UploadM1(std::string&  filename, size_t file_size) {
+UploadM1::UploadM1(std::string&  filename, size_t file_size, uint64_t version) {
     // Set the message code attribute of the current object to UPLOAD_REQ.
     m_message_code = static_cast<uint8_t>(Message::UPLOAD_REQUEST);
 
@@ -30,6 +31,8 @@ UploadM1::UploadM1(std::string&  filename, size_t file_size) {
 
     // Set the m_filesize and ensure that does not exceed a maximum value of 4GB (converted in uint32_t), if so is set to 0
     m_file_size = (file_size < 4UL * 1000 * 1000 * 1000) ? (uint32_t)file_size : 0;
+
+    m_version = version;
 }
 
 
@@ -59,6 +62,11 @@ uint8_t *UploadM1::serializeUploadM1() {
     // Move the position to the next available space in the buffer.
     current_position += sizeof(uint32_t);
 
+    // Copy the file version attribute to the buffer at the current position.
+    memcpy(upload_message_buffer + current_position, &m_version, sizeof(uint64_t));
+    // Move the position to the next available space in the buffer.
+    current_position += sizeof(uint64_t);
+
     // Add random bytes to the buffer to fill the remaining space.
     RAND_bytes(upload_message_buffer + current_position, Config::MAX_PACKET_SIZE - current_position);
 
@@ -91,6 +99,11 @@ UploadM1 UploadM1::deserializeUploadM1(uint8_t *upload_message_buffer) {
 
     // Copy the value of file size from the buffer to the uploadM1 object.
     memcpy(&uploadM1.m_file_size, upload_message_buffer + current_position, sizeof(uint32_t));
+    // Move the position to the next available space in the buffer.
+    current_position += sizeof(uint32_t);
+
+    // Copy the value of file version from the buffer to the uploadM1 object.
+    memcpy(&uploadM1.m_version, upload_message_buffer + current_position, sizeof(uint64_t));
 
     // Return the uploadM1 object created.
     return uploadM1;
@@ -102,7 +115,8 @@ UploadM1 UploadM1::deserializeUploadM1(uint8_t *upload_message_buffer) {
  * @return Returns the total size of an UploadM1 message.
  */
 size_t UploadM1::getSizeUploadM1() {
-    size_t size = sizeof(m_message_code) + (Config::FILE_NAME_LEN * sizeof(char)) + sizeof(m_file_size);
+    size_t size = sizeof(m_message_code) + (Config::FILE_NAME_LEN * sizeof(char)) + sizeof(m_file_size) +
+                  sizeof(m_version);
     return size;
 }
 
@@ -122,6 +136,220 @@ uint32_t UploadM1::getFileSize() const {
     return m_file_size;
 }
 
+/**
+ * Get the file version of the UploadM1 message
+ * @return returns the modification time of the file to be uploaded
+ */
+uint64_t UploadM1::getVersion() const {
+    return m_version;
+}
+
+
+
+//-------------------------------------------UPLOAD MESSAGE 2-------------------------------------------//
+
+/**
+ * Default constructor of UploadM2 class
+ */
+UploadM2::UploadM2() = default;
+
+
+/**
+ * Constructor of UploadM2 class object. Used to create the response to an upload request (UploadM2).
+ * @param message_code ACK if the upload can start, NACK otherwise.
+ * @param offset the bytes of the file already received by the server in an interrupted upload, from which the
+ * client resumes the upload.
+ */
+UploadM2::UploadM2(uint8_t message_code, uint32_t offset) {
+    m_message_code = message_code;
+    m_offset = offset;
+}
+
+
+/**
+ * Function to serialize data for the type 2 upload message into a byte buffer
+ * @return Returns a dynamically allocated uint8_t array representing the serialized data.
+ */
+uint8_t *UploadM2::serializeUploadM2() {
+    // Dynamically allocate memory for a buffer to hold the serialized data.
+    uint8_t* upload_message_buffer = new uint8_t[Config::MAX_PACKET_SIZE];
+    size_t current_position = 0;
+
+    // Copy the message code and the offset to the buffer.
+    memcpy(upload_message_buffer, &m_message_code, sizeof(uint8_t));
+    current_position += sizeof(uint8_t);
+    memcpy(upload_message_buffer + current_position, &m_offset, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+
+    // Add random bytes to the buffer to fill the remaining space.
+    RAND_bytes(upload_message_buffer + current_position, Config::MAX_PACKET_SIZE - current_position);
+
+    return upload_message_buffer;
+}
+
+
+/**
+ * Function to deserialize data from the upload message buffer and construct a UploadM2 object
+ * @param upload_message_buffer the serialized buffer with the message
+ * @return Return the constructed UploadM2 object with deserialized data
+ */
+UploadM2 UploadM2::deserializeUploadM2(uint8_t *upload_message_buffer) {
+    UploadM2 uploadM2;
+    size_t current_position = 0;
+
+    // Copy the message code and the offset from the buffer to the uploadM2 object.
+    memcpy(&uploadM2.m_message_code, upload_message_buffer, sizeof(uint8_t));
+    current_position += sizeof(uint8_t);
+    memcpy(&uploadM2.m_offset, upload_message_buffer + current_position, sizeof(uint32_t));
+
+    return uploadM2;
+}
+
+
+/**
+ * Get the size of the UploadM2 message in bytes
+ * @return Returns the total size of an UploadM2 message.
+ */
+size_t UploadM2::getSizeUploadM2() {
+    return sizeof(m_message_code) + sizeof(m_offset);
+}
+
+/**
+ * Get the message code of the UploadM2 message
+ * @return The message code (ACK or NACK)
+ */
+uint8_t UploadM2::getMessageCode() const {
+    return m_message_code;
+}
+
+/**
+ * Get the offset of the UploadM2 message
+ * @return The offset from which the file is uploaded
+ */
+uint32_t UploadM2::getOffset() const {
+    return m_offset;
+}
+
+
+//----------------------------------------UPLOAD RANGE MESSAGE 1----------------------------------------//
+
+/**
+ * Default constructor of UploadRangeM1 class
+ */
+UploadRangeM1::UploadRangeM1() = default;
+
+
+/**
+ * Constructor of UploadRangeM1 class object. Used to upload a byte range of a file (UploadRangeM1), in place
+ * of the UploadM1 message.
+ * @param file_name a string containing the name of the file to be uploaded.
+ * @param file_size a size_t representing the size of the whole file.
+ * @param offset the offset of the first byte of the range.
+ * @param length the length of the range in bytes.
+ */
+UploadRangeM1::UploadRangeM1(std::string& filename, size_t file_size, uint32_t offset, uint32_t length) {
+    m_message_code = static_cast<uint8_t>(Message::UPLOAD_RANGE_REQUEST);
+    strncpy(m_filename, filename.c_str(), Config::FILE_NAME_LEN);
+    // The file size is set to 0 if it exceeds 4GB (as in UploadM1)
+    m_file_size = (file_size < 4UL * 1000 * 1000 * 1000) ? (uint32_t)file_size : 0;
+    m_offset = offset;
+    m_length = length;
+}
+
+
+/**
+ * Function to serialize data for the upload range message into a byte buffer
+ * @return Returns a dynamically allocated uint8_t array representing the serialized data.
+ */
+uint8_t *UploadRangeM1::serializeUploadRangeM1() {
+    uint8_t* upload_message_buffer = new uint8_t[Config::MAX_PACKET_SIZE];
+    size_t current_position = 0;
+
+    // Copy the message code, the filename and the file size
+    memcpy(upload_message_buffer, &m_message_code, sizeof(uint8_t));
+    current_position += sizeof(uint8_t);
+    memcpy(upload_message_buffer + current_position, m_filename, Config::FILE_NAME_LEN * sizeof(char));
+    current_position += Config::FILE_NAME_LEN * sizeof(char);
+    memcpy(upload_message_buffer + current_position, &m_file_size, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+
+    // Copy the range offset and length
+    memcpy(upload_message_buffer + current_position, &m_offset, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+    memcpy(upload_message_buffer + current_position, &m_length, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+
+    // Add random bytes to the buffer to fill the remaining space.
+    RAND_bytes(upload_message_buffer + current_position, Config::MAX_PACKET_SIZE - current_position);
+
+    return upload_message_buffer;
+}
+
+
+/**
+ * Function to deserialize data from the upload range message buffer and construct a UploadRangeM1 object
+ * @param upload_message_buffer the serialized buffer with the message
+ * @return Return the constructed UploadRangeM1 object with deserialized data
+ */
+UploadRangeM1 UploadRangeM1::deserializeUploadRangeM1(uint8_t *upload_message_buffer) {
+    UploadRangeM1 uploadRangeM1;
+    size_t current_position = 0;
+
+    memcpy(&uploadRangeM1.m_message_code, upload_message_buffer, sizeof(uint8_t));
+    current_position += sizeof(uint8_t);
+    memcpy(uploadRangeM1.m_filename, upload_message_buffer + current_position, Config::FILE_NAME_LEN * sizeof(char));
+    current_position += Config::FILE_NAME_LEN * sizeof(char);
+    memcpy(&uploadRangeM1.m_file_size, upload_message_buffer + current_position, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+    memcpy(&uploadRangeM1.m_offset, upload_message_buffer + current_position, sizeof(uint32_t));
+    current_position += sizeof(uint32_t);
+    memcpy(&uploadRangeM1.m_length, upload_message_buffer + current_position, sizeof(uint32_t));
+
+    return uploadRangeM1;
+}
+
+
+/**
+ * Get the size of the UploadRangeM1 message in bytes
+ * @return Returns the total size of an UploadRangeM1 message.
+ */
+size_t UploadRangeM1::getSizeUploadRangeM1() {
+    return sizeof(m_message_code) + (Config::FILE_NAME_LEN * sizeof(char)) + sizeof(m_file_size) +
+           sizeof(m_offset) + sizeof(m_length);
+}
+
+/**
+ * Get the filename of the UploadRangeM1 message
+ * @return returns the filename of the UploadRangeM1 message
+ */
+const char *UploadRangeM1::getFilename() const {
+    return m_filename;
+}
+
+/**
+ * Get the size of the whole file
+ * @return returns the file size of the UploadRangeM1 message
+ */
+uint32_t UploadRangeM1::getFileSize() const {
+    return m_file_size;
+}
+
+/**
+ * Get the offset of the range
+ * @return returns the offset of the first byte of the range
+ */
+uint32_t UploadRangeM1::getOffset() const {
+    return m_offset;
+}
+
+/**
+ * Get the length of the range
+ * @return returns the length of the range in bytes
+ */
+uint32_t UploadRangeM1::getLength() const {
+    return m_length;
+}
+
 
 
 //-------------------------------------------UPLOAD MESSAGE 3+i-------------------------------------------//
@@ -11,8 +11,10 @@
 #include "Config.h"
 
 
-//M1:(UPLOAD REQUEST, FILENAME SIZE)
-//M2:(SUCCESS ACK for the request) --> is SimpleMessage (initialized in the server) and not defined here
+//M1:(UPLOAD REQUEST, FILENAME SIZE, FILE VERSION)
+//M2:(SUCCESS ACK for the request, RESUME OFFSET)
+//RangeM2:(SUCCESS ACK for the range request) --> is SimpleMessage (initialized in the server) and not defined here
+//RangeM1:(UPLOAD RANGE REQUEST, FILENAME, FILE SIZE, RANGE OFFSET, RANGE LENGTH) --> replaces M1 in a range upload
 //M3+i:(UPLOAD CHUNK, FILE CHUNK)
 //M3+i+1:(SUCCESS ACK for the upload) --> is SimpleMessage (initialized in the server) and not defined here
 
@@ -23,16 +25,63 @@ private:
     uint8_t m_message_code;
     char m_filename[Config::FILE_NAME_LEN];
     uint32_t m_file_size;
+    uint64_t m_version;
 
 public:
     UploadM1();
-    UploadM1(std::string& file_name, size_t file_size);
+    UploadM1(std::string& file_name, size_t file_size, uint64_t version = 0);
 
     uint8_t* serializeUploadM1();
     static UploadM1 deserializeUploadM1(uint8_t* upload_message_buffer);
     static size_t getSizeUploadM1();
     const char *getFilename() const;
     uint32_t getFileSize() const;
+    uint64_t getVersion() const;
+
+};
+
+
+
+class UploadM2 {
+
+private:
+    uint8_t m_message_code;
+    uint32_t m_offset;
+
+public:
+    UploadM2();
+    UploadM2(uint8_t message_code, uint32_t offset);
+
+    uint8_t* serializeUploadM2();
+    static UploadM2 deserializeUploadM2(uint8_t* upload_message_buffer);
+    static size_t getSizeUploadM2();
+    uint8_t getMessageCode() const;
+    uint32_t getOffset() const;
+
+};
+
+
+
+class UploadRangeM1 {
+
+private:
+    uint8_t m_message_code;
+    char m_filename[Config::FILE_NAME_LEN];
+    uint32_t m_file_size;
+    uint32_t m_offset;
+    uint32_t m_length;
+
+public:
+    UploadRangeM1();
+    UploadRangeM1(std::string& file_name, size_t file_size, uint32_t offset, uint32_t length);
+
+    uint8_t* serializeUploadRangeM1();
+    static UploadRangeM1 deserializeUploadRangeM1(uint8_t* upload_message_buffer);
+    static size_t getSizeUploadRangeM1();
+    const char *getFilename() const;
+    uint32_t getFileSize() const;
+    uint32_t getOffset() const;
+    uint32_t getLength() const;
 
 };
 
@@ -1,9 +1,13 @@
 #include <iostream>
+#include <vector>
 #include <thread>
 #include <openssl/pem.h>
 #include <openssl/err.h>
+#include <openssl/rand.h>
 #include <string>
 #include <sstream>
+#include <sys/uio.h>
+#include <filesystem>
 
 #include "SocketManager.h"
 #include "Client.h"
@@ -21,12 +25,88 @@
 #include "Hash.h"
 #include "DigitalSignatureManager.h"
 #include "AesGcm.h"
+#include "SessionCipher.h"
 #include "CertificateManager.h"
+#include "Resumption.h"
+
+unsigned int Client::m_connections_num = 1;
+uint32_t Client::m_requested_chunk_size = Config::CHUNK_SIZE;
+CipherSuite Client::m_requested_cipher_suite = CipherSuite::AES_128_GCM;
+KeyExchange Client::m_requested_key_exchange = KeyExchange::X25519;
+map<string, Client::CachedTicket> Client::m_tickets;
+mutex Client::m_tickets_mutex;
 
 Client::Client() = default;
 
+/**
+ * @brief Constructor for a helper session of a parallel transfer.
+ * @param username The username of the logged user.
+ * @param long_term_private_key The private key of the user, owned by the main session.
+ */
+Client::Client(const string &username, EVP_PKEY *long_term_private_key)
+        : m_username(username), m_counter(0), m_long_term_private_key(long_term_private_key) {}
+
 Client::~Client() {
+    // Close the connection with the server
+    delete m_socket;
+    delete m_cipher;
+}
+
+/**
+ * @brief Set the number of sessions used to transfer the ranges of a file.
+ * @param connections_num The number of sessions (1 disables the parallel transfers).
+ */
+void Client::setConnectionsNum(unsigned int connections_num) {
+    m_connections_num = max(1u, min(connections_num, Config::MAX_CONNECTIONS));
+}
+
+/**
+ * @brief Set the chunk size requested to the server during the authentication.
+ * @param chunk_size The chunk size in bytes. The server clamps it to its bounds.
+ */
+void Client::setRequestedChunkSize(uint32_t chunk_size) {
+    m_requested_chunk_size = chunk_size;
+}
+
+/**
+ * @brief Set the AEAD algorithm requested to the server during the authentication.
+ * @param cipher_suite The cipher suite. The server falls back to AES-128-GCM if it does not support it.
+ */
+void Client::setRequestedCipherSuite(CipherSuite cipher_suite) {
+    m_requested_cipher_suite = cipher_suite;
+}
 
+/**
+ * @brief Set the group of the ephemeral key exchange of the full handshakes.
+ * @param key_exchange The key exchange group, X25519 by default.
+ */
+void Client::setRequestedKeyExchange(KeyExchange key_exchange) {
+    m_requested_key_exchange = key_exchange;
+}
+
+/**
+ * @brief Open a new connection with the server and authenticate the user.
+ * The session is resumed from the ticket of the user when available, otherwise (or if the server rejects the
+ * ticket) the full handshake is performed.
+ * @return An integer code indicating the result of the authentication process.
+ */
+int Client::connect() {
+    try {
+        m_socket = SocketManager::createConnection(Config::SERVER_IP, Config::SERVER_PORT);
+        int result = resumptionRequest();
+        if (result == static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
+            return result;
+        }
+        if (result != static_cast<int>(Return::TICKET_NOT_FOUND)) {
+            // The server closes the connection after a failed resumption
+            delete m_socket;
+            m_socket = nullptr;
+            m_socket = SocketManager::createConnection(Config::SERVER_IP, Config::SERVER_PORT);
+        }
+    } catch (const exception &e) {
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    return authenticationRequest();
 }
 
 
@@ -35,7 +115,8 @@ Client::~Client() {
  *
  * 1.1) Create an instance of DiffieHellman for key exchange.
  * 1.2) Generate a client's ephemeral key pair and serialize it
- * 1.3) Send an AuthenticationM1 message to the server with the client's ephemeral key and username.
+ * 1.3) Send an AuthenticationM1 message to the server with the client's ephemeral key, username and requested
+ * chunk size.
  * 2) Receive and deserialize an AuthenticationM2 message from the server indicating the existence of the user.
  * 2.1) If the user not exists: return with an USERNAME_NOT_FOUND code
  * 2.1) If the user exists proceed with the key exchange and authentication process.
@@ -50,15 +131,17 @@ Client::~Client() {
  * 3.9) Verify the digital signature using the server's public key
  * 4.1) Encrypt the message {<g^a,g^b>S}K_session
  * 4.2) Create, serialize and send an AuthenticationM4 message to the server
- * 5) Receive, deserialize, decrypt an AuthenticationM5 SimpleMessage to see if the authentication was done correctly
- * 5.1) If there is an ACK, return an AUTHENTICATION_SUCCESS
+ * 5) Receive, deserialize, decrypt an AuthenticationM5 message to see if the authentication was done correctly
+ * 5.1) If there is an ACK, size the chunks of the session as chosen by the server
  * 5.2) If there is a NACK, return an AUTHENTICATION_FAILURE
+ * 6) Receive the session ticket in an AuthenticationM6 message, store it and return an AUTHENTICATION_SUCCESS
  *
  * @return An integer code indicating the result of the authentication process.
  */
 int Client::authenticationRequest() {
-    // Create an instance of DiffieHellman for key exchange
-    DiffieHellman dh_instance;
+    // Create an instance of DiffieHellman for key exchange, in the requested group
+    DiffieHellman dh_instance(m_requested_key_exchange);
+    auto key_exchange = static_cast<uint8_t>(m_requested_key_exchange);
 
     // Generate a client's ephemeral key pair
     EVP_PKEY* client_ephemeral_key = dh_instance.generateEphemeralKey();
@@ -75,10 +158,11 @@ int Client::authenticationRequest() {
     }
 
     // Authentication M1 message
-    size_t serialized_message_length = AuthenticationM1::getMessageSize();
+    size_t serialized_message_length = AuthenticationM1::getMessageSize(key_exchange);
     AuthenticationM1 authenticationM1(serialized_client_ephemeral_key,
                                       serialized_client_ephemeral_key_length,
-                                      m_username);
+                                      m_username, m_requested_chunk_size,
+                                      static_cast<uint8_t>(m_requested_cipher_suite), key_exchange);
     uint8_t* serialized_message = authenticationM1.serialize();
 
     // Send Authentication M1 message to the server
@@ -117,7 +201,7 @@ int Client::authenticationRequest() {
     }
 
     // Authentication M3 message
-    size_t authenticationM3_length = AuthenticationM3::getMessageSize();
+    size_t authenticationM3_length = AuthenticationM3::getMessageSize(key_exchange);
     serialized_message = new uint8_t[authenticationM3_length];
     result = m_socket->receive(serialized_message, authenticationM3_length);
     if (result != 0) {
@@ -129,7 +213,7 @@ int Client::authenticationRequest() {
     }
 
     // Deserialize Authentication M3 message
-    AuthenticationM3 authenticationM3 = AuthenticationM3::deserialize(serialized_message);
+    AuthenticationM3 authenticationM3 = AuthenticationM3::deserialize(serialized_message, key_exchange);
     OPENSSL_cleanse(serialized_message, serialized_message_length);
 
     // Check if counters are equal for Authentication M3
@@ -172,6 +256,9 @@ int Client::authenticationRequest() {
 
     // Copy the session key to the client's member variable
     memcpy(m_session_key, session_key, Config::AES_KEY_LEN);
+    // The last handshake messages are AES-128-GCM: the negotiated suite is used after the counter reset
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::CLIENT);
     OPENSSL_cleanse(shared_secret, shared_secret_length);
     delete[] shared_secret;
     OPENSSL_cleanse(session_key, session_key_length);
@@ -182,7 +269,7 @@ int Client::authenticationRequest() {
     unsigned char* decrypted_signature = nullptr;
     int decrypted_signature_length = aesGcm.decrypt(
             const_cast<unsigned char *>(authenticationM3.getMEncryptedDigitalSignature()),
-            ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t),
+            static_cast<int>(authenticationM3.getMEncryptedDigitalSignatureLen()),
             (unsigned char *) authenticationM3.getMAad(),
             Config::AAD_LEN, const_cast<unsigned char *>(authenticationM3.getMIv()),
             (unsigned char *) authenticationM3.getMTag(), decrypted_signature);
@@ -207,9 +294,15 @@ int Client::authenticationRequest() {
     unsigned char* digital_signature = nullptr;
     unsigned int digital_signature_length;
     DigitalSignatureManager digitalSignatureManager;
-    digitalSignatureManager.generateDS(ephemeral_key_buffer, ephemeral_key_buffer_length,
-                                       digital_signature, digital_signature_length,
-                                       m_long_term_private_key);
+    if (digitalSignatureManager.generateDS(ephemeral_key_buffer, ephemeral_key_buffer_length,
+                                           digital_signature, digital_signature_length,
+                                           m_long_term_private_key) != 0) {
+        delete[] serialized_message;
+        delete[] ephemeral_key_buffer;
+        delete[] decrypted_signature;
+        delete[] digital_signature;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
 
     // Retrieve server's certificate and verify it
     CertificateManager* certificateManager = CertificateManager::getInstance();
@@ -248,7 +341,7 @@ int Client::authenticationRequest() {
     unsigned char aad[sizeof(uint32_t)];
     memcpy(aad, &m_counter, Config::AAD_LEN);
     unsigned char tag[Config::AES_TAG_LEN];
-    int ciphertext_length = aesGcm.encrypt(digital_signature, ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t),
+    int ciphertext_length = aesGcm.encrypt(digital_signature, static_cast<int>(digital_signature_length),
                                            aad, Config::AAD_LEN,
                                            ciphertext, tag);
     delete[] digital_signature;
@@ -262,7 +355,7 @@ int Client::authenticationRequest() {
 
     // Authentication M4 message creation
     serialized_message_length = AuthenticationM4::getMessageSize();
-    AuthenticationM4 authenticationM4(aesGcm.getIV(), aad, tag, ciphertext);
+    AuthenticationM4 authenticationM4(aesGcm.getIV(), aad, tag, ciphertext, ciphertext_length);
     serialized_message = authenticationM4.serialize();
     result = m_socket->send(serialized_message, serialized_message_length);
 
@@ -294,7 +387,7 @@ int Client::authenticationRequest() {
     auto *plaintext = new uint8_t[Config::MAX_PACKET_SIZE];
 
     // Decrypt the received ciphertext
-    if (generic_message.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_message.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
@@ -305,19 +398,155 @@ int Client::authenticationRequest() {
     }
 
     // Check the result in the plaintext to ensure successful authentication
-    if (static_cast<Result>(plaintext[0]) != Result::ACK) {
+    AuthenticationM5 authenticationM5 = AuthenticationM5::deserialize(plaintext);
+    if (static_cast<Result>(authenticationM5.getMMessageCode()) != Result::ACK) {
         delete[] plaintext;
         cerr << "AuthenticationM5 - " << "Client Signature not verified!" << endl;
         return static_cast<int>(Return::AUTHENTICATION_FAILURE);
     }
 
-    // Clean up and reset the counter
+    // Size the chunks of the session as chosen by the server
+    if (authenticationM5.getMChunkSize() < Config::MIN_CHUNK_SIZE ||
+        authenticationM5.getMChunkSize() > Config::MAX_CHUNK_SIZE) {
+        delete[] plaintext;
+        cerr << "AuthenticationM5 - " << "Invalid chunk size!" << endl;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    m_chunk_size = authenticationM5.getMChunkSize();
+
+    // Encrypt the session messages with the AEAD algorithm chosen by the server
+    if (!SessionCipher::isSupported(authenticationM5.getMCipherSuite())) {
+        delete[] plaintext;
+        cerr << "AuthenticationM5 - " << "Invalid cipher suite!" << endl;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    m_cipher_suite = static_cast<CipherSuite>(authenticationM5.getMCipherSuite());
     delete[] plaintext;
+
+    // Receive the session ticket in the AuthenticationM6 message
+    incrementCounter();
+    result = receiveSessionTicket();
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+
+    // Reset the counter and switch to the negotiated cipher suite
     m_counter = 0;
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::CLIENT, m_cipher_suite);
     // Return success code after successful authentication
     return static_cast<int>(Return::AUTHENTICATION_SUCCESS);
 }
 
+/**
+ * @brief Resume a session with the ticket received at the end of a previous full handshake of the user.
+ * 1) Send a ResumptionM1 message with the sealed ticket and a fresh client nonce
+ * 2) Receive a ResumptionM2 message with the result and the server nonce
+ * 2.1) If there is a NACK, forget the ticket and return an AUTHENTICATION_FAILURE
+ * 2.2) If there is an ACK, derive the session key from the resumption secret and the nonces of both peers
+ *
+ * @return AUTHENTICATION_SUCCESS if the session has been resumed, TICKET_NOT_FOUND if no valid ticket is
+ * available (nothing has been sent), another error code otherwise.
+ */
+int Client::resumptionRequest() {
+    CachedTicket ticket{};
+    {
+        lock_guard<mutex> lock(m_tickets_mutex);
+        auto entry = m_tickets.find(m_username);
+        if (entry == m_tickets.end()) {
+            return static_cast<int>(Return::TICKET_NOT_FOUND);
+        }
+        if (entry->second.expiration_time <= chrono::steady_clock::now()) {
+            OPENSSL_cleanse(&entry->second, sizeof(CachedTicket));
+            m_tickets.erase(entry);
+            return static_cast<int>(Return::TICKET_NOT_FOUND);
+        }
+        ticket = entry->second;
+    }
+
+    // ResumptionM1
+    uint8_t client_nonce[RESUMPTION_NONCE_LEN];
+    RAND_bytes(client_nonce, RESUMPTION_NONCE_LEN);
+    ResumptionM1 resumptionM1(ticket.sealed_ticket, client_nonce);
+    uint8_t *serialized_message = resumptionM1.serialize();
+    int result = m_socket->send(serialized_message, ResumptionM1::getMessageSize());
+    delete[] serialized_message;
+    if (result != 0) {
+        OPENSSL_cleanse(&ticket, sizeof(ticket));
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+
+    // ResumptionM2
+    serialized_message = new uint8_t[ResumptionM2::getMessageSize()];
+    result = m_socket->receive(serialized_message, ResumptionM2::getMessageSize());
+    if (result != 0) {
+        delete[] serialized_message;
+        OPENSSL_cleanse(&ticket, sizeof(ticket));
+        return static_cast<int>(Return::RECEIVE_FAILURE);
+    }
+    ResumptionM2 resumptionM2 = ResumptionM2::deserialize(serialized_message);
+    delete[] serialized_message;
+    if (static_cast<Result>(resumptionM2.getMMessageCode()) != Result::ACK) {
+        OPENSSL_cleanse(&ticket, sizeof(ticket));
+        forgetSessionTicket(m_username);
+        cerr << "ResumptionM2 - " << "Session ticket rejected!" << endl;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+
+    // Derive the session key and restore the session
+    SessionTicket::deriveSessionKey(ticket.resumption_secret, client_nonce, resumptionM2.getMServerNonce(),
+                                    m_session_key);
+    delete m_cipher;
+    m_cipher_suite = ticket.cipher_suite;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::CLIENT, m_cipher_suite);
+    m_chunk_size = ticket.chunk_size;
+    m_counter = 0;
+    OPENSSL_cleanse(&ticket, sizeof(ticket));
+    return static_cast<int>(Return::AUTHENTICATION_SUCCESS);
+}
+
+/**
+ * @brief Receive the session ticket sent by the server at the end of the full handshake in an AuthenticationM6
+ * message and store it for the next sessions of the user.
+ * @return An integer code indicating the result of the operation.
+ */
+int Client::receiveSessionTicket() {
+    uint8_t *plaintext = nullptr;
+    int result = receiveMessage(plaintext, AuthenticationM6::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    AuthenticationM6 authenticationM6 = AuthenticationM6::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, AuthenticationM6::getMessageSize());
+    delete[] plaintext;
+
+    CachedTicket ticket{};
+    memcpy(ticket.sealed_ticket, authenticationM6.getMSealedTicket(), SEALED_TICKET_LEN);
+    memcpy(ticket.resumption_secret, authenticationM6.getMResumptionSecret(), RESUMPTION_SECRET_LEN);
+    ticket.chunk_size = m_chunk_size;
+    ticket.cipher_suite = m_cipher_suite;
+    // Measured on the local clock, so the ticket is not used when the server is about to reject it
+    ticket.expiration_time = chrono::steady_clock::now() + chrono::seconds(authenticationM6.getMTicketLifetime());
+
+    lock_guard<mutex> lock(m_tickets_mutex);
+    m_tickets[m_username] = ticket;
+    OPENSSL_cleanse(&ticket, sizeof(ticket));
+    return static_cast<int>(Return::SUCCESS);
+}
+
+/**
+ * @brief Remove the session ticket of a user, so that its next session performs the full handshake.
+ * @param username The username of the user.
+ */
+void Client::forgetSessionTicket(const string &username) {
+    lock_guard<mutex> lock(m_tickets_mutex);
+    auto entry = m_tickets.find(username);
+    if (entry != m_tickets.end()) {
+        OPENSSL_cleanse(&entry->second, sizeof(CachedTicket));
+        m_tickets.erase(entry);
+    }
+}
+
 /**
  * @brief Initiates a request to list files in the user's storage and displays the received file list.
  *
@@ -343,7 +572,7 @@ int Client::listRequest() {
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
-    if (generic_msg1.encrypt(m_session_key, serialized_message,
+    if (generic_msg1.encrypt(*m_cipher, serialized_message,
                              static_cast<int>(simple_msg_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -376,7 +605,7 @@ int Client::listRequest() {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[list_msg2_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
     ListM2 list_msg2 = ListM2::deserialize(plaintext);
@@ -421,7 +650,7 @@ int Client::listRequest() {
     // Allocate memory for the plaintext buffer
     plaintext = new uint8_t[list_msg3_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg3.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg3.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
     ListM3 list_msg3 = ListM3::deserialize(plaintext, list_size);
@@ -459,12 +688,16 @@ int Client::listRequest() {
  * This function performs the following steps:
  * 1. Checks if the file to download is already present in the user local folder:
  *    a. If the file is found, returns FILE_ALREADY_EXISTS.
- *    b. If the file is not found, sends a DownloadM1 message to the server.
+ *    b. If a previous download of the file has been interrupted, resumes it with a range request from the
+ *      size of the partial file, which holds only authenticated chunks.
+ *    c. Otherwise, sends a DownloadM1 message to the server.
  * 2. Receives the server's response message (DownloadM2).
  * 3. Checks if the requested file exists on the server:
  *    a. If the file is not found, returns FILE_NOT_FOUND.
  *    b. If the file is found, proceeds to receive and save file chunks in
  *      sequential order (DownloadM3+i).
+ * The chunks are written in a temporary file, which gets the name of the file when complete and is kept if the
+ * download is interrupted.
  *
  * @param filename The name of the file to be downloaded.
  * @return An integer code indicating the result of the client's download request.
@@ -477,6 +710,12 @@ int Client::downloadRequest(const string& filename) {
     if (FileManager::isFilePresent(file_path)) {
         return static_cast<int>(Return::FILE_ALREADY_EXISTS);
     }
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    if (FileManager::isFilePresent(temporary_path) && FileManager::computeFileSize(temporary_path) > 0) {
+        return resumeDownload(filename, file_path);
+    }
+    error_code error;
+    filesystem::remove(temporary_path, error);
     size_t download_msg1_len = DownloadM1::getMessageSize();
     DownloadM1 download_msg1(filename);
     // Serialize the ListM2 message to obtain a byte buffer
@@ -484,7 +723,7 @@ int Client::downloadRequest(const string& filename) {
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
-    if (generic_msg1.encrypt(m_session_key, serialized_message,
+    if (generic_msg1.encrypt(*m_cipher, serialized_message,
                              Config::MAX_PACKET_SIZE) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -517,7 +756,7 @@ int Client::downloadRequest(const string& filename) {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[download_msg2_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
     // Get message content
@@ -542,65 +781,159 @@ int Client::downloadRequest(const string& filename) {
 
     // Receive message DownloadM3+i
 
-    // Open a file in write mode and init its information
-    FileManager downloaded_file(file_path, FileManager::OpenMode::WRITE);
-    streamsize downloaded_file_size = download_msg2.getFileSize();
-    downloaded_file.initFileInfo(downloaded_file_size);
+    // Open the temporary file in write mode and init its information
+    FileManager downloaded_file(temporary_path, FileManager::OpenMode::WRITE);
+    // Without the version the temporary file is downloaded again from the beginning if the download is interrupted
+    FileManager::setPartialVersion(temporary_path, download_msg2.getVersion());
+    downloaded_file.initFileInfo(download_msg2.getFileSize(), m_chunk_size);
+    int result = receiveFileChunks(downloaded_file, true);
+    downloaded_file.closeFile();
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    return FileManager::commitFile(temporary_path, file_path) == 0 ?
+           static_cast<int>(Return::SUCCESS) : static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+}
 
-    streamsize chunk_size = Config::CHUNK_SIZE;
+/**
+ * @brief Resume an interrupted download: the chunks after the ones already in the temporary file are
+ * downloaded with a range request, then the file gets its name. The chunks already downloaded are kept only if
+ * the version of the file on the server is the one recorded in the temporary file.
+ * @param filename The name of the file to be downloaded.
+ * @param file_path The path of the local file.
+ * @return An integer code indicating the result of the download.
+ */
+int Client::resumeDownload(const string &filename, const string &file_path) {
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    auto offset = static_cast<uint32_t>(FileManager::computeFileSize(temporary_path));
+
+    // Retrieve the file size and version with an empty range
+    uint32_t file_size = 0;
+    uint64_t version = 0;
+    int result = downloadRangeRequest(filename, temporary_path, 0, 0, file_size, &version);
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    // The download restarts from the beginning if the file has changed on the server since it was interrupted,
+    // or if the temporary file has no version (a parallel download, whose ranges are not a prefix of the file)
+    uint64_t partial_version = 0;
+    if (offset > file_size || FileManager::getPartialVersion(temporary_path, partial_version) == -1 ||
+        partial_version != version) {
+        cout << "Client - The partial download does not match the file, downloading it from the beginning" << endl;
+        error_code error;
+        filesystem::resize_file(temporary_path, 0, error);
+        if (error) {
+            return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+        }
+        FileManager::setPartialVersion(temporary_path, version);
+        offset = 0;
+    }
+
+    // Download the rest of the file
+    if (offset < file_size) {
+        if (offset > 0) {
+            cout << "Client - Resuming the download from byte " << offset << endl;
+        }
+        result = downloadRangeRequest(filename, temporary_path, offset, file_size - offset, file_size);
+        if (result != static_cast<int>(Return::SUCCESS)) {
+            return result;
+        }
+    }
+    cout << "Client - Downloading: 100% complete" << endl;
+    return FileManager::commitFile(temporary_path, file_path) == 0 ?
+           static_cast<int>(Return::SUCCESS) : static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+}
+
+
+/**
+ * @brief Receive the chunks of a file (DownloadM3+i messages) and write them from the current file position.
+ *
+ * @param downloaded_file The file to write, with the file info initialized to the size of the data to receive.
+ * @param show_progress true to print the progress of the transfer.
+ * @return An integer code indicating the result of the transfer.
+ */
+int Client::receiveFileChunks(FileManager &downloaded_file, bool show_progress) {
+    streamsize downloaded_file_size = downloaded_file.getFileSize();
+    streamsize chunk_size = downloaded_file.getChunkSize();
     streamsize bytes_received = 0;
 
     // Set an interval for progress updates (e.g., every 10%)
     const int progressUpdateInterval = 1;
     int lastPrintedProgress = -1;
 
+    // Buffers receiving the Generic messages of a batch, allocated once and decrypted in place
+    size_t max_message_len = Generic::getMessageSize(DownloadMi::getMessageSize(chunk_size));
+    vector<uint8_t *> received_messages;
+    for (size_t j = 0; j < Config::CHUNKS_BATCH_LEN; j++) {
+        received_messages.push_back(new uint8_t[max_message_len]);
+    }
+    auto release_received_messages = [&received_messages, max_message_len] {
+        for (uint8_t *received_message : received_messages) {
+            OPENSSL_cleanse(received_message, max_message_len);
+            delete[] received_message;
+        }
+        received_messages.clear();
+    };
+
     // Receive each chunk of the file from the Server
     for (size_t i = 0; i < downloaded_file.getChunksNum(); i++) {
+        // Receive the messages DownloadMi of the next batch from the Server
+        if (i % Config::CHUNKS_BATCH_LEN == 0) {
+            size_t batch_end = min(i + Config::CHUNKS_BATCH_LEN, static_cast<size_t>(downloaded_file.getChunksNum()));
+            for (size_t j = i; j < batch_end; j++) {
+                streamsize batch_chunk_size = (j == static_cast<size_t>(downloaded_file.getChunksNum()) - 1) ?
+                                              downloaded_file.getLastChunkSize() : downloaded_file.getChunkSize();
+                size_t generic_msg3j_len = Generic::getMessageSize(DownloadMi::getMessageSize(batch_chunk_size));
+                // Queue the receive of the Generic message in the buffer of its batch slot
+                if (m_socket->queueReceive(received_messages[j % Config::CHUNKS_BATCH_LEN], generic_msg3j_len) != 0) {
+                    release_received_messages();
+                    return static_cast<int>(Return::RECEIVE_FAILURE);
+                }
+            }
+            // Receive the Generic messages of the batch from the server
+            if (m_socket->flush() != 0) {
+                release_received_messages();
+                return static_cast<int>(Return::RECEIVE_FAILURE);
+            }
+        }
+
         // If the chunk is the last, set the appropriate size
         if (i == downloaded_file.getChunksNum() - 1) {
             chunk_size = downloaded_file.getLastChunkSize();
         }
-        // Receive the message DownloadMi from the Server
 
         // Determine the size of the message
         size_t download_msg3i_len = DownloadMi::getMessageSize(chunk_size);
-        size_t generic_msg3i_len = Generic::getMessageSize(download_msg3i_len);
-        // Allocate memory for the buffer to receive the Generic message
-        serialized_message = new uint8_t[generic_msg3i_len];
-        // Receive the Generic message from the server
-        if (m_socket->receive(serialized_message, generic_msg3i_len) == -1) {
-            delete[] serialized_message;
-            return static_cast<int>(Return::RECEIVE_FAILURE);
-        }
-        // Deserialize the received Generic message
-        Generic generic_msg3i = Generic::deserialize(serialized_message, download_msg3i_len);
-        delete[] serialized_message;
-        // Allocate memory for the plaintext buffer
-        plaintext = new uint8_t[download_msg3i_len];
-        // Decrypt the Generic message to obtain the serialized message
-        if (generic_msg3i.decrypt(m_session_key, plaintext) == -1) {
+        // Decrypt the received Generic message in its buffer: the serialized DownloadMi follows the header
+        uint8_t *generic_msg3i = received_messages[i % Config::CHUNKS_BATCH_LEN];
+        uint32_t counter;
+        if (Generic::openInPlace(*m_cipher, generic_msg3i, download_msg3i_len, counter) == -1) {
+            release_received_messages();
             return static_cast<int>(Return::DECRYPTION_FAILURE);
         }
-        DownloadMi download_msg3i = DownloadMi::deserialize(plaintext, chunk_size);
-        // Safely clean plaintext buffer
-        OPENSSL_cleanse(plaintext, download_msg3i_len);
-        delete[] plaintext;
+        uint8_t *download_msg3i = generic_msg3i + Generic::HEADER_LEN;
         // Check the counter value to prevent replay attacks
-        if (m_counter != generic_msg3i.getCounter()) {
+        if (m_counter != counter) {
+            release_received_messages();
             return static_cast<int>(Return::WRONG_COUNTER);
         }
 
         incrementCounter();
 
-        // Check the received message code
-        if (download_msg3i.getMessageCode() != static_cast<uint8_t>(Message::DOWNLOAD_CHUNK)) {
+        // Check the received message code (first byte of the DownloadMi message)
+        if (download_msg3i[0] != static_cast<uint8_t>(Message::DOWNLOAD_CHUNK)) {
+            release_received_messages();
             return static_cast<int>(Return::WRONG_MSG_CODE);
         }
-        // Write the current chunk in the file
-        if (downloaded_file.writeChunk(download_msg3i.getFileChunk(), chunk_size) == -1) {
+        // Write the current chunk (following the message code) in the file
+        if (downloaded_file.writeChunk(download_msg3i + sizeof(uint8_t), chunk_size) == -1) {
+            release_received_messages();
             return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
         }
         // Compute and show the progress to the user
+        if (!show_progress) {
+            continue;
+        }
         // Calculate download progress percentage
         bytes_received += chunk_size;
         int newProgress = static_cast<int>((static_cast<double>(bytes_received) / static_cast<double>(downloaded_file_size)) * 100);
@@ -611,8 +944,11 @@ int Client::downloadRequest(const string& filename) {
             lastPrintedProgress = newProgress;
         }
     }
+    release_received_messages();
     // Clear the progress message after completion
-    cout << "\rClient - Downloading: 100% complete" << endl;
+    if (show_progress) {
+        cout << "\rClient - Downloading: 100% complete" << endl;
+    }
 
     // Return success code if the end of the function is reached
     return static_cast<int>(Return::SUCCESS);
@@ -624,8 +960,9 @@ int Client::downloadRequest(const string& filename) {
 /**
  * Client side upload request operation
  * 1) Send an upload message request to the server specifying file name and file size(UploadM1 message type)
- * 2) Waits a response from the server indicating the success or failure of the upload request (SimpleMessage)
- * 3) Divides the file into chunks and sends each chunk to the server as an M3+i message (UploadMi Message)
+ * 2) Waits a response from the server indicating the success or failure of the upload request and the offset of
+ * the bytes already received in an interrupted upload of the file (UploadM2)
+ * 3) Divides the file from the offset into chunks and sends each chunk to the server as an M3+i message (UploadMi)
  * 4) Waits for the final response from the server after sending all file chunks, indicating the overall success or
  * failure of the file upload (SimpleMessage)
  *
@@ -647,16 +984,21 @@ int Client::uploadRequest(string filename) {
         cout << "Client - Cannot Upload the File! File Empty or larger than 4GB" << endl;
         return static_cast<int>(Return::WRONG_FILE_SIZE);
     }
+    // Split the file in chunks of the size negotiated for the session
+    file_to_upload.initFileInfo(file_to_upload.getFileSize(), m_chunk_size);
 
 
     // 1) Create the M1 message (Upload request specifying the file name and file size) and increment counter
-    UploadM1 upload_msg1(filename, file_to_upload.getFileSize());
+    // The version of the file lets the server resume an interrupted upload only if the file has not changed
+    uint64_t version = 0;
+    FileManager::getVersion(file_path, version);
+    UploadM1 upload_msg1(filename, file_to_upload.getFileSize(), version);
     uint8_t* serialized_message = upload_msg1.serializeUploadM1();
 
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg1.encrypt(m_session_key, serialized_message,Config::MAX_PACKET_SIZE) == -1) {
+    if (generic_msg1.encrypt(*m_cipher, serialized_message,Config::MAX_PACKET_SIZE) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (UploadM1 message)
@@ -672,9 +1014,10 @@ int Client::uploadRequest(string filename) {
     incrementCounter();
 
 
-    // 2) Receive the result message M2 message (success or failed request. Simple Message) and increment counter
+    // 2) Receive the result message M2 message (success or failed request and resume offset. UploadM2 Message)
+    // and increment counter
     // Determine the size of the message to receive
-    size_t upload_msg2_len = SimpleMessage::getMessageSize();
+    size_t upload_msg2_len = UploadM2::getSizeUploadM2();
     size_t generic_msg2_len = Generic::getMessageSize(upload_msg2_len);
 
     // Allocate memory for the buffer to receive the Generic message
@@ -690,12 +1033,12 @@ int Client::uploadRequest(string filename) {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[upload_msg2_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
-    // Deserialize the upload message 2 received (Simple Message)
-    SimpleMessage upload_msg2 = SimpleMessage::deserialize(plaintext);
+    // Deserialize the upload message 2 received (UploadM2 Message)
+    UploadM2 upload_msg2 = UploadM2::deserializeUploadM2(plaintext);
     // Safely clean plaintext buffer
     OPENSSL_cleanse(plaintext, upload_msg2_len);
     delete[] plaintext;
@@ -709,22 +1052,105 @@ int Client::uploadRequest(string filename) {
     incrementCounter();
 
     // Check if the file already exist
-    if (upload_msg2.getMMessageCode() == static_cast<uint8_t>(Result::NACK)) {
+    if (upload_msg2.getMessageCode() == static_cast<uint8_t>(Result::NACK)) {
         return static_cast<int>(Return::FILE_ALREADY_EXISTS);
     }
 
     // Check the received message code
-    if (upload_msg2.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
+    if (upload_msg2.getMessageCode() != static_cast<uint8_t>(Result::ACK)) {
         return static_cast<int>(Return::WRONG_MSG_CODE);
     }
 
+    // Skip the bytes already received by the server in an interrupted upload of the file
+    uint32_t offset = upload_msg2.getOffset();
+    if (offset > file_to_upload.getFileSize()) {
+        return static_cast<int>(Return::WRONG_FILE_SIZE);
+    }
+    if (offset > 0) {
+        cout << "Client - Resuming the upload from byte " << offset << endl;
+        if (file_to_upload.seek(offset) == -1) {
+            return static_cast<int>(Return::READ_CHUNK_FAILURE);
+        }
+        file_to_upload.initFileInfo(file_to_upload.getFileSize() - offset, m_chunk_size);
+    }
+
+
+    // 3) Create and send the M3+i messages (file chunk)
+    if (sendFileChunks(file_to_upload, true) == -1) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
 
-    // 3) Create the M3+i messages (file chunk)
-    // Determine the chunk size based on the file size and the number of chunks
-    size_t chunk_size = Config::CHUNK_SIZE;
 
-    // Allocate a buffer to store each file chunk
-    uint8_t *chunk_buffer = new uint8_t [chunk_size];
+    // 4) Receive the final packet M3+i+1 message (success or failed file upload. Simple Message)
+    // Determine the size of the message to receive
+    size_t upload_msg3i1_len = SimpleMessage::getMessageSize();
+    size_t generic_msg3i1_len = Generic::getMessageSize(upload_msg3i1_len);
+
+    // Allocate memory for the buffer to receive the Generic message
+    serialized_message = new uint8_t[generic_msg3i1_len];
+    if (m_socket->receive(serialized_message, generic_msg3i1_len) == -1) {
+        delete[] serialized_message;
+        return static_cast<int>(Return::RECEIVE_FAILURE);
+    }
+
+    // Deserialize the received Generic message
+    Generic generic_msg3i1 = Generic::deserialize(serialized_message, upload_msg3i1_len);
+    delete[] serialized_message;
+    // Allocate memory for the plaintext buffer
+    plaintext = new uint8_t[upload_msg3i1_len];
+    // Decrypt the Generic message to obtain the serialized message
+    if (generic_msg3i1.decrypt(*m_cipher, plaintext) == -1) {
+        return static_cast<int>(Return::DECRYPTION_FAILURE);
+    }
+
+    // Deserialize the upload message 2 received (Simple Message)
+    SimpleMessage upload_msg3i1 = SimpleMessage::deserialize(plaintext);
+    // Safely clean plaintext buffer
+    OPENSSL_cleanse(plaintext, upload_msg3i1_len);
+    delete[] plaintext;
+
+    // Check the counter value to prevent replay attacks
+    if (m_counter != generic_msg3i1.getCounter()) {
+        return static_cast<int>(Return::WRONG_COUNTER);
+    }
+
+    // Increment counter against replay attack
+    incrementCounter();
+
+    // Check the received message code
+    if (upload_msg3i1.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
+        return static_cast<int>(Return::WRONG_MSG_CODE);
+    }
+
+    // Successful upload
+    return static_cast<int>(Return::SUCCESS);
+}
+
+/**
+ * @brief Read a file from its current position and send its chunks (UploadM3+i messages).
+ *
+ * @param file_to_upload The file to send, with the file info initialized to the size of the data to send.
+ * @param show_progress true to print the progress of the transfer.
+ * @return 0 on success, -1 on failure.
+ */
+int Client::sendFileChunks(FileManager &file_to_upload, bool show_progress) {
+    // Determine the chunk size based on the file size and the number of chunks
+    size_t chunk_size = file_to_upload.getChunkSize();
+
+    // Buffers of the Generic messages of a batch, allocated once: each chunk is read after the header and the
+    // message code of its message and encrypted in place
+    size_t max_message_len = Generic::getMessageSize(UploadMi::getSizeUploadMi(static_cast<int>(chunk_size)));
+    vector<uint8_t *> message_buffers;
+    for (size_t j = 0; j < Config::CHUNKS_BATCH_LEN; j++) {
+        message_buffers.push_back(new uint8_t[max_message_len]);
+    }
+    auto release_message_buffers = [&message_buffers, max_message_len] {
+        for (uint8_t *message_buffer : message_buffers) {
+            OPENSSL_cleanse(message_buffer, max_message_len);
+            delete[] message_buffer;
+        }
+        message_buffers.clear();
+    };
 
     // Set an interval for progress updates (e.g., every 10%)
     size_t file_size = file_to_upload.getFileSize();
@@ -738,36 +1164,40 @@ int Client::uploadRequest(string filename) {
         if (i == file_to_upload.getChunksNum() - 1)
             chunk_size = file_to_upload.getLastChunkSize();
 
-        // Read the next chunk from the file
-        file_to_upload.readChunk(chunk_buffer,chunk_size);
-
-        // Create the M3+i packet (UploadMi)
-        UploadMi upload_msg3i(chunk_buffer, chunk_size);
-        serialized_message = upload_msg3i.serializeUploadMi();
+        // Create the M3+i packet (UploadMi) in the buffer of its batch slot: message code and chunk
+        uint8_t *generic_msg3i = message_buffers[i % Config::CHUNKS_BATCH_LEN];
+        uint8_t *upload_msg3i = generic_msg3i + Generic::HEADER_LEN;
+        upload_msg3i[0] = static_cast<uint8_t>(Message::UPLOAD_CHUNK);
+        file_to_upload.readChunk(upload_msg3i + sizeof(uint8_t), static_cast<streamsize>(chunk_size));
 
         // Determine the size of the plaintext and ciphertext
-        size_t upload_msg3i_len = UploadMi::getSizeUploadMi(chunk_size);
+        size_t upload_msg3i_len = UploadMi::getSizeUploadMi(static_cast<int>(chunk_size));
 
-        Generic generic_msg3i(m_counter);
-        // Encrypt the serialized plaintext and init the GenericMessage fields
-        if (generic_msg3i.encrypt(m_session_key, serialized_message,static_cast<int>(upload_msg3i_len)) == -1) {
-            return static_cast<int>(Return::ENCRYPTION_FAILURE);
+        // Encrypt the UploadMi in place with the current counter value
+        if (Generic::sealInPlace(*m_cipher, m_counter, generic_msg3i, upload_msg3i_len) == -1) {
+            release_message_buffers();
+            return -1;
         }
-        // Serialize Generic message
-        serialized_message = generic_msg3i.serialize();
-        // Send the serialized Generic message to the server
-        if (m_socket->send(serialized_message,Generic::getMessageSize(upload_msg3i_len)) == -1) {
-            return static_cast<int>(Return::SEND_FAILURE);
+        // Queue the Generic message, the batch is sent when full or at the last chunk
+        bool batch_over = (i + 1) % Config::CHUNKS_BATCH_LEN == 0 || i == static_cast<size_t>(file_to_upload.getChunksNum()) - 1;
+        int result = m_socket->queueSend(generic_msg3i, Generic::getMessageSize(upload_msg3i_len));
+        if (result == 0 && batch_over) {
+            result = m_socket->flush();
+        }
+        if (result != 0) {
+            release_message_buffers();
+            return -1;
         }
-        // Clean up memory used for serialization
-        delete[] serialized_message;
 
         // Increment counter against replay attack
         incrementCounter();
 
         // Compute and show the progress to the user
+        if (!show_progress) {
+            continue;
+        }
         // Calculate upload progress percentage
-        bytes_sent += chunk_size;
+        bytes_sent += static_cast<streamsize>(chunk_size);
         int newProgress = static_cast<int>((static_cast<double>(bytes_sent) / static_cast<double>(file_size)) * 100);
 
         // Print progress only if it has changed or reached the specified interval
@@ -777,57 +1207,382 @@ int Client::uploadRequest(string filename) {
         }
     }
     // Clear the progress message after completion
-    cout << "\rClient - Uploading: 100% complete" << endl;
+    if (show_progress) {
+        cout << "\rClient - Uploading: 100% complete" << endl;
+    }
 
-    // Safely clean chunk buffer
-    OPENSSL_cleanse(chunk_buffer, chunk_size);
-    delete[] chunk_buffer;
+    // Safely clean the message buffers
+    release_message_buffers();
 
+    return 0;
+}
 
-    // 4) Receive the final packet M3+i+1 message (success or failed file upload. Simple Message)
-    // Determine the size of the message to receive
-    size_t upload_msg3i1_len = SimpleMessage::getMessageSize();
-    size_t generic_msg3i1_len = Generic::getMessageSize(upload_msg3i1_len);
+//-------------------------------------RANGE REQUESTS-------------------------------------//
 
-    // Allocate memory for the buffer to receive the Generic message
-    serialized_message = new uint8_t[generic_msg3i1_len];
-    if (m_socket->receive(serialized_message, generic_msg3i1_len) == -1) {
-        delete[] serialized_message;
-        return static_cast<int>(Return::RECEIVE_FAILURE);
+/**
+ * @brief Split a file in ranges of whole chunks, one for each session of a parallel transfer.
+ * @param file_size The size of the file.
+ * @param connections_num The max number of sessions.
+ * @param chunk_size The chunk size negotiated for the session.
+ * @return The (offset, length) pairs of the ranges.
+ */
+static vector<pair<uint32_t, uint32_t>> splitRanges(uint32_t file_size, unsigned int connections_num,
+                                                    uint32_t chunk_size) {
+    size_t chunks_num = (file_size + chunk_size - 1) / chunk_size;
+    size_t range_chunks = max((chunks_num + connections_num - 1) / connections_num, Config::RANGE_MIN_CHUNKS);
+
+    vector<pair<uint32_t, uint32_t>> ranges;
+    for (uint64_t offset = 0; offset < file_size; offset += range_chunks * chunk_size) {
+        uint64_t length = min(static_cast<uint64_t>(range_chunks * chunk_size), file_size - offset);
+        ranges.emplace_back(offset, length);
     }
+    return ranges;
+}
 
-    // Deserialize the received Generic message
-    Generic generic_msg3i1 = Generic::deserialize(serialized_message, upload_msg3i1_len);
-    delete[] serialized_message;
-    // Allocate memory for the plaintext buffer
-    plaintext = new uint8_t[upload_msg3i1_len];
-    // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg3i1.decrypt(m_session_key, plaintext) == -1) {
-        return static_cast<int>(Return::DECRYPTION_FAILURE);
+/**
+ * @brief Download a byte range of a file into a local file already allocated with the whole file size.
+ *
+ * 1. Sends a DownloadRangeM1 message with the file name and the range.
+ * 2. Receives the server's response message (DownloadM2) with the size of the whole file.
+ * 3. Receives the chunks of the range (DownloadM3+i) and writes them at the range offset.
+ *
+ * A range with length 0 only retrieves the file size and version.
+ *
+ * @param filename The name of the file on the server.
+ * @param file_path The path of the local file.
+ * @param offset The offset of the range.
+ * @param length The length of the range.
+ * @param file_size Set to the size of the whole file.
+ * @param version If not null, set to the version of the file.
+ * @return An integer code indicating the result of the request.
+ */
+int Client::downloadRangeRequest(const string &filename, const string &file_path, uint32_t offset,
+                                 uint32_t length, uint32_t &file_size, uint64_t *version) {
+    // Send message DownloadRangeM1
+    DownloadRangeM1 download_msg1(filename, offset, length);
+    int result = sendMessage(download_msg1.serialize(), Config::MAX_PACKET_SIZE);
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
     }
 
-    // Deserialize the upload message 2 received (Simple Message)
-    SimpleMessage upload_msg3i1 = SimpleMessage::deserialize(plaintext);
-    // Safely clean plaintext buffer
-    OPENSSL_cleanse(plaintext, upload_msg3i1_len);
+    // Receive message DownloadM2
+    uint8_t *plaintext;
+    result = receiveMessage(plaintext, DownloadM2::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    DownloadM2 download_msg2 = DownloadM2::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, DownloadM2::getMessageSize());
     delete[] plaintext;
+    if (download_msg2.getMessageCode() == static_cast<uint8_t>(Error::FILE_NOT_FOUND)) {
+        return static_cast<int>(Return::FILE_NOT_FOUND);
+    }
+    if (download_msg2.getMessageCode() != static_cast<uint8_t>(Message::DOWNLOAD_ACK)) {
+        return static_cast<int>(Return::WRONG_MSG_CODE);
+    }
+    file_size = download_msg2.getFileSize();
+    if (version != nullptr) {
+        *version = download_msg2.getVersion();
+    }
+    if (length == 0) {
+        return static_cast<int>(Return::SUCCESS);
+    }
 
-    // Check the counter value to prevent replay attacks
-    if (m_counter != generic_msg3i1.getCounter()) {
-        return static_cast<int>(Return::WRONG_COUNTER);
+    // Receive messages DownloadM3+i of the range
+    FileManager downloaded_file(file_path, FileManager::OpenMode::UPDATE);
+    if (downloaded_file.seek(offset) == -1) {
+        return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
     }
+    downloaded_file.initFileInfo(length, m_chunk_size);
+    return receiveFileChunks(downloaded_file, false);
+}
 
-    // Increment counter against replay attack
-    incrementCounter();
+/**
+ * @brief Upload a byte range of a local file.
+ *
+ * 1. Sends an UploadRangeM1 message with the file name, the file size and the range.
+ * 2. Receives the server's response (SimpleMessage): NACK if the range cannot be written.
+ * 3. Reads the range and sends its chunks (UploadM3+i).
+ * 4. Receives the final response after the range has been written (SimpleMessage).
+ *
+ * @param filename The name of the file on the server.
+ * @param file_path The path of the local file.
+ * @param file_size The size of the whole file.
+ * @param offset The offset of the range.
+ * @param length The length of the range.
+ * @return An integer code indicating the result of the request.
+ */
+int Client::uploadRangeRequest(const string &filename, const string &file_path, uint32_t file_size,
+                               uint32_t offset, uint32_t length) {
+    // 1) Send the upload range request (UploadRangeM1)
+    string name = filename;
+    UploadRangeM1 upload_msg1(name, file_size, offset, length);
+    int result = sendMessage(upload_msg1.serializeUploadRangeM1(), Config::MAX_PACKET_SIZE);
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+
+    // 2) Receive the result of the request (SimpleMessage)
+    uint8_t *plaintext;
+    result = receiveMessage(plaintext, SimpleMessage::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    SimpleMessage upload_msg2 = SimpleMessage::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, SimpleMessage::getMessageSize());
+    delete[] plaintext;
+    if (upload_msg2.getMMessageCode() == static_cast<uint8_t>(Result::NACK)) {
+        return static_cast<int>(Return::FILE_ALREADY_EXISTS);
+    }
+    if (upload_msg2.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
+        return static_cast<int>(Return::WRONG_MSG_CODE);
+    }
 
-    // Check the received message code
+    // 3) Send the chunks of the range (UploadM3+i)
+    FileManager file_to_upload(file_path, FileManager::OpenMode::READ);
+    if (file_to_upload.seek(offset) == -1) {
+        return static_cast<int>(Return::READ_CHUNK_FAILURE);
+    }
+    file_to_upload.initFileInfo(length, m_chunk_size);
+    if (sendFileChunks(file_to_upload, false) == -1) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+
+    // 4) Receive the final result (SimpleMessage)
+    result = receiveMessage(plaintext, SimpleMessage::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    SimpleMessage upload_msg3i1 = SimpleMessage::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, SimpleMessage::getMessageSize());
+    delete[] plaintext;
     if (upload_msg3i1.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
         return static_cast<int>(Return::WRONG_MSG_CODE);
     }
+    return static_cast<int>(Return::SUCCESS);
+}
 
-    // Successful upload
+/**
+ * @brief Download a file splitting it in ranges, each one transferred on its own session.
+ * @details The first range is transferred on this session, the others on helper sessions opened and
+ * authenticated for the transfer. The ranges are written in the temporary file of the download, allocated with
+ * the final size before the transfer: it gets the name of the file when complete and is removed if any range fails.
+ * @param filename The name of the file to be downloaded.
+ * @return An integer code indicating the result of the download.
+ */
+int Client::parallelDownload(const string &filename) {
+    string file_path = "../files/" + filename;
+    if (FileManager::isFilePresent(file_path)) {
+        return static_cast<int>(Return::FILE_ALREADY_EXISTS);
+    }
+    // An interrupted download is resumed on this session
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    if (FileManager::isFilePresent(temporary_path) && FileManager::computeFileSize(temporary_path) > 0) {
+        return resumeDownload(filename, file_path);
+    }
+
+    // Retrieve the file size with an empty range
+    uint32_t file_size = 0;
+    int result = downloadRangeRequest(filename, temporary_path, 0, 0, file_size);
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    // The ranges are written in the temporary file, which gets the name of the file when complete. It gets no
+    // version, so that it is never resumed: its ranges are not a prefix of the file
+    error_code error;
+    filesystem::remove(temporary_path, error);
+    if (FileManager::allocateFile(temporary_path, file_size) == -1) {
+        return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+    }
+
+    // Transfer the ranges after the first one on the helper sessions
+    vector<pair<uint32_t, uint32_t>> ranges = splitRanges(file_size, m_connections_num, m_chunk_size);
+    vector<int> results(ranges.size(), static_cast<int>(Return::SUCCESS));
+    vector<thread> helpers;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        helpers.emplace_back([this, &filename, &temporary_path, &ranges, &results, i] {
+            try {
+                Client helper(m_username, m_long_term_private_key);
+                results[i] = helper.connect();
+                if (results[i] != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
+                    return;
+                }
+                uint32_t range_file_size;
+                results[i] = helper.downloadRangeRequest(filename, temporary_path, ranges[i].first,
+                                                         ranges[i].second, range_file_size);
+                helper.logoutRequest();
+            } catch (int error) {
+                results[i] = error;
+            }
+        });
+    }
+
+    cout << "Client - Downloading in " << ranges.size() << " ranges..." << endl;
+    uint32_t range_file_size;
+    results[0] = downloadRangeRequest(filename, temporary_path, ranges[0].first, ranges[0].second,
+                                      range_file_size);
+    for (thread &helper : helpers) {
+        helper.join();
+    }
+
+    for (int range_result : results) {
+        if (range_result != static_cast<int>(Return::SUCCESS)) {
+            // The ranges received are not a prefix of the file, so the download cannot be resumed from them
+            filesystem::remove(temporary_path, error);
+            return range_result;
+        }
+    }
+    cout << "Client - Downloading: 100% complete" << endl;
+    return FileManager::commitFile(temporary_path, file_path) == 0 ?
+           static_cast<int>(Return::SUCCESS) : static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+}
+
+/**
+ * @brief Upload a file splitting it in ranges, each one transferred on its own session.
+ * @details The first range is transferred on this session, the others on helper sessions opened and
+ * authenticated for the transfer. The server removes the file if any range fails.
+ * @param filename The name of the file to be uploaded.
+ * @return An integer code indicating the result of the upload.
+ */
+int Client::parallelUpload(const string &filename) {
+    string file_path = "../files/" + filename;
+    if (!FileManager::isFilePresent(file_path)) {
+        return static_cast<int>(Return::FILE_NOT_FOUND);
+    }
+    streamsize file_size = FileManager::computeFileSize(file_path);
+    if (file_size == 0 || file_size > static_cast<streamsize>(Config::MAX_FILE_SIZE)) {
+        cout << "Client - Cannot Upload the File! File Empty or larger than 4GB" << endl;
+        return static_cast<int>(Return::WRONG_FILE_SIZE);
+    }
+
+    // The first range creates the file on the server, so it is requested before starting the helpers
+    vector<pair<uint32_t, uint32_t>> ranges = splitRanges(file_size, m_connections_num, m_chunk_size);
+    vector<int> results(ranges.size(), static_cast<int>(Return::SUCCESS));
+    vector<thread> helpers;
+
+    // 1) Send the first range request (UploadRangeM1)
+    string name = filename;
+    UploadRangeM1 upload_msg1(name, file_size, ranges[0].first, ranges[0].second);
+    int result = sendMessage(upload_msg1.serializeUploadRangeM1(), Config::MAX_PACKET_SIZE);
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    uint8_t *plaintext;
+    result = receiveMessage(plaintext, SimpleMessage::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    SimpleMessage upload_msg2 = SimpleMessage::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, SimpleMessage::getMessageSize());
+    delete[] plaintext;
+    if (upload_msg2.getMMessageCode() == static_cast<uint8_t>(Result::NACK)) {
+        return static_cast<int>(Return::FILE_ALREADY_EXISTS);
+    }
+    if (upload_msg2.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
+        return static_cast<int>(Return::WRONG_MSG_CODE);
+    }
+
+    // 2) Transfer the ranges after the first one on the helper sessions
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        helpers.emplace_back([this, &filename, &file_path, &ranges, &results, file_size, i] {
+            try {
+                Client helper(m_username, m_long_term_private_key);
+                results[i] = helper.connect();
+                if (results[i] != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
+                    return;
+                }
+                results[i] = helper.uploadRangeRequest(filename, file_path, file_size, ranges[i].first,
+                                                       ranges[i].second);
+                helper.logoutRequest();
+            } catch (int error) {
+                results[i] = error;
+            }
+        });
+    }
+
+    // 3) Send the chunks of the first range (UploadM3+i) and receive its final result (SimpleMessage)
+    cout << "Client - Uploading in " << ranges.size() << " ranges..." << endl;
+    FileManager file_to_upload(file_path, FileManager::OpenMode::READ);
+    file_to_upload.initFileInfo(ranges[0].second, m_chunk_size);
+    if (sendFileChunks(file_to_upload, false) == -1) {
+        results[0] = static_cast<int>(Return::SEND_FAILURE);
+    } else {
+        results[0] = receiveMessage(plaintext, SimpleMessage::getMessageSize());
+        if (results[0] == static_cast<int>(Return::SUCCESS)) {
+            SimpleMessage upload_msg3i1 = SimpleMessage::deserialize(plaintext);
+            OPENSSL_cleanse(plaintext, SimpleMessage::getMessageSize());
+            delete[] plaintext;
+            if (upload_msg3i1.getMMessageCode() != static_cast<uint8_t>(Result::ACK)) {
+                results[0] = static_cast<int>(Return::WRONG_MSG_CODE);
+            }
+        }
+    }
+    for (thread &helper : helpers) {
+        helper.join();
+    }
+
+    for (int range_result : results) {
+        if (range_result != static_cast<int>(Return::SUCCESS)) {
+            return range_result;
+        }
+    }
+    cout << "Client - Uploading: 100% complete" << endl;
     return static_cast<int>(Return::SUCCESS);
 }
+
+/**
+ * @brief Encrypt a message with the current counter value and send it to the server, then increment the counter.
+ * @param serialized_message The serialized message, padded to its full size. It is deleted after the encryption.
+ * @param message_len The length of the serialized message.
+ * @return An integer code indicating the result of the operation.
+ */
+int Client::sendMessage(uint8_t *serialized_message, size_t message_len) {
+    Generic generic_message(m_counter);
+    if (generic_message.encrypt(*m_cipher, serialized_message, static_cast<int>(message_len)) == -1) {
+        return static_cast<int>(Return::ENCRYPTION_FAILURE);
+    }
+    iovec buffers[Generic::BUFFERS_NUM];
+    generic_message.getBuffers(buffers);
+    if (m_socket->send(buffers, Generic::BUFFERS_NUM) == -1) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+
+    incrementCounter();
+    return static_cast<int>(Return::SUCCESS);
+}
+
+/**
+ * @brief Receive a message from the server, decrypt it and check its counter, then increment the counter.
+ * @param plaintext Set to the decrypted message, to be cleansed and deleted by the caller.
+ * @param message_len The length of the serialized message.
+ * @return An integer code indicating the result of the operation.
+ */
+int Client::receiveMessage(uint8_t *&plaintext, size_t message_len) {
+    size_t generic_message_len = Generic::getMessageSize(message_len);
+    auto *serialized_message = new uint8_t[generic_message_len];
+    if (m_socket->receive(serialized_message, generic_message_len) == -1) {
+        delete[] serialized_message;
+        return static_cast<int>(Return::RECEIVE_FAILURE);
+    }
+    Generic generic_message = Generic::deserialize(serialized_message, message_len);
+    delete[] serialized_message;
+
+    // The plaintext is allocated by the decryption and already released when it fails
+    plaintext = nullptr;
+    if (generic_message.decrypt(*m_cipher, plaintext) == -1) {
+        return static_cast<int>(Return::DECRYPTION_FAILURE);
+    }
+    if (m_counter != generic_message.getCounter()) {
+        OPENSSL_cleanse(plaintext, message_len);
+        delete[] plaintext;
+        return static_cast<int>(Return::WRONG_COUNTER);
+    }
+
+    incrementCounter();
+    return static_cast<int>(Return::SUCCESS);
+}
+
+
 /**
  * @brief Client Rename operation
  * 1) Initiate a file rename request by creating and sending a RenameM1 message with the old filename and
@@ -849,7 +1604,7 @@ int Client::renameRequest(string old_file_name, string new_file_name) {
 
     Generic generic_msg1(m_counter);
 
-    if(generic_msg1.encrypt(m_session_key, serialized_message, static_cast<int>(renameM1_length)) == -1) {
+    if(generic_msg1.encrypt(*m_cipher, serialized_message, static_cast<int>(renameM1_length)) == -1) {
         cout << "Client - Error during encryption" << endl;
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -881,7 +1636,7 @@ int Client::renameRequest(string old_file_name, string new_file_name) {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[renameM2_length];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
     SimpleMessage renameM2 = SimpleMessage::deserialize(plaintext);
@@ -931,7 +1686,7 @@ int Client::logoutRequest() {
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg1.encrypt(m_session_key, serialized_message,static_cast<int>(logout_msg1_len)) == -1) {
+    if (generic_msg1.encrypt(*m_cipher, serialized_message,static_cast<int>(logout_msg1_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (UploadM1 message)
@@ -965,7 +1720,7 @@ int Client::logoutRequest() {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[logout_msg2_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
@@ -1012,7 +1767,7 @@ int Client::deleteRequest(string filename) {
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg1.encrypt(m_session_key, serialized_message,Config::MAX_PACKET_SIZE) == -1) {
+    if (generic_msg1.encrypt(*m_cipher, serialized_message,Config::MAX_PACKET_SIZE) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (UploadM1 message)
@@ -1045,7 +1800,7 @@ int Client::deleteRequest(string filename) {
     // Allocate memory for the plaintext buffer
     auto *plaintext = new uint8_t[delete_msg2_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg2.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg2.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
@@ -1094,7 +1849,7 @@ int Client::deleteRequest(string filename) {
     // Create a Generic message with the current counter value
     Generic generic_msg3(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg3.encrypt(m_session_key, serialized_message,static_cast<int>(delete_msg3_len)) == -1) {
+    if (generic_msg3.encrypt(*m_cipher, serialized_message,static_cast<int>(delete_msg3_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (SimpleMessage)
@@ -1131,7 +1886,7 @@ int Client::deleteRequest(string filename) {
     // Allocate memory for the plaintext buffer
     plaintext = new uint8_t[delete_msg4_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg4.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg4.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
@@ -1197,21 +1952,14 @@ int Client::run() {
         return -1;
     }
 
-    // Connect to the server
-    try {
-        m_socket = new SocketManager(Config::SERVER_IP, Config::SERVER_PORT);
-    } catch (const exception &e) {
-        cout << "Client - Connection to the server failed" << endl;
-        return -1;
-    }
-
-    //AUTHENTICATION PHASE
-    int result = authenticationRequest();
+    //CONNECTION AND AUTHENTICATION PHASE
+    int result = connect();
     if(result != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
         cout << "Client - Authentication failed with error code: " << result << endl;
         return -1;
     }
-    cout << "Client - Successful Authentication for " << m_username << endl;
+    cout << "Client - Successful Authentication for " << m_username << " ("
+         << SessionCipher::getSuiteName(m_cipher_suite) << ")" << endl;
     //OPERATIONS PHASE (enter the loop)
     try {
         while (true) {
@@ -1242,7 +1990,7 @@ int Client::run() {
                         continue;
                     }
                     // Execute the download operation and check the result
-                    result = downloadRequest(filename);
+                    result = m_connections_num > 1 ? parallelDownload(filename) : downloadRequest(filename);
                     if (result == static_cast<int>(Return::SUCCESS)) {
                         cout << "Client - File " << filename << " downloaded successfully" << endl;
                     } else if (result == static_cast<int>(Return::FILE_ALREADY_EXISTS)) {
@@ -1267,7 +2015,7 @@ int Client::run() {
                         continue;
                     }
                     // Execute the upload operation and check the result
-                    result = uploadRequest(filename);
+                    result = m_connections_num > 1 ? parallelUpload(filename) : uploadRequest(filename);
                     if (result == static_cast<int>(Return::FILE_ALREADY_EXISTS)) {
                         cout << "Client - File Already Exists! " << endl;
                     } else if (result == static_cast<int>(Return::FILE_NOT_FOUND)) {
@@ -1335,6 +2083,8 @@ int Client::run() {
                 }
                 case 6: {
                     cout << "Client - Logout operation selected\n" << endl;
+                    // The next login of the user performs the full handshake
+                    forgetSessionTicket(m_username);
                     // Execute the logout operation and check the result
                     result = logoutRequest();
                     if (result != static_cast<int>(Return::SUCCESS)) {
@@ -1371,22 +2121,35 @@ int Client::run() {
 }
 
 /**
- * Increment the counter value or perform re-authenticationRequest if needed.
- * If the counter reaches the maximum value, re-authenticationRequest is triggered.
- * @throws int Return::AUTHENTICATION_FAILURE if re-authenticationRequest fails.
+ * Increment the counter value or change the session key if needed.
+ * If the counter reaches the rekey interval of the session, the next session key is derived.
+ * @throws int Return::AUTHENTICATION_FAILURE if the derivation of the next key fails.
  */
 void Client::incrementCounter() {
-    // Check if re-authenticationRequest is needed
-    if (m_counter == Config::MAX_COUNTER_VALUE) {
-        // Perform re-authenticationRequest
-        if (authenticationRequest() != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
-            throw static_cast<int>(Return::AUTHENTICATION_FAILURE);
-        }
+    // Check if the session key has to be changed, after the same message as the server
+    if (m_counter >= SessionCipher::getRekeyInterval(m_chunk_size) - 1) {
+        rekey();
     } else {
         m_counter++; // Increment counter
     }
 }
 
+/**
+ * Changes the session key without a new handshake: the next key is derived from the current one with HKDF,
+ * as the server does after the same message, and the counter restarts
+ */
+void Client::rekey() {
+    unsigned char next_session_key[Config::AES_KEY_LEN];
+    if (SessionCipher::deriveNextKey(m_session_key, next_session_key) != 0) {
+        throw static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    memcpy(m_session_key, next_session_key, Config::AES_KEY_LEN);
+    OPENSSL_cleanse(next_session_key, Config::AES_KEY_LEN);
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::CLIENT, m_cipher_suite);
+    m_counter = 0;
+}
+
 /**
  * Displays the Operation Menu options
  */
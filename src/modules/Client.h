@@ -5,6 +5,8 @@
 #include <cstring>
 #include <chrono>
 #include <thread>
+#include <map>
+#include <mutex>
 #include <arpa/inet.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
@@ -12,17 +14,44 @@
 #include "SocketManager.h"
 #include "Config.h"
 #include "Generic.h"
+#include "FileManager.h"
+#include "Resumption.h"
+#include "SessionCipher.h"
 
 
 class Client {
 
+    // Session ticket received at the end of a full handshake, used to resume the next sessions of the user
+    struct CachedTicket {
+        uint8_t sealed_ticket[SEALED_TICKET_LEN];
+        uint8_t resumption_secret[RESUMPTION_SECRET_LEN];
+        uint32_t chunk_size;
+        CipherSuite cipher_suite;
+        chrono::steady_clock::time_point expiration_time;
+    };
+
+    // Tickets shared by all the sessions and keyed by username
+    static map<string, CachedTicket> m_tickets;
+    static mutex m_tickets_mutex;
+
     string m_username;
     uint32_t m_counter;
-    SocketManager* m_socket;
+    SocketManager* m_socket = nullptr;
     unsigned char m_session_key[Config::AES_KEY_LEN];
-    EVP_PKEY* m_long_term_private_key;
+    SessionCipher* m_cipher = nullptr;
+    EVP_PKEY* m_long_term_private_key = nullptr;
+    uint32_t m_chunk_size = Config::CHUNK_SIZE;
+    CipherSuite m_cipher_suite = CipherSuite::AES_128_GCM;
+    static unsigned int m_connections_num;
+    static uint32_t m_requested_chunk_size;
+    static CipherSuite m_requested_cipher_suite;
+    static KeyExchange m_requested_key_exchange;
 
+    int connect();
     int authenticationRequest();
+    int resumptionRequest();
+    int receiveSessionTicket();
+    static void forgetSessionTicket(const string& username);
     int listRequest();
     int downloadRequest(const string& filename);
     int uploadRequest(string filename);
@@ -30,12 +59,31 @@ class Client {
     int logoutRequest();
     int deleteRequest(string filename);
 
+    int resumeDownload(const string &filename, const string &file_path);
+    int downloadRangeRequest(const string& filename, const string& file_path, uint32_t offset, uint32_t length,
+                             uint32_t& file_size, uint64_t *version = nullptr);
+    int uploadRangeRequest(const string& filename, const string& file_path, uint32_t file_size,
+                           uint32_t offset, uint32_t length);
+    int parallelDownload(const string& filename);
+    int parallelUpload(const string& filename);
+    int receiveFileChunks(FileManager& downloaded_file, bool show_progress);
+    int sendFileChunks(FileManager& file_to_upload, bool show_progress);
+    int sendMessage(uint8_t* serialized_message, size_t message_len);
+    int receiveMessage(uint8_t*& plaintext, size_t message_len);
+
     void incrementCounter();
+    void rekey();
 
 public:
     Client();
+    Client(const string& username, EVP_PKEY* long_term_private_key);
     ~Client();
 
+    static void setConnectionsNum(unsigned int connections_num);
+    static void setRequestedChunkSize(uint32_t chunk_size);
+    static void setRequestedCipherSuite(CipherSuite cipher_suite);
+    static void setRequestedKeyExchange(KeyExchange key_exchange);
+
     int run();
     void showMenu();
 };
@@ -2,6 +2,7 @@
 #include <csignal>
 
 #include "Client.h"
+#include "SocketManager.h"
 
 using namespace std;
 
@@ -22,12 +23,48 @@ void clientSignalHandler(int signal) {
 }
 
 
-int main() {
+/**
+ * @brief Main function for the client.
+ * @details The --io-uring option selects the io_uring transport for the connection with the server.
+ * The --connections option sets the number of sessions used to download and upload the ranges of a file.
+ * The --chunk-size option sets the chunk size in bytes requested to the server.
+ * The --cipher option sets the AEAD algorithm requested to the server for the session messages.
+ * The --key-exchange option sets the group of the ephemeral key exchange (X25519 by default).
+ */
+int main(int argc, char *argv[]) {
 
     // register the signal handler for SIGINT and SIGPIPE
     signal(SIGINT, clientSignalHandler);
     signal(SIGPIPE, clientSignalHandler);
 
+    // Parse the command line options
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--io-uring") {
+            SocketManager::setTransport(SocketManager::Transport::IO_URING);
+        } else if (option == "--connections" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            Client::setConnectionsNum(atoi(argv[++i]));
+        } else if (option == "--chunk-size" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            Client::setRequestedChunkSize(atoi(argv[++i]));
+        } else if (option == "--cipher" && i + 1 < argc && string(argv[i + 1]) == "aes") {
+            Client::setRequestedCipherSuite(CipherSuite::AES_128_GCM);
+            ++i;
+        } else if (option == "--cipher" && i + 1 < argc && string(argv[i + 1]) == "chacha") {
+            Client::setRequestedCipherSuite(CipherSuite::CHACHA20_POLY1305);
+            ++i;
+        } else if (option == "--key-exchange" && i + 1 < argc && string(argv[i + 1]) == "x25519") {
+            Client::setRequestedKeyExchange(KeyExchange::X25519);
+            ++i;
+        } else if (option == "--key-exchange" && i + 1 < argc && string(argv[i + 1]) == "ffdhe") {
+            Client::setRequestedKeyExchange(KeyExchange::FFDHE_2048);
+            ++i;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--io-uring] [--connections N] [--chunk-size BYTES]"
+                 << " [--cipher aes|chacha] [--key-exchange x25519|ffdhe]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     while (true) {
         if (Client().run() == 1)
             break;
@@ -0,0 +1,270 @@
+#include <thread>
+#include <vector>
+#include <openssl/crypto.h>
+#include "DownloadPipeline.h"
+#include "CodesManager.h"
+#include "Config.h"
+#include "Download.h"
+#include "Generic.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor for the DownloadPipeline class.
+ * @param file The file to send, already opened in READ mode.
+ * @param socket The socket of the session.
+ * @param cipher The cipher of the session, copied once for each chunk sealed at the same time.
+ * @param first_counter The counter value of the first chunk message, incremented by one for each chunk.
+ */
+DownloadPipeline::DownloadPipeline(FileManager *file, SocketManager *socket, SessionCipher *cipher,
+                                   uint32_t first_counter)
+        : m_file(file), m_socket(socket), m_cipher(cipher), m_first_counter(first_counter),
+          m_result(static_cast<int>(Return::SUCCESS)),
+          m_buffer_len(Generic::getMessageSize(DownloadMi::getMessageSize(file->getChunkSize()))) {
+}
+
+/**
+ * @brief Destructor for the DownloadPipeline class, releases the message buffers and the cipher copies.
+ */
+DownloadPipeline::~DownloadPipeline() {
+    for (uint8_t *buffer : m_free_buffers) {
+        OPENSSL_cleanse(buffer, m_buffer_len);
+        delete[] buffer;
+    }
+    for (SessionCipher *cipher : m_free_ciphers) {
+        delete cipher;
+    }
+}
+
+/**
+ * @brief Send all the chunks of the file.
+ * @details The calling thread reads up to SEALING_WINDOW chunks ahead of the one being sent and submits them
+ * to the sealing pool, then writes the sealed messages in counter order, CHUNKS_BATCH_LEN messages per flush.
+ * The buffers of a batch are given back once it is flushed.
+ * @return SUCCESS, or the error code of the first step that failed.
+ */
+int DownloadPipeline::run() {
+    size_t chunks_num = m_file->getChunksNum();
+    size_t next_read = 0;
+    vector<uint8_t *> queued_buffers;
+    for (size_t next_index = 0; next_index < chunks_num; next_index++) {
+        // Read and submit the chunks of the window, so that they are encrypted while the previous ones are sent
+        while (next_read < chunks_num && next_read - next_index < Config::SEALING_WINDOW) {
+            Chunk chunk{};
+            if (readChunk(next_read, chunk) == -1) {
+                setFailure(static_cast<int>(Return::READ_CHUNK_FAILURE));
+                break;
+            }
+            submitChunk(chunk);
+            next_read++;
+        }
+
+        // Wait for the next chunk in counter order
+        Chunk chunk{};
+        if (waitChunk(next_index, chunk) == -1) {
+            break;
+        }
+        queued_buffers.push_back(chunk.buffer);
+        bool batch_over = queued_buffers.size() == Config::CHUNKS_BATCH_LEN || next_index == chunks_num - 1;
+        int result = m_socket->queueSend(chunk.buffer, chunk.size);
+        if (result == 0 && batch_over) {
+            result = m_socket->flush();
+        }
+        if (result != 0 || batch_over) {
+            for (uint8_t *queued_buffer : queued_buffers) {
+                releaseBuffer(queued_buffer);
+            }
+            queued_buffers.clear();
+        }
+        if (result != 0) {
+            setFailure(static_cast<int>(Return::SEND_FAILURE));
+            break;
+        }
+    }
+
+    // Complete the messages queued to the socket before releasing their buffers
+    if (!queued_buffers.empty()) {
+        m_socket->flush();
+        for (uint8_t *queued_buffer : queued_buffers) {
+            releaseBuffer(queued_buffer);
+        }
+    }
+
+    // Wait for the chunks still in the sealing pool, then release the ones not sent after a failure
+    unique_lock<mutex> lock(m_sealed_mutex);
+    m_sealed_cv.wait(lock, [this] { return m_sealing_chunks == 0; });
+    for (auto &sealed_chunk : m_sealed_chunks) {
+        releaseBuffer(sealed_chunk.second.buffer);
+    }
+    m_sealed_chunks.clear();
+    return m_result;
+}
+
+/**
+ * @brief Take a message buffer released after its message was sent, or allocate a new one.
+ * @details The buffers in flight are bounded by the sealing window and the batch being sent, so after the first chunks
+ * the file is sent without allocating memory.
+ * @return A buffer of the size of a Generic message with a whole chunk.
+ */
+uint8_t *DownloadPipeline::acquireBuffer() {
+    {
+        lock_guard<mutex> lock(m_free_buffers_mutex);
+        if (!m_free_buffers.empty()) {
+            uint8_t *buffer = m_free_buffers.back();
+            m_free_buffers.pop_back();
+            return buffer;
+        }
+    }
+    return new uint8_t[m_buffer_len];
+}
+
+/**
+ * @brief Give a message buffer back for the next chunks.
+ * @param buffer The buffer, no longer used by the socket.
+ */
+void DownloadPipeline::releaseBuffer(uint8_t *buffer) {
+    lock_guard<mutex> lock(m_free_buffers_mutex);
+    m_free_buffers.push_back(buffer);
+}
+
+/**
+ * @brief Take a copy of the session cipher released by a sealing worker, or make a new one.
+ * @details The copies are bounded by the chunks sealed at the same time, so the contexts are not allocated
+ * and copied again for every chunk: sealing a chunk only sets the IV of its counter.
+ * @return An encrypt-only copy of the session cipher.
+ */
+SessionCipher *DownloadPipeline::acquireCipher() {
+    {
+        lock_guard<mutex> lock(m_free_ciphers_mutex);
+        if (!m_free_ciphers.empty()) {
+            SessionCipher *cipher = m_free_ciphers.back();
+            m_free_ciphers.pop_back();
+            return cipher;
+        }
+    }
+    return new SessionCipher(*m_cipher, true);
+}
+
+/**
+ * @brief Give a copy of the session cipher back for the next chunks.
+ * @param cipher The copy, no longer used by the sealing worker.
+ */
+void DownloadPipeline::releaseCipher(SessionCipher *cipher) {
+    lock_guard<mutex> lock(m_free_ciphers_mutex);
+    m_free_ciphers.push_back(cipher);
+}
+
+/**
+ * @brief Read a chunk of the file in a message buffer.
+ * @details The chunk is read after the header of the Generic message and the message code of the DownloadMi
+ * message, so that it is encrypted and sent without being copied. When the file is memory mapped the chunk
+ * is not read at all: the sealing worker encrypts it from the mapping into the buffer.
+ * @param index The index of the chunk, chunks are read in order.
+ * @param chunk Set to the chunk read.
+ * @return 0 on success, -1 on failure.
+ */
+int DownloadPipeline::readChunk(size_t index, Chunk &chunk) {
+    // If the chunk is the last, set the appropriate size
+    size_t chunk_size = (index == m_file->getChunksNum() - 1) ? m_file->getLastChunkSize() : m_file->getChunkSize();
+    uint8_t *buffer = acquireBuffer();
+    const uint8_t *source = nullptr;
+    int result;
+    if (m_file->isMapped()) {
+        source = m_file->mapChunk(static_cast<streamsize>(chunk_size));
+        result = source == nullptr ? -1 : 0;
+    } else {
+        uint8_t *download_msg3i = buffer + Generic::HEADER_LEN;
+        download_msg3i[0] = static_cast<uint8_t>(Message::DOWNLOAD_CHUNK);
+        result = m_file->readChunk(download_msg3i + sizeof(uint8_t), static_cast<streamsize>(chunk_size));
+    }
+    if (result == -1) {
+        releaseBuffer(buffer);
+        return -1;
+    }
+    chunk = {index, buffer, chunk_size, source};
+    return 0;
+}
+
+/**
+ * @brief Submit a chunk to the sealing pool shared by all the downloads.
+ * @param chunk The chunk read from the file.
+ */
+void DownloadPipeline::submitChunk(const Chunk &chunk) {
+    {
+        lock_guard<mutex> lock(m_sealed_mutex);
+        m_sealing_chunks++;
+    }
+    if (!getSealingPool().submit([this, chunk] { sealChunk(chunk); })) {
+        // Sealing pool already stopped (process exiting), seal on this thread
+        sealChunk(chunk);
+    }
+}
+
+/**
+ * @brief Encrypt the DownloadMi message of a chunk in its buffer and put it in the reorder buffer.
+ * Executed by the workers of the sealing pool.
+ * @param chunk The chunk read from the file.
+ */
+void DownloadPipeline::sealChunk(Chunk chunk) {
+    // Encrypt the DownloadMi with the counter value of the chunk and a copy of the session cipher,
+    // since the contexts cannot be shared by the sealing workers
+    SessionCipher *cipher = acquireCipher();
+    size_t download_msg3i_len = DownloadMi::getMessageSize(chunk.size);
+    uint32_t counter = m_first_counter + static_cast<uint32_t>(chunk.index);
+    int ciphertext_len = chunk.source != nullptr ?
+                         Generic::sealFrom(*cipher, counter, chunk.buffer,
+                                           static_cast<uint8_t>(Message::DOWNLOAD_CHUNK), chunk.source, chunk.size) :
+                         Generic::sealInPlace(*cipher, counter, chunk.buffer, download_msg3i_len);
+    releaseCipher(cipher);
+    if (ciphertext_len == -1) {
+        releaseBuffer(chunk.buffer);
+        setFailure(static_cast<int>(Return::ENCRYPTION_FAILURE));
+        lock_guard<mutex> lock(m_sealed_mutex);
+        m_sealing_chunks--;
+        m_sealed_cv.notify_all();
+        return;
+    }
+
+    lock_guard<mutex> lock(m_sealed_mutex);
+    m_sealed_chunks[chunk.index] = {chunk.index, chunk.buffer, Generic::getMessageSize(download_msg3i_len), nullptr};
+    m_sealing_chunks--;
+    m_sealed_cv.notify_all();
+}
+
+/**
+ * @brief Wait for a chunk to be sealed and take it out of the reorder buffer.
+ * @param index The index of the chunk.
+ * @param chunk Set to the sealed chunk.
+ * @return 0 on success, -1 if the pipeline has failed.
+ */
+int DownloadPipeline::waitChunk(size_t index, Chunk &chunk) {
+    unique_lock<mutex> lock(m_sealed_mutex);
+    m_sealed_cv.wait(lock, [this, index] { return m_failed || m_sealed_chunks.count(index) != 0; });
+    if (m_failed) {
+        return -1;
+    }
+    chunk = m_sealed_chunks[index];
+    m_sealed_chunks.erase(index);
+    return 0;
+}
+
+/**
+ * @brief Record a failure and stop the whole pipeline.
+ * @param result The error code of the failure, only the first one is kept.
+ */
+void DownloadPipeline::setFailure(int result) {
+    int success = static_cast<int>(Return::SUCCESS);
+    m_result.compare_exchange_strong(success, result);
+    lock_guard<mutex> lock(m_sealed_mutex);
+    m_failed = true;
+    m_sealed_cv.notify_all();
+}
+
+/**
+ * @brief Get the sealing pool shared by all the downloads, with one worker per core.
+ * @return The sealing pool.
+ */
+WorkerPool &DownloadPipeline::getSealingPool() {
+    static WorkerPool sealing_pool(thread::hardware_concurrency(), 0);
+    return sealing_pool;
+}
@@ -0,0 +1,90 @@
+#ifndef SECURE_CLOUD_STORAGE_DOWNLOADPIPELINE_H
+#define SECURE_CLOUD_STORAGE_DOWNLOADPIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "FileManager.h"
+#include "Generic.h"
+#include "SessionCipher.h"
+#include "SocketManager.h"
+#include "WorkerPool.h"
+
+/**
+ * Sends the chunks of a file (DownloadM3+i messages) through a pipeline: the thread of the session reads
+ * the chunks ahead of the one being sent and submits them to a sealing pool shared by all the sessions,
+ * which builds and encrypts the DownloadMi messages, then writes the sealed messages on the socket.
+ * No thread is created per download, and encrypting the next chunks overlaps with the sending.
+ * Each chunk gets its counter value up front, and the sealed messages are reordered by counter before being sent.
+ * The contexts of the session cipher cannot be shared by the sealing workers, so each of them seals with an
+ * encrypt-only copy that is reused for the following chunks of the download.
+ */
+class DownloadPipeline {
+
+public:
+    DownloadPipeline(FileManager *file, SocketManager *socket, SessionCipher *cipher, uint32_t first_counter);
+
+    ~DownloadPipeline();
+
+    int run();
+
+private:
+    // A chunk travelling through the pipeline, in the buffer of its Generic message: plaintext after the
+    // reader, serialized Generic message after the sealer
+    struct Chunk {
+        size_t index;
+        uint8_t *buffer;
+        size_t size;
+        const uint8_t *source; // Chunk in the mapping of the file, nullptr if it has been read in the buffer
+    };
+
+    FileManager *m_file;
+    SocketManager *m_socket;
+    SessionCipher *m_cipher;
+    uint32_t m_first_counter;
+
+    atomic<int> m_result;
+
+    // Reorder buffer: sealed chunks waiting for the ones with a lower index to be sent
+    map<size_t, Chunk> m_sealed_chunks;
+    size_t m_sealing_chunks = 0;    // Chunks submitted to the sealing pool and not sealed yet
+    bool m_failed = false;
+    mutex m_sealed_mutex;
+    condition_variable m_sealed_cv;
+
+    // Message buffers given back once their messages are sent and reused for the next chunks
+    size_t m_buffer_len;
+    vector<uint8_t *> m_free_buffers;
+    mutex m_free_buffers_mutex;
+
+    // Encrypt-only copies of the session cipher given back by the sealing workers, at most one per chunk
+    // being sealed at the same time
+    vector<SessionCipher *> m_free_ciphers;
+    mutex m_free_ciphers_mutex;
+
+    uint8_t *acquireBuffer();
+
+    void releaseBuffer(uint8_t *buffer);
+
+    SessionCipher *acquireCipher();
+
+    void releaseCipher(SessionCipher *cipher);
+
+    int readChunk(size_t index, Chunk &chunk);
+
+    void submitChunk(const Chunk &chunk);
+
+    void sealChunk(Chunk chunk);
+
+    int waitChunk(size_t index, Chunk &chunk);
+
+    void setFailure(int result);
+
+    static WorkerPool &getSealingPool();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_DOWNLOADPIPELINE_H
@@ -0,0 +1,273 @@
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Reactor.h"
+#include "Config.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor for the Reactor class.
+ * @param listening_socket The server listening socket, watched for incoming connections.
+ * @param workers_num The number of worker threads serving the ready sessions.
+ * @param transfer_workers_num The number of worker threads running the file transfers.
+ * @param handshake_workers_num The number of worker threads running the handshakes.
+ */
+Reactor::Reactor(SocketManager *listening_socket, unsigned int workers_num, unsigned int transfer_workers_num,
+                 unsigned int handshake_workers_num)
+        : m_listening_socket(listening_socket), m_workers(workers_num, 0), m_transfer_workers(transfer_workers_num, 0),
+          m_handshake_workers(handshake_workers_num, 0) {
+    raiseDescriptorLimit();
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        cerr << "Reactor - Error during the epoll instance creation!" << endl;
+        throw EXIT_FAILURE;
+    }
+
+    // Event descriptor used to wake up the event loop when the reactor is stopped
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event wakeup_event{};
+    wakeup_event.events = EPOLLIN;
+    wakeup_event.data.ptr = &m_wakeup_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wakeup_fd, &wakeup_event);
+
+    // The listening socket is identified by a null pointer in the event data
+    epoll_event listening_event{};
+    listening_event.events = EPOLLIN;
+    listening_event.data.ptr = nullptr;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_listening_socket->getListeningSocketDescriptor(),
+                  &listening_event) == -1) {
+        cerr << "Reactor - Error while registering the listening socket!" << endl;
+        throw EXIT_FAILURE;
+    }
+
+    m_running = true;
+}
+
+/**
+ * @brief Destructor for the Reactor class.
+ * @details Stops the workers, closes every open session and releases the epoll resources.
+ */
+Reactor::~Reactor() {
+    stop();
+
+    // Unblock the workers still waiting for data from a client, then wait for them
+    {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        for (Session *session : m_sessions) {
+            shutdown(session->socket->getSocketDescriptor(), SHUT_RDWR);
+        }
+    }
+    m_handshake_workers.shutdown();
+    // The session workers may still hand a transfer to the transfer workers, so they are stopped first
+    m_workers.shutdown();
+    m_transfer_workers.shutdown();
+
+    // Release the sessions still registered in the event loop
+    for (Session *session : m_sessions) {
+        delete session->server;
+        delete session->socket;
+        delete session;
+    }
+    m_sessions.clear();
+
+    close(m_wakeup_fd);
+    close(m_epoll_fd);
+}
+
+/**
+ * @brief Raise the soft limit on open descriptors to the hard limit, so that the process can hold
+ * tens of thousands of idle sessions.
+ */
+void Reactor::raiseDescriptorLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &limit) == -1) {
+            cerr << "Reactor - Unable to raise the open descriptors limit" << endl;
+        }
+    }
+}
+
+/**
+ * @brief Event loop of the reactor: waits for readiness events and dispatches them until stop() is called.
+ */
+void Reactor::run() {
+    epoll_event events[Config::REACTOR_MAX_EVENTS];
+
+    cout << "Reactor - Event loop started with " << m_workers.getWorkersNum() << " workers, "
+         << m_transfer_workers.getWorkersNum() << " transfer workers and "
+         << m_handshake_workers.getWorkersNum() << " handshake workers" << endl;
+    while (m_running) {
+        int events_num = epoll_wait(m_epoll_fd, events, Config::REACTOR_MAX_EVENTS, -1);
+        if (events_num == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Reactor - Error while waiting for events!" << endl;
+            break;
+        }
+
+        for (int i = 0; i < events_num; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                // New connection request on the listening socket
+                acceptConnection();
+            } else if (events[i].data.ptr == &m_wakeup_fd) {
+                // Reactor stopped
+                uint64_t value;
+                read(m_wakeup_fd, &value, sizeof(value));
+            } else {
+                // Data (or connection closure) ready on a session socket
+                dispatchSession(static_cast<Session *>(events[i].data.ptr));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Stop the event loop and the workers.
+ */
+void Reactor::stop() {
+    m_running = false;
+    uint64_t value = 1;
+    write(m_wakeup_fd, &value, sizeof(value));
+}
+
+/**
+ * @brief Get the number of sessions currently handled by the reactor.
+ * @return The number of open sessions.
+ */
+size_t Reactor::getSessionsNum() {
+    lock_guard<mutex> lock(m_sessions_mutex);
+    return m_sessions.size();
+}
+
+/**
+ * @brief Accept a new connection and register its socket in the event loop.
+ * @details The session starts in the AUTHENTICATING state: the handshake is run by a handshake worker as soon
+ * as the AuthenticationM1 message is ready to be read.
+ */
+void Reactor::acceptConnection() {
+    int socket_descriptor = m_listening_socket->accept();
+    if (socket_descriptor == -1) {
+        cout << "Reactor - Error during connection with the client!" << endl;
+        return;
+    }
+
+    auto *session = new Session();
+    session->socket = SocketManager::createConnection(socket_descriptor);
+    session->server = new Server(session->socket);
+    session->state = SessionState::AUTHENTICATING;
+    {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        m_sessions.insert(session);
+    }
+
+    // One-shot registration: the socket is disarmed while a worker is serving the session
+    epoll_event session_event{};
+    session_event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    session_event.data.ptr = session;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, socket_descriptor, &session_event) == -1) {
+        cerr << "Reactor - Error while registering the session socket!" << endl;
+        closeSession(session);
+    }
+}
+
+/**
+ * @brief Queue a ready session to be served by a worker.
+ * @details A session still authenticating is queued to the handshake workers, which block for the whole
+ * message exchange, while a logged-in session is queued to the workers serving the requests.
+ * @param session The session whose socket became ready.
+ */
+void Reactor::dispatchSession(Session *session) {
+    // The socket is disarmed until the worker re-arms it, so the session is never queued twice
+    if (session->state == SessionState::AUTHENTICATING) {
+        m_handshake_workers.submit([this, session] { processSession(session); });
+        return;
+    }
+    session->state = SessionState::PROCESSING;
+    m_workers.submit([this, session] { processSession(session); });
+}
+
+/**
+ * @brief Advance the state machine of a session by one step.
+ * @details An AUTHENTICATING session runs the handshake, a logged-in session serves exactly one request.
+ * A file transfer is handed to the transfer workers, the other requests are served on the calling worker.
+ * @param session The session to serve.
+ */
+void Reactor::processSession(Session *session) {
+    int result;
+    if (session->state == SessionState::AUTHENTICATING) {
+        result = session->server->authenticate();
+    } else {
+        result = session->server->receiveRequest();
+        if (result == 0 && session->server->isTransferRequest()) {
+            // The socket stays disarmed until the transfer is over
+            if (!m_transfer_workers.submit([this, session] {
+                completeSession(session, session->server->serveRequest());
+            })) {
+                completeSession(session, -1);
+            }
+            return;
+        }
+        if (result == 0) {
+            result = session->server->serveRequest();
+        }
+    }
+    completeSession(session, result);
+}
+
+/**
+ * @brief Finish a step of a session: if the session is still alive it goes back to IDLE and its socket is
+ * re-armed, otherwise it is closed.
+ * @param session The served session.
+ * @param result The result of the step, 0 if the session can continue.
+ */
+void Reactor::completeSession(Session *session, int result) {
+    if (result != 0) {
+        closeSession(session);
+        return;
+    }
+
+    session->state = SessionState::IDLE;
+    if (rearmSession(session) == -1) {
+        closeSession(session);
+    }
+}
+
+/**
+ * @brief Re-arm the one-shot registration of a session socket, waiting for its next request.
+ * @param session The session to re-arm.
+ * @return 0 on success, -1 on error.
+ */
+int Reactor::rearmSession(Session *session) {
+    epoll_event session_event{};
+    session_event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    session_event.data.ptr = session;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, session->socket->getSocketDescriptor(), &session_event) == -1) {
+        cerr << "Reactor - Error while re-arming the session socket!" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Close a session, removing its socket from the event loop and releasing its resources.
+ * @param session The session to close.
+ */
+void Reactor::closeSession(Session *session) {
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, session->socket->getSocketDescriptor(), nullptr);
+    session->state = SessionState::CLOSED;
+    {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        m_sessions.erase(session);
+    }
+    delete session->server;
+    delete session->socket;
+    delete session;
+}
@@ -0,0 +1,80 @@
+#ifndef SECURE_CLOUD_STORAGE_REACTOR_H
+#define SECURE_CLOUD_STORAGE_REACTOR_H
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
+#include "SocketManager.h"
+#include "Server.h"
+#include "WorkerPool.h"
+
+/**
+ * Event-driven server core. A single event loop waits with epoll for the readiness of the listening
+ * socket and of every session socket, while a small set of worker threads serves the session that
+ * became ready. Idle logged-in clients only cost a registered descriptor, not a thread.
+ * The file transfers are handed to a separate pool, so long uploads and downloads never hold the workers
+ * serving the short requests.
+ * The handshakes run on a pool of their own as well: a handshake still blocks its worker until the client
+ * has sent the whole message exchange, so a client stalling in the middle of it holds a handshake worker
+ * for up to SOCKET_TIMEOUT seconds per message. As many stalled clients as handshake workers delay the new
+ * logins, but never the requests of the sessions already logged in.
+ */
+class Reactor {
+
+public:
+    // Session lifecycle, advanced by the readiness events of the session socket
+    enum class SessionState {
+        AUTHENTICATING, // Connection accepted, waiting for the AuthenticationM1 message
+        IDLE,           // Client authenticated, waiting for the next request
+        PROCESSING,     // A worker is serving the session
+        CLOSED          // Session over, resources released
+    };
+
+    struct Session {
+        SocketManager *socket;
+        Server *server;
+        SessionState state;
+    };
+
+    Reactor(SocketManager *listening_socket, unsigned int workers_num, unsigned int transfer_workers_num,
+            unsigned int handshake_workers_num);
+
+    ~Reactor();
+
+    void run();
+
+    void stop();
+
+    size_t getSessionsNum();
+
+private:
+    SocketManager *m_listening_socket;
+    int m_epoll_fd;
+    int m_wakeup_fd;
+    atomic<bool> m_running{false};
+
+    WorkerPool m_workers;
+    WorkerPool m_transfer_workers;
+    WorkerPool m_handshake_workers;
+
+    unordered_set<Session *> m_sessions;
+    mutex m_sessions_mutex;
+
+    void acceptConnection();
+
+    void dispatchSession(Session *session);
+
+    void processSession(Session *session);
+
+    void completeSession(Session *session, int result);
+
+    int rearmSession(Session *session);
+
+    void closeSession(Session *session);
+
+    static void raiseDescriptorLimit();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_REACTOR_H
@@ -1,6 +1,11 @@
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include <filesystem>
+#include <ctime>
+#include <openssl/rand.h>
 #include <openssl/pem.h>
+#include <sys/uio.h>
 
 #include "Generic.h"
 #include "Server.h"
@@ -13,38 +18,88 @@
 #include "SimpleMessage.h"
 #include "Delete.h"
 #include "Authentication.h"
+#include "Resumption.h"
 #include "DiffieHellman.h"
+#include "EphemeralKeyPool.h"
+#include "KeyRegistry.h"
 #include "Hash.h"
 #include "CertificateManager.h"
+#include "CryptoExecutor.h"
 #include "AesGcm.h"
+#include "SessionCipher.h"
 #include "DigitalSignatureManager.h"
+#include "DownloadPipeline.h"
 
 using namespace std;
 
+map<string, Server::RangeUpload> Server::m_range_uploads;
+mutex Server::m_range_uploads_mutex;
+map<string, Server::SingleUpload> Server::m_single_uploads;
+
 Server::Server(SocketManager *socket) {
     m_socket = socket;
 }
 
 Server::~Server() {
     OPENSSL_cleanse(m_session_key, Config::AES_KEY_LEN);
-    OPENSSL_cleanse(m_socket, sizeof(m_socket));
+    delete m_cipher;
+    delete[] m_request;
 }
 
 void Server::incrementCounter() {
-    // Check if re-authenticationRequest is needed
-    if (m_counter == Config::MAX_COUNTER_VALUE) {
-        if (authenticationRequest() != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
-            throw static_cast<int>(Return::AUTHENTICATION_FAILURE);
-        }
+    // Check if the session key has to be changed, after the same message as the client
+    if (m_counter >= SessionCipher::getRekeyInterval(m_chunk_size) - 1) {
+        rekey();
     } else {
         m_counter++;
     }
 }
 
+/**
+ * @brief Change the session key without a new handshake: the next key is derived from the current one
+ * with HKDF, as the client does after the same message, and the counter restarts.
+ */
+void Server::rekey() {
+    unsigned char next_session_key[Config::AES_KEY_LEN];
+    if (SessionCipher::deriveNextKey(m_session_key, next_session_key) != 0) {
+        throw static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    memcpy(m_session_key, next_session_key, Config::AES_KEY_LEN);
+    OPENSSL_cleanse(next_session_key, Config::AES_KEY_LEN);
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::SERVER, m_cipher_suite);
+    m_counter = 0;
+}
+
+
+/**
+ * @brief Choose the chunk size of a session from the one requested by the client.
+ * @param requested_chunk_size The chunk size requested in the AuthenticationM1 message (0 for the default).
+ * @return The requested chunk size, clamped to the bounds allowed by the server.
+ */
+uint32_t Server::negotiateChunkSize(uint32_t requested_chunk_size) {
+    if (requested_chunk_size == 0) {
+        return Config::CHUNK_SIZE;
+    }
+    return static_cast<uint32_t>(clamp<long>(requested_chunk_size, Config::MIN_CHUNK_SIZE, Config::MAX_CHUNK_SIZE));
+}
+
+/**
+ * @brief Choose the AEAD algorithm of a session from the one requested by the client.
+ * @param requested_suite The cipher suite requested in the AuthenticationM1 message.
+ * @return The requested cipher suite if the server supports it, AES-128-GCM otherwise.
+ */
+CipherSuite Server::negotiateCipherSuite(uint8_t requested_suite) {
+    if (!SessionCipher::isSupported(requested_suite)) {
+        return CipherSuite::AES_128_GCM;
+    }
+    return static_cast<CipherSuite>(requested_suite);
+}
 
 /**
  * @brief Handle an authentication request from the client.
- * 1) Receive and deserialize an AuthenticationM1 message with the client's username and its ephemeral key (g^a mod p)
+ * 1) Receive and deserialize an AuthenticationM1 message with the client's username, its ephemeral key (g^a mod p)
+ * and the requested chunk size
  * 2) Check if the client is registered (its public key is present in the storage) and send an AuthenticationM2 message
  * to him with the result
  * 3) If the client is not present: create and serialize a SimpleMessage with the result and send it to the client
@@ -55,20 +110,50 @@ void Server::incrementCounter() {
  * 3.4) Serialize the server ephemeral key and create a buffer for concatenating client and server ephemeral keys (<g^a,g^b> message)
  * 3.5) Generate digital signature for the message using server private key (<g^a,g^b>S)
  * 3.6) Encrypt all the message {<g^a,g^b>S}K_session
- * 3.7) Load the Server's certificate and serialize it
+ * 3.7) Get the Server's certificate, serialized once for all the sessions
  * 3.8) Create AuthenticationM3 message and send it to the client
  * 4) Receive an AuthenticationM4 message from the client and deserialize it
  * 4.1) Decrypt the message and verify the client digital signature using the client public key
- * 5) Create an AuthenticationM5 SimpleMessage with the result, serialize it and send it to the client.
+ * 5) Create an AuthenticationM5 message with the result and the chunk size of the session, serialize it and
+ * send it to the client.
+ * 6) If the client is authenticated, send it a session ticket in an AuthenticationM6 message.
+ * If the first message is a ResumptionM1 instead of an AuthenticationM1, the session is resumed from the ticket.
  *
  * @return An integer code indicating the result of the authentication process.
  */
 int Server::authenticationRequest() {
     // Authentication M1 message
     cout << "Authentication request received" << endl;
-    size_t authentication_m1_length = AuthenticationM1::getMessageSize();
-    uint8_t* serialized_message = new uint8_t[authentication_m1_length];
-    int result = m_socket->receive(serialized_message, authentication_m1_length);
+    // Read the fixed fields shared by the first messages, then the rest of the message
+    size_t header_length = AuthenticationM1::getHeaderSize();
+    uint8_t* serialized_message = new uint8_t[max(ResumptionM1::getMessageSize(), AuthenticationM1::getMessageSize(
+            static_cast<uint8_t>(KeyExchange::FFDHE_2048)))];
+    int result = m_socket->receive(serialized_message, header_length);
+    if (result != 0) {
+        delete[] serialized_message;
+        return static_cast<int>(Return::RECEIVE_FAILURE);
+    }
+
+    // A client holding a session ticket resumes its session without the full handshake
+    if (serialized_message[0] == static_cast<uint8_t>(Message::RESUMPTION_REQUEST)) {
+        result = m_socket->receive(serialized_message + header_length,
+                                   ResumptionM1::getMessageSize() - header_length);
+        if (result != 0) {
+            delete[] serialized_message;
+            return static_cast<int>(Return::RECEIVE_FAILURE);
+        }
+        return resumptionRequest(serialized_message);
+    }
+
+    // The size of the ephemeral key depends on the key exchange group requested by the client
+    uint8_t key_exchange = serialized_message[sizeof(uint8_t)];
+    if (!DiffieHellman::isSupported(key_exchange)) {
+        delete[] serialized_message;
+        cerr << "Authentication - Key exchange group not supported!" << endl;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+    size_t authentication_m1_length = AuthenticationM1::getMessageSize(key_exchange);
+    result = m_socket->receive(serialized_message + header_length, authentication_m1_length - header_length);
     if (result != 0) {
         delete[] serialized_message;
         return static_cast<int>(Return::RECEIVE_FAILURE);
@@ -76,27 +161,22 @@ int Server::authenticationRequest() {
 
     AuthenticationM1 authenticationM1 = AuthenticationM1::deserialize(serialized_message);
     OPENSSL_cleanse(serialized_message, authentication_m1_length);
+    delete[] serialized_message;
+    uint32_t chunk_size = negotiateChunkSize(authenticationM1.getMChunkSize());
+    CipherSuite cipher_suite = negotiateCipherSuite(authenticationM1.getMCipherSuite());
 
     // Authentication M2 message
-    string username_file = "../resources/public_keys/" + (string)authenticationM1.getMUsername() + "_key.pem";
-    BIO *bio = BIO_new_file(username_file.c_str(), "r");
-    EVP_PKEY* client_public_key = nullptr;
+    // Look the client public key up in the registry loaded at startup
     SimpleMessage simple_message;
     size_t serialized_message_length;
-    if (!bio) {
-        BIO_free(bio);
-        cerr << "Authentication - Error in creating the bio structure for the Client public key!" << endl;
-        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
-    }
     m_username = (string)authenticationM1.getMUsername();
-    client_public_key = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
+    EVP_PKEY* client_public_key = KeyRegistry::getInstance()->getUserPublicKey(m_username);
     if (!client_public_key) {
         simple_message.setMMessageCode(static_cast<int>(Result::NACK));
         cerr << "Authentication - Username " << m_username << " not found!" << endl;
     } else {
         simple_message.setMMessageCode(static_cast<int>(Result::ACK));
     }
-    BIO_free(bio);
 
     // Serialize and send the acknowledgment or non-acknowledgment
     serialized_message = simple_message.serialize();
@@ -114,17 +194,22 @@ int Server::authenticationRequest() {
 
     // Authentication M3
 
-    // Generate ephemeral key and derive shared secret
-    DiffieHellman dh_instance;
-    EVP_PKEY* server_ephemeral_key = dh_instance.generateEphemeralKey();
+    // Take a pre-generated ephemeral key in the group of the client and derive shared secret
+    auto key_exchange_group = static_cast<KeyExchange>(key_exchange);
+    DiffieHellman dh_instance(key_exchange_group);
+    EVP_PKEY* server_ephemeral_key = EphemeralKeyPool::getInstance()->acquire(key_exchange_group);
 
     EVP_PKEY* client_ephemeral_key = dh_instance.deserializeEphemeralKey(
             const_cast<uint8_t *>(authenticationM1.getMEphemeralKey()),
             authenticationM1.getMEphemeralKeyLen());
     uint8_t* shared_secret = nullptr;
     size_t shared_secret_length;
-    result = dh_instance.deriveSharedSecret(server_ephemeral_key, client_ephemeral_key,
-                                            shared_secret, shared_secret_length);
+    // The public-key operations run on the crypto workers, not on the thread serving the session
+    CryptoExecutor* crypto_executor = CryptoExecutor::getInstance();
+    result = crypto_executor->run([&] {
+        return dh_instance.deriveSharedSecret(server_ephemeral_key, client_ephemeral_key,
+                                              shared_secret, shared_secret_length);
+    });
     EVP_PKEY_free(client_ephemeral_key);
     if (result != 0) {
         OPENSSL_cleanse(shared_secret, shared_secret_length);
@@ -142,6 +227,8 @@ int Server::authenticationRequest() {
 
     // Copy session key and clean up
     memcpy(m_session_key, session_key, Config::AES_KEY_LEN * sizeof(unsigned char));
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::SERVER, cipher_suite);
     OPENSSL_cleanse(shared_secret, shared_secret_length);
     delete[] shared_secret;
     OPENSSL_cleanse(session_key, session_key_length);
@@ -167,16 +254,10 @@ int Server::authenticationRequest() {
     memcpy(ephemeral_key_buffer + authenticationM1.getMEphemeralKeyLen(), serialized_server_ephemeral_key,
            serialized_server_ephemeral_key_length);
 
-    string private_key_file = "../resources/private_keys/Server_key.pem";
-    bio = BIO_new_file(private_key_file.c_str(), "r");
-    if (!bio) {
-        BIO_free(bio);
-        cerr << "Authentication - Error in creating the bio structure for the Server private key!" << endl;
-        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
-    }
-    EVP_PKEY* server_private_key = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL);
-    BIO_free(bio);
+    EVP_PKEY* server_private_key = KeyRegistry::getInstance()->getServerPrivateKey();
     if(!server_private_key) {
+        delete[] serialized_server_ephemeral_key;
+        delete[] ephemeral_key_buffer;
         EVP_PKEY_free(client_public_key);
         cerr << "Server private key not found!" << endl;
         return static_cast<int>(Return::AUTHENTICATION_FAILURE);
@@ -186,9 +267,18 @@ int Server::authenticationRequest() {
     unsigned char* digital_signature = nullptr;
     unsigned int digital_signature_length;
     DigitalSignatureManager digitalSignatureManager;
-    digitalSignatureManager.generateDS(ephemeral_key_buffer, ephemeral_key_buffer_length,
-                                       digital_signature, digital_signature_length, server_private_key);
+    result = crypto_executor->run([&] {
+        return digitalSignatureManager.generateDS(ephemeral_key_buffer, ephemeral_key_buffer_length,
+                                                  digital_signature, digital_signature_length, server_private_key);
+    });
     EVP_PKEY_free(server_private_key);
+    if (result != 0) {
+        delete[] digital_signature;
+        delete[] serialized_server_ephemeral_key;
+        delete[] ephemeral_key_buffer;
+        EVP_PKEY_free(client_public_key);
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
 
     // Encrypt the digital signature for transmission in AuthenticationM3
     unsigned char *ciphertext = nullptr;
@@ -197,7 +287,7 @@ int Server::authenticationRequest() {
     memcpy(aad, &m_counter, Config::AAD_LEN);
     unsigned char tag[Config::AES_TAG_LEN];
     AesGcm aesGcm = AesGcm(m_session_key);
-    int ciphertext_length = aesGcm.encrypt(digital_signature, ENCRYPTED_SIGNATURE_LEN,
+    int ciphertext_length = aesGcm.encrypt(digital_signature, static_cast<int>(digital_signature_length),
                                            aad, Config::AAD_LEN,
                                            ciphertext, tag);
     delete[] digital_signature;
@@ -211,26 +301,29 @@ int Server::authenticationRequest() {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
 
-    // Load server certificate and serialize it
-    const char *certificate_file = "../resources/certificates/Server_cert.pem";
-    CertificateManager* certificateManager = CertificateManager::getInstance();
-    X509* certificate = certificateManager->loadCertificate(certificate_file);
-
-    uint8_t* serialized_certificate = nullptr;
+    // Get the server certificate, loaded and serialized by the first session only
+    const uint8_t* serialized_certificate = nullptr;
     int serialized_certificate_length = 0;
-    certificateManager->serializeCertificate(certificate, serialized_certificate, serialized_certificate_length);
-    X509_free(certificate);
-
+    if (CertificateManager::getInstance()->getServerCertificate(serialized_certificate,
+                                                                serialized_certificate_length) != 0) {
+        delete[] serialized_message;
+        delete[] serialized_server_ephemeral_key;
+        delete[] ciphertext;
+        delete[] ephemeral_key_buffer;
+        EVP_PKEY_free(client_public_key);
+        cerr << "Server certificate not found!" << endl;
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
 
     // Create AuthenticationM3 message and send it
     AuthenticationM3 authenticationM3(serialized_server_ephemeral_key,
                                       serialized_server_ephemeral_key_length, aesGcm.getIV(),
-                                      aad, tag, ciphertext,
+                                      aad, tag, ciphertext, ciphertext_length,
                                       serialized_certificate, serialized_certificate_length);
-    serialized_message = authenticationM3.serialize();
-    result = m_socket->send(serialized_message, authenticationM3.getMessageSize());
+    serialized_message = authenticationM3.serialize(key_exchange);
+    serialized_message_length = AuthenticationM3::getMessageSize(key_exchange);
+    result = m_socket->send(serialized_message, serialized_message_length);
     OPENSSL_cleanse(serialized_message, serialized_message_length);
-    delete[] serialized_certificate;
     delete[] serialized_server_ephemeral_key;
     delete[] ciphertext;
     if (result != 0) {
@@ -268,7 +361,7 @@ int Server::authenticationRequest() {
     unsigned char* decrypted_signature = nullptr;
     unsigned int decrypted_signature_length = aesGcm.decrypt(
             const_cast<unsigned char *>(authenticationM4.getMEncryptedDigitalSignature()),
-            ENCRYPTED_SIGNATURE_LEN * sizeof(uint8_t),
+            static_cast<int>(authenticationM4.getMEncryptedDigitalSignatureLen()),
             (unsigned char *) authenticationM4.getMAad(),
             Config::AAD_LEN, const_cast<unsigned char *>(authenticationM4.getMIv()),
             (unsigned char *) authenticationM4.getMTag(), decrypted_signature);
@@ -283,11 +376,11 @@ int Server::authenticationRequest() {
     }
 
     // Verify client's digital signature
-    bool isSignatureVerified = digitalSignatureManager.isDSverified(ephemeral_key_buffer,
-                                                                    ephemeral_key_buffer_length,
-                                                                    decrypted_signature,
-                                                                    decrypted_signature_length,
-                                                                    client_public_key);
+    bool isSignatureVerified = crypto_executor->run([&] {
+        return digitalSignatureManager.isDSverified(ephemeral_key_buffer, ephemeral_key_buffer_length,
+                                                    decrypted_signature, decrypted_signature_length,
+                                                    client_public_key) ? 1 : 0;
+    }) == 1;
     delete[] ephemeral_key_buffer;
     delete[] decrypted_signature;
     EVP_PKEY_free(client_public_key);
@@ -299,20 +392,22 @@ int Server::authenticationRequest() {
     }
 
     // AuthenticationM5
-    // Create a SimpleMessage with ACK/NACK code
+    // Create an AuthenticationM5 with ACK/NACK code, the chunk size and the cipher suite of the session
+    AuthenticationM5 authenticationM5(static_cast<uint8_t>(isSignatureVerified ? Result::ACK : Result::NACK),
+                                      chunk_size, static_cast<uint8_t>(cipher_suite));
     if (isSignatureVerified) {
-        simple_message.setMMessageCode(static_cast<int>(Result::ACK));
-    } else {
-        simple_message.setMMessageCode(static_cast<int>(Result::NACK));
+        m_chunk_size = chunk_size;
+        m_cipher_suite = cipher_suite;
     }
 
     // Determine the size of the plaintext and ciphertext
-    serialized_message_length = SimpleMessage::getMessageSize();
-    // Serialize the SimpleMessage to obtain a byte buffer
-    serialized_message = simple_message.serialize();
+    serialized_message_length = AuthenticationM5::getMessageSize();
+    // Serialize the AuthenticationM5 to obtain a byte buffer
+    serialized_message = authenticationM5.serialize();
     // Create a Generic message with the current counter value
     Generic generic_msg1(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
+    // Random IV: the counters of the handshake messages are used again after the reset
     if (generic_msg1.encrypt(m_session_key, serialized_message,
                              static_cast<int>(serialized_message_length)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
@@ -327,6 +422,15 @@ int Server::authenticationRequest() {
     }
 
     delete[] serialized_message;
+
+    // AuthenticationM6
+    // Issue a session ticket, used by the client to open its next sessions without the full handshake
+    if (isSignatureVerified) {
+        result = sendSessionTicket();
+        if (result != static_cast<int>(Return::SUCCESS)) {
+            return result;
+        }
+    }
     //incrementCounter();
     m_counter = 0;
 
@@ -340,6 +444,119 @@ int Server::authenticationRequest() {
     }
 }
 
+/**
+ * @brief Resume a session from the ticket issued to the client at the end of a previous full handshake.
+ * 1) Deserialize the ResumptionM1 message and unseal the ticket with the ticket key of the server
+ * 2) Check the ticket expiration time and that the user is still registered
+ * 3) Send a ResumptionM2 message with the result and a fresh server nonce
+ * 4) Derive the session key from the resumption secret of the ticket and the nonces of both peers, and restore
+ * the username and the chunk size of the session
+ * The client proves the knowledge of the resumption secret with its first request, which can be decrypted
+ * only with the derived session key.
+ *
+ * @param serialized_message The first message of the session, a ResumptionM1 message.
+ * @return An integer code indicating the result of the resumption.
+ */
+int Server::resumptionRequest(uint8_t *serialized_message) {
+    cout << "Resumption request received" << endl;
+    ResumptionM1 resumptionM1 = ResumptionM1::deserialize(serialized_message);
+    OPENSSL_cleanse(serialized_message, ResumptionM1::getMessageSize());
+    delete[] serialized_message;
+
+    // Unseal the ticket and check its validity
+    SessionTicket ticket;
+    bool is_ticket_valid = true;
+    if (SessionTicket::unseal(getTicketKey(), const_cast<uint8_t *>(resumptionM1.getMSealedTicket()), ticket) == -1) {
+        cerr << "Resumption - Invalid session ticket!" << endl;
+        is_ticket_valid = false;
+    } else if (ticket.getMExpirationTime() < static_cast<uint64_t>(time(nullptr))) {
+        cerr << "Resumption - Session ticket expired!" << endl;
+        is_ticket_valid = false;
+    } else if (!KeyRegistry::getInstance()->hasUser(ticket.getMUsername())) {
+        cerr << "Resumption - Username " << ticket.getMUsername() << " not found!" << endl;
+        is_ticket_valid = false;
+    }
+
+    // ResumptionM2
+    uint8_t server_nonce[RESUMPTION_NONCE_LEN];
+    RAND_bytes(server_nonce, RESUMPTION_NONCE_LEN);
+    ResumptionM2 resumptionM2(static_cast<uint8_t>(is_ticket_valid ? Result::ACK : Result::NACK), server_nonce);
+    serialized_message = resumptionM2.serialize();
+    int result = m_socket->send(serialized_message, ResumptionM2::getMessageSize());
+    delete[] serialized_message;
+    if (result != 0) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+    if (!is_ticket_valid) {
+        return static_cast<int>(Return::AUTHENTICATION_FAILURE);
+    }
+
+    // Restore the session from the ticket
+    SessionTicket::deriveSessionKey(ticket.getMResumptionSecret(), resumptionM1.getMClientNonce(), server_nonce,
+                                    m_session_key);
+    m_cipher_suite = negotiateCipherSuite(ticket.getMCipherSuite());
+    delete m_cipher;
+    m_cipher = new SessionCipher(m_session_key, SessionCipher::Role::SERVER, m_cipher_suite);
+    m_username = (string) ticket.getMUsername();
+    m_chunk_size = ticket.getMChunkSize();
+    m_counter = 0;
+    OPENSSL_cleanse(&ticket, sizeof(ticket));
+
+    cout << "Resumption request finished with code " << static_cast<int>(Return::AUTHENTICATION_SUCCESS) << endl;
+    return static_cast<int>(Return::AUTHENTICATION_SUCCESS);
+}
+
+/**
+ * @brief Issue a session ticket to the authenticated client and send it in an AuthenticationM6 message.
+ * The ticket contains the username, the chunk size, the cipher suite and a random resumption secret, and is sealed with the ticket
+ * key of the server, so that no per-client state is kept. The AuthenticationM6 message follows the
+ * AuthenticationM5 message, with the next counter value.
+ *
+ * @return An integer code indicating the result of the operation.
+ */
+int Server::sendSessionTicket() {
+    uint8_t resumption_secret[RESUMPTION_SECRET_LEN];
+    RAND_bytes(resumption_secret, RESUMPTION_SECRET_LEN);
+    SessionTicket ticket(m_username, resumption_secret,
+                         static_cast<uint64_t>(time(nullptr)) + Config::TICKET_LIFETIME, m_chunk_size,
+                         static_cast<uint8_t>(m_cipher_suite));
+    uint8_t *sealed_ticket = ticket.seal(getTicketKey());
+    OPENSSL_cleanse(&ticket, sizeof(ticket));
+    if (sealed_ticket == nullptr) {
+        OPENSSL_cleanse(resumption_secret, RESUMPTION_SECRET_LEN);
+        return static_cast<int>(Return::ENCRYPTION_FAILURE);
+    }
+
+    AuthenticationM6 authenticationM6(sealed_ticket, resumption_secret, Config::TICKET_LIFETIME);
+    delete[] sealed_ticket;
+    OPENSSL_cleanse(resumption_secret, RESUMPTION_SECRET_LEN);
+
+    size_t serialized_message_length = AuthenticationM6::getMessageSize();
+    uint8_t *serialized_message = authenticationM6.serialize();
+    Generic generic_message(m_counter + 1);
+    // Random IV: the counters of the handshake messages are used again after the reset
+    if (generic_message.encrypt(m_session_key, serialized_message,
+                                static_cast<int>(serialized_message_length)) == -1) {
+        return static_cast<int>(Return::ENCRYPTION_FAILURE);
+    }
+    serialized_message = generic_message.serialize();
+    int result = m_socket->send(serialized_message, Generic::getMessageSize(serialized_message_length));
+    delete[] serialized_message;
+    return result == 0 ? static_cast<int>(Return::SUCCESS) : static_cast<int>(Return::SEND_FAILURE);
+}
+
+/**
+ * @brief Get the key used to seal the session tickets, generated at the first use and kept only in memory.
+ * The tickets issued before a restart of the server are therefore rejected.
+ * @return The ticket key.
+ */
+unsigned char *Server::getTicketKey() {
+    static unsigned char ticket_key[Config::AES_KEY_LEN];
+    static once_flag ticket_key_flag;
+    call_once(ticket_key_flag, [] { RAND_bytes(ticket_key, Config::AES_KEY_LEN); });
+    return ticket_key;
+}
+
 /**
  * @brief Handles a request from a client to list files in the user's folder and sends the file list.
  *
@@ -383,7 +600,7 @@ int Server::listRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg2(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
-    if (generic_msg2.encrypt(m_session_key, serialized_message,
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,
                              static_cast<int>(list_msg2_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -417,7 +634,7 @@ int Server::listRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg3(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
-    if (generic_msg3.encrypt(m_session_key, serialized_message,
+    if (generic_msg3.encrypt(*m_cipher, serialized_message,
                              static_cast<int>(list_msg3_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -446,7 +663,8 @@ int Server::listRequest(uint8_t *plaintext) {
  *    a. If the file is found, sends DOWNLOAD_ACK with the file size.
  *    b. If the file is not found, sends FILE_NOT_FOUND with size 0.
  * 4. If the file is not found, the function ends; otherwise, proceeds to send file chunks.
- * 5. Sends file chunks (DownloadM3+i) to the client in sequential order.
+ * 5. Sends file chunks (DownloadM3+i) to the client in sequential order, through a DownloadPipeline that
+ *    overlaps reading, encryption and sending.
  *
  * @param plaintext The received message containing client's download request.
  * @return An integer code indicating the result of the server's handling of the request.
@@ -465,17 +683,21 @@ int Server::downloadRequest(uint8_t *plaintext) {
     // Send message DownloadM2
 
     // Obtain file path
-    string file_path = "../data/" + m_username + "/" + (string) download_msg1.getFilename();
+    string file_name = (string) download_msg1.getFilename();
+    string file_path = "../data/" + m_username + "/" + file_name;
     DownloadM2 download_msg2;
     FileManager *file_to_send;
     // Check if the file is present and correct
-    if (FileManager::isFilePresent(file_path) &&
+    if (FileManager::isValidFileName(file_name) && FileManager::isFilePresent(file_path) &&
         filesystem::is_regular_file(filesystem::path(file_path)) &&
         !filesystem::is_symlink(filesystem::path(file_path))) {
         // If the file is present create the message with DOWNLOAD_ACK and the file size
-        file_to_send = new FileManager(file_path, FileManager::OpenMode::READ);
+        file_to_send = new FileManager(file_path, FileManager::OpenMode::MAPPED_READ);
+        // The version of the file lets the client resume the download if it is interrupted
+        uint64_t version = 0;
+        FileManager::getVersion(file_path, version);
         download_msg2 = DownloadM2(static_cast<uint8_t>(Message::DOWNLOAD_ACK),
-                                   file_to_send->getFileSize());
+                                   file_to_send->getFileSize(), version);
     } else {
         // If the file is not present create the message with FILE_NOT_FOUND and size 0
         download_msg2 = DownloadM2(static_cast<uint8_t>(Error::FILE_NOT_FOUND), 0);
@@ -486,7 +708,7 @@ int Server::downloadRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg2(m_counter);
     // Encrypt the serialized plaintext and init the GenericMessage fields
-    if (generic_msg2.encrypt(m_session_key, serialized_message,
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,
                              static_cast<int>(download_msg2_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -507,10 +729,50 @@ int Server::downloadRequest(uint8_t *plaintext) {
     }
 
     // Send the message DownloadM3+i
+    file_to_send->initFileInfo(file_to_send->getFileSize(), m_chunk_size);
+    int result = sendFileChunks(file_to_send);
+    delete file_to_send;
+    return result;
+}
+
+
+/**
+ * @brief Send the chunks of a file (DownloadM3+i messages) from its current position.
+ *
+ * The chunks are read, encrypted and sent in a pipeline. The counter values of the chunks are assigned up
+ * front, so the pipeline is used only if the session key does not change during the transfer.
+ *
+ * @param file_to_send The file to send, with the file info initialized to the size of the data to send.
+ * @return An integer code indicating the result of the transfer.
+ */
+int Server::sendFileChunks(FileManager *file_to_send) {
+    auto chunks_num = static_cast<uint32_t>(file_to_send->getChunksNum());
+    if (chunks_num < SessionCipher::getRekeyInterval(m_chunk_size) - m_counter) {
+        DownloadPipeline pipeline(file_to_send, m_socket, m_cipher, m_counter);
+        int result = pipeline.run();
+        if (result != static_cast<int>(Return::SUCCESS)) {
+            return result;
+        }
+        m_counter += chunks_num;
+        return static_cast<int>(Return::SUCCESS);
+    }
 
-    // Define the chunk size and buffer
-    streamsize chunk_size = Config::CHUNK_SIZE;
-    auto *current_chunk = new uint8_t[chunk_size];
+    // Otherwise send the chunks one at a time, changing the session key when the counter reaches the interval
+    // Buffers of the Generic messages of a batch, allocated once: each chunk is read after the header and the
+    // message code of its message and encrypted in place
+    streamsize chunk_size = file_to_send->getChunkSize();
+    size_t max_message_len = Generic::getMessageSize(DownloadMi::getMessageSize(chunk_size));
+    vector<uint8_t *> message_buffers;
+    for (size_t j = 0; j < Config::CHUNKS_BATCH_LEN; j++) {
+        message_buffers.push_back(new uint8_t[max_message_len]);
+    }
+    auto release_message_buffers = [&message_buffers, max_message_len] {
+        for (uint8_t *message_buffer : message_buffers) {
+            OPENSSL_cleanse(message_buffer, max_message_len);
+            delete[] message_buffer;
+        }
+        message_buffers.clear();
+    };
 
     // Send each chunk of the file to the Client
     for (size_t i = 0; i < file_to_send->getChunksNum(); i++) {
@@ -520,44 +782,428 @@ int Server::downloadRequest(uint8_t *plaintext) {
         }
         // Send the message DownloadMi to the Client
 
-        // Read the current chunk from the file
-        if (file_to_send->readChunk(current_chunk, chunk_size) == -1) {
-            return static_cast<int>(Return::READ_CHUNK_FAILURE);
-        }
+        // Build the DownloadMi message in the buffer of its batch slot: message code and current chunk
+        uint8_t *generic_msg3i = message_buffers[i % Config::CHUNKS_BATCH_LEN];
         // Determine the size of the message
         size_t download_msg3i_len = DownloadMi::getMessageSize(chunk_size);
-        DownloadMi download_msg3i(current_chunk, chunk_size);
-        // Serialize the DownloadMi message to obtain a byte buffer
-        serialized_message = download_msg3i.serialize(chunk_size);
-        // Create a Generic message with the current counter value
-        Generic generic_msg3i(m_counter);
-        // Encrypt the serialized plaintext and init the GenericMessage fields
-        if (generic_msg3i.encrypt(m_session_key, serialized_message,
-                                  static_cast<int>(download_msg3i_len)) == -1) {
+        int ciphertext_len;
+        if (file_to_send->isMapped()) {
+            // Encrypt the DownloadMi reading the chunk straight from the mapping of the file
+            const uint8_t *chunk = file_to_send->mapChunk(chunk_size);
+            if (chunk == nullptr) {
+                release_message_buffers();
+                return static_cast<int>(Return::READ_CHUNK_FAILURE);
+            }
+            ciphertext_len = Generic::sealFrom(*m_cipher, m_counter, generic_msg3i,
+                                               static_cast<uint8_t>(Message::DOWNLOAD_CHUNK), chunk,
+                                               static_cast<size_t>(chunk_size));
+        } else {
+            uint8_t *download_msg3i = generic_msg3i + Generic::HEADER_LEN;
+            download_msg3i[0] = static_cast<uint8_t>(Message::DOWNLOAD_CHUNK);
+            if (file_to_send->readChunk(download_msg3i + sizeof(uint8_t), chunk_size) == -1) {
+                release_message_buffers();
+                return static_cast<int>(Return::READ_CHUNK_FAILURE);
+            }
+            // Encrypt the DownloadMi in place with the current counter value
+            ciphertext_len = Generic::sealInPlace(*m_cipher, m_counter, generic_msg3i, download_msg3i_len);
+        }
+        if (ciphertext_len == -1) {
+            release_message_buffers();
             return static_cast<int>(Return::ENCRYPTION_FAILURE);
         }
-        // Serialize Generic message
-        serialized_message = generic_msg3i.serialize();
-        if (m_socket->send(serialized_message,
-                           Generic::getMessageSize(download_msg3i_len)) == -1) {
-            delete[] serialized_message;
+        // Queue the Generic message, the batch is sent when full or at the last chunk
+        bool batch_over = (i + 1) % Config::CHUNKS_BATCH_LEN == 0 || i == static_cast<size_t>(file_to_send->getChunksNum()) - 1;
+        int result = m_socket->queueSend(generic_msg3i, Generic::getMessageSize(download_msg3i_len));
+        if (result == 0 && batch_over) {
+            result = m_socket->flush();
+        }
+        if (result != 0) {
+            release_message_buffers();
             return static_cast<int>(Return::SEND_FAILURE);
         }
-        delete[] serialized_message;
 
         incrementCounter();
     }
-    delete file_to_send;
+    release_message_buffers();
 
     // Return success code if the end of the function is reached
     return static_cast<int>(Return::SUCCESS);
 }
 
 
+/**
+ * @brief Handles a download range request, used by a client that downloads a file over several sessions.
+ *
+ * 1. Receives the client's request message (DownloadRangeM1) with the file name and the byte range.
+ * 2. Sends a DownloadM2 message with DOWNLOAD_ACK and the size of the whole file, or FILE_NOT_FOUND if the
+ *    file is not present or the range is out of the file.
+ * 3. Sends the chunks of the range (DownloadM3+i). A range of length 0 only asks for the file size.
+ *
+ * @param plaintext The received message containing client's download range request.
+ * @return An integer code indicating the result of the server's handling of the request.
+ */
+int Server::downloadRangeRequest(uint8_t *plaintext) {
+    // Receive message DownloadRangeM1
+    DownloadRangeM1 download_msg1 = DownloadRangeM1::deserialize(plaintext);
+    OPENSSL_cleanse(plaintext, Config::MAX_PACKET_SIZE);
+    delete[] plaintext;
+
+    incrementCounter();
+
+    // Check the file and the range
+    string file_name = (string) download_msg1.getFilename();
+    string file_path = "../data/" + m_username + "/" + file_name;
+    streamsize file_size = 0;
+    if (FileManager::isValidFileName(file_name) && FileManager::isFilePresent(file_path) &&
+        filesystem::is_regular_file(filesystem::path(file_path)) &&
+        !filesystem::is_symlink(filesystem::path(file_path))) {
+        file_size = FileManager::computeFileSize(file_path);
+    }
+    uint64_t range_end = static_cast<uint64_t>(download_msg1.getOffset()) + download_msg1.getLength();
+    bool range_valid = file_size > 0 && (download_msg1.getLength() == 0 || range_end <= static_cast<uint64_t>(file_size));
+
+    // The version of the file tells the client if its partial download can be resumed
+    uint64_t version = 0;
+    range_valid = range_valid && FileManager::getVersion(file_path, version) == 0;
+
+    // Send message DownloadM2
+    DownloadM2 download_msg2 = range_valid ?
+                               DownloadM2(static_cast<uint8_t>(Message::DOWNLOAD_ACK), file_size, version) :
+                               DownloadM2(static_cast<uint8_t>(Error::FILE_NOT_FOUND), 0);
+    int result = sendMessage(download_msg2.serialize(), DownloadM2::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+    if (!range_valid) {
+        return static_cast<int>(Return::FILE_NOT_FOUND);
+    }
+    if (download_msg1.getLength() == 0) {
+        return static_cast<int>(Return::SUCCESS);
+    }
+
+    // Send the messages DownloadM3+i of the range
+    FileManager file_to_send(file_path, FileManager::OpenMode::MAPPED_READ);
+    if (file_to_send.seek(download_msg1.getOffset()) == -1) {
+        return static_cast<int>(Return::READ_CHUNK_FAILURE);
+    }
+    file_to_send.initFileInfo(download_msg1.getLength(), m_chunk_size);
+    return sendFileChunks(&file_to_send);
+}
+
+
+/**
+ * Server side upload range request operation, used by a client that uploads a file over several sessions
+ * 1) Waits an upload range message from the client with file name, file size and byte range (UploadRangeM1)
+ * 2) Sends ACK if the range can be written (the file is new or is already being uploaded in ranges with the
+ * same size), NACK otherwise (SimpleMessage)
+ * 3) Waits for the chunks of the range inside M3+i messages and writes them at the range offset (UploadMi)
+ * 4) Sends the final response to the client after writing the range (SimpleMessage)
+ *
+ * @param plaintext The message containing the file name, the file size and the range
+ * @return An integer value representing the success or failure of the upload process.
+ */
+int Server::uploadRangeRequest(uint8_t *plaintext) {
+    // 1) Receive the upload range request message (UploadRangeM1 message)
+    UploadRangeM1 upload_msg1 = UploadRangeM1::deserializeUploadRangeM1(plaintext);
+    OPENSSL_cleanse(plaintext, UploadRangeM1::getSizeUploadRangeM1());
+    delete[] plaintext;
+
+    incrementCounter();
+
+    // 2) Join the range upload of the file and send the result (SimpleMessage)
+    string file_name = (string) upload_msg1.getFilename();
+    string file_path = "../data/" + m_username + "/" + file_name;
+    uint64_t range_end = static_cast<uint64_t>(upload_msg1.getOffset()) + upload_msg1.getLength();
+    bool accepted = FileManager::isValidFileName(file_name) && upload_msg1.getLength() > 0 &&
+                    range_end <= upload_msg1.getFileSize() &&
+                    beginRangeUpload(file_path, upload_msg1.getFileSize()) == 0;
+    if (!accepted) {
+        cout << "Server - Error during upload range request! Invalid name or range, or file already exists" << endl;
+    }
+    SimpleMessage upload_msg2(static_cast<uint8_t>(accepted ? Result::ACK : Result::NACK));
+    int result = sendMessage(upload_msg2.serialize(), SimpleMessage::getMessageSize());
+    if (result != static_cast<int>(Return::SUCCESS) || !accepted) {
+        if (accepted) {
+            endRangeUpload(file_path, upload_msg1.getOffset(), 0, false);
+        }
+        return accepted ? result : static_cast<int>(Error::FILENAME_ALREADY_EXISTS);
+    }
+
+    // 3) Receive the chunks of the range and write them at the range offset of the temporary file
+    FileManager file_to_upload(FileManager::getTemporaryPath(file_path), FileManager::OpenMode::UPDATE);
+    if (file_to_upload.seek(upload_msg1.getOffset()) == -1) {
+        result = static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+    } else {
+        file_to_upload.initFileInfo(upload_msg1.getLength(), m_chunk_size);
+        result = receiveFileChunks(file_to_upload, false);
+    }
+    file_to_upload.closeFile();
+    // The session completing the file also commits it
+    if (endRangeUpload(file_path, upload_msg1.getOffset(), upload_msg1.getLength(),
+                       result == static_cast<int>(Return::SUCCESS)) == -1 &&
+        result == static_cast<int>(Return::SUCCESS)) {
+        result = static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+    }
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        return result;
+    }
+
+    // 4) Send the final message (success range upload. Simple Message)
+    SimpleMessage upload_msg3i1(static_cast<uint8_t>(Result::ACK));
+    return sendMessage(upload_msg3i1.serialize(), SimpleMessage::getMessageSize());
+}
+
+
+/**
+ * @brief Register a session that uploads a whole file.
+ * @details An upload of the same file interrupted on another session is resumed if the file size and version match:
+ * the temporary file holds the chunks already received, all of them authenticated before being written.
+ * Otherwise the upload starts from the beginning with a new temporary file.
+ * A range upload of the same file with no range in progress is discarded: its client gave up on it.
+ * @param file_path The path of the file.
+ * @param file_size The size of the file.
+ * @param version The version of the file on the client, its modification time (0 if unknown, never resumed).
+ * @param offset Set to the number of bytes already received, from which the client resumes the upload.
+ * @return 0 if the file can be uploaded, -1 if it already exists or it is being uploaded.
+ */
+int Server::beginUpload(const string &file_path, uint32_t file_size, uint64_t version, uint32_t &offset) {
+    lock_guard<mutex> lock(m_range_uploads_mutex);
+    error_code error;
+    discardExpiredUploads();
+    if (FileManager::isFilePresent(file_path)) {
+        return -1;
+    }
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    auto range_upload = m_range_uploads.find(file_path);
+    if (range_upload != m_range_uploads.end()) {
+        if (range_upload->second.active_ranges != 0) {
+            return -1;
+        }
+        filesystem::remove(temporary_path, error);
+        m_range_uploads.erase(range_upload);
+    }
+    auto single_upload = m_single_uploads.find(file_path);
+    if (single_upload != m_single_uploads.end()) {
+        if (single_upload->second.active) {
+            return -1;
+        }
+        if (single_upload->second.file_size == file_size && version != 0 && single_upload->second.version == version &&
+            FileManager::isFilePresent(temporary_path)) {
+            streamsize bytes_received = FileManager::computeFileSize(temporary_path);
+            if (bytes_received <= static_cast<streamsize>(file_size)) {
+                single_upload->second.active = true;
+                offset = static_cast<uint32_t>(bytes_received);
+                return 0;
+            }
+        }
+        filesystem::remove(temporary_path, error);
+        m_single_uploads.erase(single_upload);
+    }
+    // The temporary file is created here, so that a file cannot be uploaded by two sessions at the same time
+    if (FileManager::allocateFile(temporary_path, 0) == -1) {
+        return -1;
+    }
+    m_single_uploads[file_path] = {file_size, version, true, chrono::steady_clock::now()};
+    offset = 0;
+    return 0;
+}
+
+/**
+ * @brief Unregister a session that uploaded a whole file.
+ * @param file_path The path of the file.
+ * @param keep_partial_file true if the upload has been interrupted and can be resumed, false if it is over
+ * (the file has been committed or its temporary file is removed).
+ */
+void Server::endUpload(const string &file_path, bool keep_partial_file) {
+    lock_guard<mutex> lock(m_range_uploads_mutex);
+    error_code error;
+    auto single_upload = m_single_uploads.find(file_path);
+    if (single_upload == m_single_uploads.end()) {
+        return;
+    }
+    if (keep_partial_file) {
+        single_upload->second.active = false;
+        single_upload->second.last_activity = chrono::steady_clock::now();
+        return;
+    }
+    filesystem::remove(FileManager::getTemporaryPath(file_path), error);
+    m_single_uploads.erase(single_upload);
+}
+
+/**
+ * @brief Register a session that uploads a range of a file.
+ * @details The first range creates the temporary file with its final size; the next ones join the same upload
+ * if the file size matches.
+ * @param file_path The path of the file.
+ * @param file_size The size of the whole file.
+ * @return 0 if the range can be written, -1 otherwise.
+ */
+int Server::beginRangeUpload(const string &file_path, uint32_t file_size) {
+    lock_guard<mutex> lock(m_range_uploads_mutex);
+    error_code error;
+    discardExpiredUploads();
+    // A single-session upload in progress excludes the range upload, an interrupted one is discarded
+    auto single_upload = m_single_uploads.find(file_path);
+    if (single_upload != m_single_uploads.end()) {
+        if (single_upload->second.active) {
+            return -1;
+        }
+        filesystem::remove(FileManager::getTemporaryPath(file_path), error);
+        m_single_uploads.erase(single_upload);
+    }
+    auto range_upload = m_range_uploads.find(file_path);
+    if (range_upload != m_range_uploads.end()) {
+        if (range_upload->second.file_size != file_size || range_upload->second.failed) {
+            return -1;
+        }
+        range_upload->second.active_ranges++;
+        return 0;
+    }
+    if (file_size == 0 || FileManager::isFilePresent(file_path) ||
+        FileManager::allocateFile(FileManager::getTemporaryPath(file_path), file_size) == -1) {
+        return -1;
+    }
+    m_range_uploads[file_path] = {file_size, {}, 1, false, chrono::steady_clock::now()};
+    return 0;
+}
+
+/**
+ * @brief Unregister a session that uploaded a range of a file.
+ * @details The upload is over when the received ranges cover the whole file, whatever their order and overlaps:
+ * the last session writing the file commits it, outside the lock so that the other range uploads are not blocked
+ * by the flush. If a range failed, the temporary file is removed as soon as no other session is writing it.
+ * @param file_path The path of the file.
+ * @param offset The offset of the range.
+ * @param length The length of the range.
+ * @param success true if the whole range has been written.
+ * @return 0 on success, -1 if the range failed or the complete file cannot be committed.
+ */
+int Server::endRangeUpload(const string &file_path, uint32_t offset, uint32_t length, bool success) {
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    error_code error;
+    {
+        lock_guard<mutex> lock(m_range_uploads_mutex);
+        auto range_upload = m_range_uploads.find(file_path);
+        if (range_upload == m_range_uploads.end()) {
+            return -1;
+        }
+        RangeUpload &upload = range_upload->second;
+        upload.active_ranges--;
+        upload.last_activity = chrono::steady_clock::now();
+        // The chunks are authenticated before being written, so a failed range does not damage the bytes of the
+        // other ranges: the upload fails only if it cannot be completed any more
+        bool complete = addReceivedRange(upload, offset, success ? length : 0);
+        if (!success && !complete) {
+            upload.failed = true;
+        }
+
+        // The file is committed by the last session writing it, once all its bytes have been received
+        if (!complete || upload.active_ranges != 0) {
+            if (upload.failed && upload.active_ranges == 0) {
+                filesystem::remove(temporary_path, error);
+                m_range_uploads.erase(range_upload);
+            }
+            return success ? 0 : -1;
+        }
+        m_range_uploads.erase(range_upload);
+    }
+
+    if (FileManager::commitFile(temporary_path, file_path) == -1) {
+        filesystem::remove(temporary_path, error);
+        return -1;
+    }
+    return success ? 0 : -1;
+}
+
+/**
+ * @brief Add a range written to the temporary file of a range upload, merging it with the ranges it overlaps
+ * or touches. An empty range only checks the coverage.
+ * @param upload The range upload.
+ * @param offset The offset of the range.
+ * @param length The length of the range.
+ * @return true if the received ranges now cover the whole file, false otherwise.
+ */
+bool Server::addReceivedRange(RangeUpload &upload, uint32_t offset, uint32_t length) {
+    map<uint32_t, uint32_t> &ranges = upload.received_ranges;
+    if (length != 0) {
+        uint32_t start = offset;
+        uint32_t end = offset + length;
+
+        auto next = ranges.upper_bound(start);
+        if (next != ranges.begin()) {
+            auto previous = prev(next);
+            if (previous->second >= start) {
+                start = previous->first;
+                end = max(end, previous->second);
+                ranges.erase(previous);
+            }
+        }
+        while (next != ranges.end() && next->first <= end) {
+            end = max(end, next->second);
+            next = ranges.erase(next);
+        }
+        ranges[start] = end;
+    }
+    return ranges.size() == 1 && ranges.begin()->first == 0 && ranges.begin()->second == upload.file_size;
+}
+
+/**
+ * @brief Discard the range uploads left without any session writing them and the interrupted single-session
+ * uploads not resumed for longer than Config::UPLOAD_EXPIRY, with their temporary files. Called with m_range_uploads_mutex held.
+ */
+void Server::discardExpiredUploads() {
+    auto now = chrono::steady_clock::now();
+    error_code error;
+    for (auto range_upload = m_range_uploads.begin(); range_upload != m_range_uploads.end();) {
+        if (range_upload->second.active_ranges == 0 &&
+            now - range_upload->second.last_activity > chrono::seconds(Config::UPLOAD_EXPIRY)) {
+            cout << "Server - Discarding the expired upload of " << range_upload->first << endl;
+            filesystem::remove(FileManager::getTemporaryPath(range_upload->first), error);
+            range_upload = m_range_uploads.erase(range_upload);
+        } else {
+            ++range_upload;
+        }
+    }
+    for (auto single_upload = m_single_uploads.begin(); single_upload != m_single_uploads.end();) {
+        if (!single_upload->second.active &&
+            now - single_upload->second.last_activity > chrono::seconds(Config::UPLOAD_EXPIRY)) {
+            cout << "Server - Discarding the interrupted upload of " << single_upload->first << endl;
+            filesystem::remove(FileManager::getTemporaryPath(single_upload->first), error);
+            single_upload = m_single_uploads.erase(single_upload);
+        } else {
+            ++single_upload;
+        }
+    }
+}
+
+
+/**
+ * @brief Encrypt a message with the current counter value and send it to the client, then increment the counter.
+ * @param serialized_message The serialized message, padded to its full size. It is deleted after the encryption.
+ * @param message_len The length of the serialized message.
+ * @return An integer code indicating the result of the operation.
+ */
+int Server::sendMessage(uint8_t *serialized_message, size_t message_len) {
+    Generic generic_message(m_counter);
+    if (generic_message.encrypt(*m_cipher, serialized_message, static_cast<int>(message_len)) == -1) {
+        return static_cast<int>(Return::ENCRYPTION_FAILURE);
+    }
+    iovec buffers[Generic::BUFFERS_NUM];
+    generic_message.getBuffers(buffers);
+    if (m_socket->send(buffers, Generic::BUFFERS_NUM) == -1) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+
+    incrementCounter();
+    return static_cast<int>(Return::SUCCESS);
+}
+
+
 /**
  * Server side upload request operation
  * 1) Waits an upload message request from the client specifying file name and file size (UploadM1 message type)
- * 2) Send a response to the client indicating the success or failure of the upload request (SimpleMessage)
+ * 2) Send a response to the client indicating the success or failure of the upload request and the offset from
+ * which the file is uploaded, not 0 when an interrupted upload of the same version of the file is resumed (UploadM2)
  * 3) Wait for the chunks inside M3+i messages and write into the file (UploadMi Message)
  * 4) Send the final response to the client after writing all file chunks in the file, indicating the overall success
  * or failure of the file upload (SimpleMessage)
@@ -577,33 +1223,48 @@ int Server::uploadRequest(uint8_t *plaintext) {
     incrementCounter();
 
 
-    // 2) Send the success message (if file does not exist) or fail message (if file exist) M2 (SimpleMessage)
-    SimpleMessage upload_msg2;
+    // 2) Send the success message (if file does not exist) or fail message (if file exist) M2 (UploadM2), with
+    // the bytes already received if the upload resumes an interrupted one
+    UploadM2 upload_msg2;
     // Check if the file already exists, otherwise create the message to send
-    string file_path = "../data/" + m_username + "/" + (string)upload_msg1.getFilename();
-    if (FileManager::isFilePresent(file_path)) {
+    string file_name = (string)upload_msg1.getFilename();
+    string file_path = "../data/" + m_username + "/" + file_name;
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    uint32_t offset = 0;
+    if (!FileManager::isValidFileName(file_name)) {
+        cout << "Server - Error during upload request! Invalid file name" << endl;
+        upload_msg2 = UploadM2(static_cast<uint8_t>(Result::NACK), 0);
+    }
+    else if (beginUpload(file_path, upload_msg1.getFileSize(), upload_msg1.getVersion(), offset) == -1) {
         cout << "Server - Error during upload request! File already exists" << endl;
-        upload_msg2 = SimpleMessage(static_cast<uint8_t>(Result::NACK));
+        upload_msg2 = UploadM2(static_cast<uint8_t>(Result::NACK), 0);
     }
     else {
         // Create success message to send to the Client
-        upload_msg2 = SimpleMessage(static_cast<uint8_t>(Result::ACK));
+        upload_msg2 = UploadM2(static_cast<uint8_t>(Result::ACK), offset);
     }
 
     // Serialize the message to send to the Client
-    uint8_t* serialized_message = upload_msg2.serialize();
+    uint8_t* serialized_message = upload_msg2.serializeUploadM2();
     // Determine the size of the message to send
-    size_t upload_msg2_len = SimpleMessage::getMessageSize();
+    size_t upload_msg2_len = UploadM2::getSizeUploadM2();
 
     // Create a Generic message with the current counter value
     Generic generic_msg2(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg2.encrypt(m_session_key, serialized_message,static_cast<int>(upload_msg2_len)) == -1) {
+    bool accepted = upload_msg2.getMessageCode() == static_cast<uint8_t>(Result::ACK);
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,static_cast<int>(upload_msg2_len)) == -1) {
+        if (accepted) {
+            endUpload(file_path, true);
+        }
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
-    // Serialize and Send Generic message (SimpleMessage)
+    // Serialize and Send Generic message (UploadM2)
     serialized_message = generic_msg2.serialize();
     if (m_socket->send(serialized_message,Generic::getMessageSize(upload_msg2_len)) == -1) {
+        if (accepted) {
+            endUpload(file_path, true);
+        }
         return static_cast<int>(Return::SEND_FAILURE);
     }
 
@@ -613,25 +1274,90 @@ int Server::uploadRequest(uint8_t *plaintext) {
     // Increment counter against replay attack
     incrementCounter();
 
-    if (upload_msg2.getMMessageCode() == static_cast<uint8_t>(Result::NACK)) {
+    if (!accepted) {
         return static_cast<int>(Error::FILENAME_ALREADY_EXISTS);
     }
 
-
     //3) Receive the file chunks messages M3+i from the Client (UploadMi)
-    // Prepare the file reception
-    FileManager file_to_upload(file_path, FileManager::OpenMode::WRITE);
-    size_t file_size = upload_msg1.getFileSize();
-    file_to_upload.initFileInfo(file_size);
+    // Prepare the file reception in the temporary file from the resume offset; the file is renamed once
+    // complete and flushed
+    FileManager file_to_upload(temporary_path, FileManager::OpenMode::UPDATE);
+    int result = static_cast<int>(Return::SUCCESS);
+    if (file_to_upload.seek(offset) == -1) {
+        result = static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+    } else {
+        file_to_upload.initFileInfo(upload_msg1.getFileSize() - offset, m_chunk_size);
+        result = receiveFileChunks(file_to_upload, true);
+    }
+    file_to_upload.closeFile();
+    if (result != static_cast<int>(Return::SUCCESS)) {
+        // The chunks received so far are kept, the client can resume the upload from them
+        endUpload(file_path, true);
+        return result;
+    }
+    if (FileManager::commitFile(temporary_path, file_path) == -1) {
+        endUpload(file_path, false);
+        return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
+    }
+    endUpload(file_path, false);
+
+    // 4) Send the final packet M3+i+1 message (success file upload. Simple Message)
+    SimpleMessage upload_msg3i1 = SimpleMessage(static_cast<uint8_t>(Result::ACK));
+
+    // Serialize the message to send to the Client
+    serialized_message = upload_msg3i1.serialize();
+    // Determine the size of the message to send
+    size_t upload_msg3i1_len = SimpleMessage::getMessageSize();
+
+    // Create a Generic message with the current counter value
+    Generic generic_msg3i1(m_counter);
+    // Encrypt the serialized plaintext and init the Generic message fields
+    if (generic_msg3i1.encrypt(*m_cipher, serialized_message,static_cast<int>(upload_msg3i1_len)) == -1) {
+        return static_cast<int>(Return::ENCRYPTION_FAILURE);
+    }
+    // Serialize and Send Generic message (SimpleMessage)
+    serialized_message = generic_msg3i1.serialize();
+    if (m_socket->send(serialized_message,Generic::getMessageSize(upload_msg3i1_len)) == -1) {
+        return static_cast<int>(Return::SEND_FAILURE);
+    }
+
+    //Free the memory allocated for UploadM1 message
+    delete[] serialized_message;
 
+    // Increment counter against replay attack
+    incrementCounter();
+
+
+    // Successful upload
+    return static_cast<int>(Return::SUCCESS);
+}
+
+
+/**
+ * @brief Receive the chunks of a file (UploadM3+i messages) and write them from the current file position.
+ *
+ * @param file_to_upload The file to write, with the file info initialized to the size of the data to receive.
+ * @param show_progress true to print the progress of the transfer.
+ * @return An integer code indicating the result of the transfer.
+ */
+int Server::receiveFileChunks(FileManager &file_to_upload, bool show_progress) {
     // Compute the chunk size and upload state variable to check the received size
-    size_t chunk_size = Config::CHUNK_SIZE;
+    size_t chunk_size = file_to_upload.getChunkSize();
+    size_t file_size = file_to_upload.getFileSize();
     streamsize bytes_received = 0;
 
     // Set an interval for progress updates (e.g., every 10%)
     const int progressUpdateInterval = 1;
     int lastPrintedProgress = -1;
 
+    // Buffer receiving the Generic messages, allocated once and decrypted in place
+    size_t max_message_len = Generic::getMessageSize(UploadMi::getSizeUploadMi(static_cast<int>(chunk_size)));
+    auto *generic_msg3i = new uint8_t[max_message_len];
+    auto release_message_buffer = [generic_msg3i, max_message_len] {
+        OPENSSL_cleanse(generic_msg3i, max_message_len);
+        delete[] generic_msg3i;
+    };
+
 
     // Receive all file chunks and write to the file
     for (size_t i = 0; i < file_to_upload.getChunksNum(); ++i) {
@@ -645,31 +1371,23 @@ int Server::uploadRequest(uint8_t *plaintext) {
         size_t upload_msg3i_len = UploadMi::getSizeUploadMi(chunk_size);
         size_t generic_msg3i_len = Generic::getMessageSize(upload_msg3i_len);
 
-        // Allocate memory for the buffer to receive the Generic message
-        serialized_message = new uint8_t[generic_msg3i_len];
-        if (m_socket->receive(serialized_message, generic_msg3i_len) == -1) {
-            delete[] serialized_message;
+        // Receive the Generic message in the buffer
+        if (m_socket->receive(generic_msg3i, generic_msg3i_len) != 0) {
+            release_message_buffer();
             return static_cast<int>(Return::RECEIVE_FAILURE);
         }
 
-        // Deserialize the received Generic message
-        Generic generic_msg3i = Generic::deserialize(serialized_message, upload_msg3i_len);
-        delete[] serialized_message;
-        // Allocate memory for the plaintext buffer
-        plaintext = new uint8_t[upload_msg3i_len];
-        // Decrypt the Generic message to obtain the serialized message
-        if (generic_msg3i.decrypt(m_session_key, plaintext) == -1) {
+        // Decrypt the Generic message in place: the upload message 3+i (UploadMi) follows the header
+        uint32_t counter;
+        if (Generic::openInPlace(*m_cipher, generic_msg3i, upload_msg3i_len, counter) == -1) {
+            release_message_buffer();
             return static_cast<int>(Return::DECRYPTION_FAILURE);
         }
-
-        // Deserialize the upload message 3+i received (UploadMi)
-        UploadMi upload_msg3i = UploadMi::deserializeUploadMi(plaintext, chunk_size);
-        // Safely clean plaintext buffer
-        OPENSSL_cleanse(plaintext, upload_msg3i_len);
-        delete[] plaintext;
+        uint8_t *upload_msg3i = generic_msg3i + Generic::HEADER_LEN;
 
         // Check the counter value to prevent replay attacks
-        if (m_counter != generic_msg3i.getCounter()) {
+        if (m_counter != counter) {
+            release_message_buffer();
             return static_cast<int>(Return::WRONG_COUNTER);
         }
 
@@ -677,12 +1395,16 @@ int Server::uploadRequest(uint8_t *plaintext) {
         incrementCounter();
 
 
-        // Write the received chunk in the file
-        if (file_to_upload.writeChunk(upload_msg3i.getChunk(), chunk_size) == -1) {
+        // Write the received chunk (following the message code) in the file
+        if (file_to_upload.writeChunk(upload_msg3i + sizeof(uint8_t), static_cast<streamsize>(chunk_size)) == -1) {
+            release_message_buffer();
             return static_cast<int>(Return::WRITE_CHUNK_FAILURE);
         }
 
         // Compute and show the progress to the user
+        if (!show_progress) {
+            continue;
+        }
         // Calculate upload progress percentage
         bytes_received += chunk_size;
         int newProgress = static_cast<int>((static_cast<double>(bytes_received) / static_cast<double>(file_size)) * 100);
@@ -693,41 +1415,16 @@ int Server::uploadRequest(uint8_t *plaintext) {
             lastPrintedProgress = newProgress;
         }
     }
+    release_message_buffer();
     // Clear the progress message after completion
-    cout << "\rServer - Uploading: 100% complete" << endl;
-
-
-    // 4) Send the final packet M3+i+1 message (success file upload. Simple Message)
-    SimpleMessage upload_msg3i1 = SimpleMessage(static_cast<uint8_t>(Result::ACK));
-
-    // Serialize the message to send to the Client
-    serialized_message = upload_msg3i1.serialize();
-    // Determine the size of the message to send
-    size_t upload_msg3i1_len = SimpleMessage::getMessageSize();
-
-    // Create a Generic message with the current counter value
-    Generic generic_msg3i1(m_counter);
-    // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg3i1.encrypt(m_session_key, serialized_message,static_cast<int>(upload_msg3i1_len)) == -1) {
-        return static_cast<int>(Return::ENCRYPTION_FAILURE);
-    }
-    // Serialize and Send Generic message (SimpleMessage)
-    serialized_message = generic_msg3i1.serialize();
-    if (m_socket->send(serialized_message,Generic::getMessageSize(upload_msg3i1_len)) == -1) {
-        return static_cast<int>(Return::SEND_FAILURE);
+    if (show_progress) {
+        cout << "\rServer - Uploading: 100% complete" << endl;
     }
-
-    //Free the memory allocated for UploadM1 message
-    delete[] serialized_message;
-
-    // Increment counter against replay attack
-    incrementCounter();
-
-
-    // Successful upload
     return static_cast<int>(Return::SUCCESS);
 }
 
+
+
 /**
  * @brief Handle a file rename request on the server side.
  *
@@ -753,13 +1450,18 @@ int Server::renameRequest(uint8_t *plaintext) {
     //RenameM2
 
     // Obtain file path
-    string old_file_name_path = "../data/" + m_username + "/" + (string) renameM1.getMOldFilename();
-    string new_file_name_path = "../data/" + m_username + "/" + (string) renameM1.getMNewFilename();
+    string old_file_name = (string) renameM1.getMOldFilename();
+    string new_file_name = (string) renameM1.getMNewFilename();
+    string old_file_name_path = "../data/" + m_username + "/" + old_file_name;
+    string new_file_name_path = "../data/" + m_username + "/" + new_file_name;
     SimpleMessage simple_message;
     // Check if the file is present and correct
-    if (!FileManager::isFilePresent(old_file_name_path)){
+    if (!FileManager::isValidFileName(old_file_name) || !FileManager::isFilePresent(old_file_name_path)){
         // If the file is not present create the message with FILE_NOT_FOUND
         simple_message = SimpleMessage(static_cast<uint8_t>(Return::FILE_NOT_FOUND));
+    } else if (!FileManager::isValidFileName(new_file_name)) {
+        // The new name would leave the directory of the user or collide with a file being uploaded
+        simple_message = SimpleMessage(static_cast<int>(Result::NACK));
     } else if (FileManager::isFilePresent(new_file_name_path)) {
         // If the file is already present create the message with FILE_ALREADY_EXISTS
         simple_message = SimpleMessage(static_cast<uint8_t>(Return::FILE_ALREADY_EXISTS));
@@ -776,7 +1478,7 @@ int Server::renameRequest(uint8_t *plaintext) {
 
     Generic generic_msg2(m_counter);
 
-    if (generic_msg2.encrypt(m_session_key, serialized_message,
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,
                              static_cast<int>(simple_message_length)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
@@ -830,7 +1532,7 @@ int Server::deleteRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg2(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg2.encrypt(m_session_key, serialized_message,static_cast<int>(delete_msg2_len)) == -1) {
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,static_cast<int>(delete_msg2_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (SimpleMessage)
@@ -863,7 +1565,7 @@ int Server::deleteRequest(uint8_t *plaintext) {
     // Allocate memory for the plaintext buffer
     plaintext = new uint8_t[delete_msg3_len];
     // Decrypt the Generic message to obtain the serialized message
-    if (generic_msg3.decrypt(m_session_key, plaintext) == -1) {
+    if (generic_msg3.decrypt(*m_cipher, plaintext) == -1) {
         return static_cast<int>(Return::DECRYPTION_FAILURE);
     }
 
@@ -891,7 +1593,7 @@ int Server::deleteRequest(uint8_t *plaintext) {
     string file_path = "../data/" + m_username + "/";
 
     // Check if the file with file_name exists
-    if (!FileManager::isFilePresent(file_path+file_name)) {
+    if (!FileManager::isValidFileName(file_name) || !FileManager::isFilePresent(file_path+file_name)) {
         return static_cast<int>(Error::FILENAME_NOT_FOUND);
     }
 
@@ -912,7 +1614,7 @@ int Server::deleteRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg4(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg4.encrypt(m_session_key, serialized_message,static_cast<int>(delete_msg4_len)) == -1) {
+    if (generic_msg4.encrypt(*m_cipher, serialized_message,static_cast<int>(delete_msg4_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
     // Serialize and Send Generic message (SimpleMessage)
@@ -961,7 +1663,7 @@ int Server::logoutRequest(uint8_t *plaintext) {
     // Create a Generic message with the current counter value
     Generic generic_msg2(m_counter);
     // Encrypt the serialized plaintext and init the Generic message fields
-    if (generic_msg2.encrypt(m_session_key, serialized_message,static_cast<int>(logout_msg2_len)) == -1) {
+    if (generic_msg2.encrypt(*m_cipher, serialized_message,static_cast<int>(logout_msg2_len)) == -1) {
         return static_cast<int>(Return::ENCRYPTION_FAILURE);
     }
 
@@ -982,94 +1684,194 @@ int Server::logoutRequest(uint8_t *plaintext) {
     return static_cast<int>(Return::SUCCESS);
 }
 
-void Server::run() {
+/**
+ * @brief Authenticate the client connected to the session socket.
+ *
+ * @return 0 if the client has been authenticated, -1 otherwise.
+ */
+int Server::authenticate() {
     try {
         // Perform login
         int result = authenticationRequest();
         if (result != static_cast<int>(Return::AUTHENTICATION_SUCCESS)) {
             cout << "Server - Error! Login failed with error code: " << result << endl;
-            return;
+            return -1;
         }
+        return 0;
+    } catch (int error_code) {
+        cout << "Server - Operation failed with error code: " << error_code << endl;
+    } catch (const exception &e) {
+        cerr << "Server - Exception in authenticate: " << e.what() << endl;
+    }
+    return -1;
+}
+
+/**
+ * @brief Receive the next request of the authenticated client and decrypt it, without serving it.
+ *
+ * @return 0 on success, -1 if the session is over (connection closed or unrecoverable error).
+ */
+int Server::receiveRequest() {
+    try {
         // Determine the expected size of the message buffer
         size_t message_size = Generic::getMessageSize(Config::MAX_PACKET_SIZE);
-      
-        while (true) {
-            // Allocate memory for the buffer to receive the first message
-            auto *serialized_message = new uint8_t[message_size];
-            result = m_socket->receive(serialized_message, message_size);
-            if (result == -1) {
-                delete[] serialized_message;
-                cout << "Server - Error! Receive failed" << endl;
-                return;
-            }
-            if (result == -2) {
-                delete[] serialized_message;
-                cout << "Server - Connection Closed with user " << m_username << endl;
-                return;
-            }
-            // Deserialize the received message
-            Generic generic_message = Generic::deserialize(serialized_message,
-                                                           Config::MAX_PACKET_SIZE);
+
+        // Allocate memory for the buffer to receive the first message
+        auto *serialized_message = new uint8_t[message_size];
+        int result = m_socket->receive(serialized_message, message_size);
+        if (result == -1) {
+            delete[] serialized_message;
+            cout << "Server - Error! Receive failed" << endl;
+            return -1;
+        }
+        if (result == -2) {
             delete[] serialized_message;
-            // Allocate memory for the plaintext
-            auto *plaintext = new uint8_t[Config::MAX_PACKET_SIZE];
+            cout << "Server - Connection Closed with user " << m_username << endl;
+            return -1;
+        }
+        // Deserialize the received message
+        Generic generic_message = Generic::deserialize(serialized_message,
+                                                       Config::MAX_PACKET_SIZE);
+        delete[] serialized_message;
+        // Allocate memory for the plaintext, released by the handler of the request
+        delete[] m_request;
+        m_request = new uint8_t[Config::MAX_PACKET_SIZE];
 
-            // Decrypt the received ciphertext
-            if (generic_message.decrypt(m_session_key, plaintext) == -1) {
-                return;
-            }
-            // Check the counter value to prevent replay attacks
-            if (m_counter != generic_message.getCounter()) {
-                throw static_cast<int>(Return::WRONG_COUNTER);
-            }
-            // Taking the command code as the first byte of plaintext
-            uint8_t command = plaintext[0];
-
-            switch (command) {
-                case static_cast<uint8_t>(Message::LIST_REQUEST):
-                    cout << "Server - List request received" << endl;
-                    result = listRequest(plaintext);
-                    cout << "Server - List request finished with code " << result << endl;
-                    break;
-
-                case static_cast<uint8_t>(Message::DOWNLOAD_REQUEST):
-                    cout << "Server - Download request received" << endl;
-                    result = downloadRequest(plaintext);
-                    cout << "Server - Download request finished with code " << result << endl;
-                    break;
-
-                case static_cast<uint8_t>(Message::UPLOAD_REQUEST):
-                    cout << "Server - Upload request received" << endl;
-                    result = uploadRequest(plaintext);
-                    cout << "Server - Upload request finished with code " << result << endl;
-                    break;
-
-                case static_cast<uint8_t>(Message::RENAME_REQUEST):
-                    cout << "Server - Rename request received" << endl;
-                    result = renameRequest(plaintext);
-                    cout << "Server - Rename request finished with code " << result << endl;
-                    break;
-
-                case static_cast<uint8_t>(Message::DELETE_REQUEST):
-                    cout << "Server - Delete request received" << endl;
-                    result = deleteRequest(plaintext);
-                    cout << "Server - Delete request finished with code " << result << endl;
-                    break;
-
-                case static_cast<uint8_t>(Message::LOGOUT_REQUEST):
-                    cout << "Server - Logout request received" << endl;
-                    result = logoutRequest(plaintext);
-                    cout << "Server - Logout request finished with code " << result << endl;
-                    break;
-
-                default:
-                    cerr << "Server - Invalid command received." << endl;
-                    break;
-            }
+        // Decrypt the received ciphertext
+        if (generic_message.decrypt(*m_cipher, m_request) == -1) {
+            return -1;
+        }
+        // Check the counter value to prevent replay attacks
+        if (m_counter != generic_message.getCounter()) {
+            throw static_cast<int>(Return::WRONG_COUNTER);
+        }
+        return 0;
+    } catch (int error_code) {
+        cout << "Server - Operation failed with error code: " << error_code << endl;
+    } catch (const exception &e) {
+        cerr << "Server - Exception in receiveRequest: " << e.what() << endl;
+    }
+    return -1;
+}
+
+/**
+ * @brief Check if the request received by receiveRequest() transfers a file, so it can take a long time.
+ *
+ * @return true for the download and upload requests, whole or in ranges, false otherwise.
+ */
+bool Server::isTransferRequest() const {
+    if (m_request == nullptr) {
+        return false;
+    }
+    switch (m_request[0]) {
+        case static_cast<uint8_t>(Message::DOWNLOAD_REQUEST):
+        case static_cast<uint8_t>(Message::UPLOAD_REQUEST):
+        case static_cast<uint8_t>(Message::DOWNLOAD_RANGE_REQUEST):
+        case static_cast<uint8_t>(Message::UPLOAD_RANGE_REQUEST):
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Serve the request received by receiveRequest().
+ *
+ * @return 0 if the session can continue with another request, -1 if the session is over
+ * (logout or unrecoverable error).
+ */
+int Server::serveRequest() {
+    // The handlers take the ownership of the plaintext
+    uint8_t *plaintext = m_request;
+    m_request = nullptr;
+    try {
+        int result;
+        switch (plaintext[0]) {
+            case static_cast<uint8_t>(Message::LIST_REQUEST):
+                cout << "Server - List request received" << endl;
+                result = listRequest(plaintext);
+                cout << "Server - List request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::DOWNLOAD_REQUEST):
+                cout << "Server - Download request received" << endl;
+                result = downloadRequest(plaintext);
+                cout << "Server - Download request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::UPLOAD_REQUEST):
+                cout << "Server - Upload request received" << endl;
+                result = uploadRequest(plaintext);
+                cout << "Server - Upload request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::DOWNLOAD_RANGE_REQUEST):
+                cout << "Server - Download range request received" << endl;
+                result = downloadRangeRequest(plaintext);
+                cout << "Server - Download range request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::UPLOAD_RANGE_REQUEST):
+                cout << "Server - Upload range request received" << endl;
+                result = uploadRangeRequest(plaintext);
+                cout << "Server - Upload range request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::RENAME_REQUEST):
+                cout << "Server - Rename request received" << endl;
+                result = renameRequest(plaintext);
+                cout << "Server - Rename request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::DELETE_REQUEST):
+                cout << "Server - Delete request received" << endl;
+                result = deleteRequest(plaintext);
+                cout << "Server - Delete request finished with code " << result << endl;
+                break;
+
+            case static_cast<uint8_t>(Message::LOGOUT_REQUEST):
+                cout << "Server - Logout request received" << endl;
+                result = logoutRequest(plaintext);
+                cout << "Server - Logout request finished with code " << result << endl;
+                // The client opens a new connection for the next login
+                return -1;
+
+            default:
+                cerr << "Server - Invalid command received." << endl;
+                delete[] plaintext;
+                break;
         }
+        return 0;
     } catch (int error_code) {
         cout << "Server - Operation failed with error code: " << error_code << endl;
     } catch (const exception &e) {
-        cerr << "Server - Exception in run: " << e.what() << endl;
+        cerr << "Server - Exception in serveRequest: " << e.what() << endl;
     }
-}
\ No newline at end of file
+    return -1;
+}
+
+/**
+ * @brief Receive a single request from the authenticated client and serve it.
+ *
+ * @return 0 if the session can continue with another request, -1 if the session is over
+ * (connection closed, logout or unrecoverable error).
+ */
+int Server::handleRequest() {
+    if (receiveRequest() != 0) {
+        return -1;
+    }
+    return serveRequest();
+}
+
+/**
+ * @brief Serve the whole client session on the calling thread: authenticate the client and then
+ * handle its requests until the session is over.
+ */
+void Server::run() {
+    if (authenticate() != 0) {
+        return;
+    }
+    // The client may think for any time before its next request, the timeouts only bound the requests
+    while (m_socket->waitForMessage() == 0 && handleRequest() == 0) {
+    }
+}
@@ -1,25 +1,94 @@
 #ifndef SECURE_CLOUD_STORAGE_SERVER_H
 #define SECURE_CLOUD_STORAGE_SERVER_H
 
+#include <chrono>
+#include <map>
+#include <mutex>
 #include "SocketManager.h"
+#include "FileManager.h"
 #include "Config.h"
+#include "SessionCipher.h"
 
 class Server {
 
 private:
+    // State of a file uploaded in ranges over several sessions
+    struct RangeUpload {
+        uint32_t file_size;
+        // Byte ranges written to the temporary file, merged and keyed by their start offset
+        map<uint32_t, uint32_t> received_ranges;
+        unsigned int active_ranges;
+        bool failed;
+        // Time the last range ended, the upload is discarded if no range arrives for Config::UPLOAD_EXPIRY
+        chrono::steady_clock::time_point last_activity;
+    };
+
+    // State of a file uploaded on a single session, kept when the upload is interrupted so that it can be resumed
+    struct SingleUpload {
+        uint32_t file_size;
+        uint64_t version;
+        bool active;
+        // Time the upload was interrupted, its temporary file is discarded after Config::UPLOAD_EXPIRY
+        chrono::steady_clock::time_point last_activity;
+    };
+
+    // Range uploads in progress, shared by all the sessions and keyed by file path
+    static map<string, RangeUpload> m_range_uploads;
+    static mutex m_range_uploads_mutex;
+    // Single-session uploads in progress or interrupted, keyed by file path and guarded by m_range_uploads_mutex
+    static map<string, SingleUpload> m_single_uploads;
+
     string m_username;
     uint32_t m_counter{};
     SocketManager *m_socket;
     unsigned char m_session_key[Config::AES_KEY_LEN];
+    SessionCipher *m_cipher = nullptr;
+    uint32_t m_chunk_size = Config::CHUNK_SIZE;
+    CipherSuite m_cipher_suite = CipherSuite::AES_128_GCM;
+    // Plaintext of the request received by receiveRequest() and not served yet
+    uint8_t *m_request = nullptr;
 
     int authenticationRequest();
 
+    int resumptionRequest(uint8_t *serialized_message);
+
+    int sendSessionTicket();
+
+    static unsigned char *getTicketKey();
+
+    static uint32_t negotiateChunkSize(uint32_t requested_chunk_size);
+
+    static CipherSuite negotiateCipherSuite(uint8_t requested_suite);
+
     int listRequest(uint8_t *plaintext);
 
     int downloadRequest(uint8_t *plaintext);
 
     int uploadRequest(uint8_t *plaintext);
 
+    int downloadRangeRequest(uint8_t *plaintext);
+
+    int uploadRangeRequest(uint8_t *plaintext);
+
+    int sendFileChunks(FileManager *file_to_send);
+
+    int receiveFileChunks(FileManager &file_to_upload, bool show_progress);
+
+    int sendMessage(uint8_t *serialized_message, size_t message_len);
+
+
+    static int beginUpload(const string &file_path, uint32_t file_size, uint64_t version, uint32_t &offset);
+
+    static void endUpload(const string &file_path, bool keep_partial_file);
+
+    static int beginRangeUpload(const string &file_path, uint32_t file_size);
+
+    static int endRangeUpload(const string &file_path, uint32_t offset, uint32_t length, bool success);
+
+    static bool addReceivedRange(RangeUpload &upload, uint32_t offset, uint32_t length);
+
+    static void discardExpiredUploads();
+
     int renameRequest(uint8_t *plaintext);
 
     int deleteRequest(uint8_t *plaintext);
@@ -27,6 +96,7 @@ private:
     int logoutRequest(uint8_t *plaintext);
 
     void incrementCounter();
+    void rekey();
 
 
 public:
@@ -34,6 +104,16 @@ public:
 
     ~Server();
 
+    int authenticate();
+
+    int receiveRequest();
+
+    bool isTransferRequest() const;
+
+    int serveRequest();
+
+    int handleRequest();
+
     void run();
 };
 
@@ -1,9 +1,18 @@
 #include "ServerMain.h"
 #include <iostream>
 #include <csignal>
+#include <functional>
+#include <pthread.h>
+#include <sys/socket.h>
 #include "Config.h"
 #include "CertificateManager.h"
+#include "CryptoExecutor.h"
+#include "EphemeralKeyPool.h"
+#include "KeyRegistry.h"
+#include "FileManager.h"
 #include "Server.h"
+#include "Reactor.h"
+#include "SyncManager.h"
 
 using namespace std;
 
@@ -17,6 +26,18 @@ ServerMain::ServerMain(){
         // Create a new SocketManager instance with specified configurations
         m_socket_manager = new SocketManager(Config::SERVER_IP, Config::SERVER_PORT,
                                              Config::MAX_REQUESTS);
+        // Load the keys and the certificate and start filling the pool of ephemeral keys before the first connection
+        KeyRegistry::getInstance();
+        // No upload is in progress: remove the temporary files of the uploads interrupted by a crash
+        FileManager::removeTemporaryFiles("../data");
+        const uint8_t* serialized_certificate = nullptr;
+        int serialized_certificate_length = 0;
+        if (CertificateManager::getInstance()->getServerCertificate(serialized_certificate,
+                                                                    serialized_certificate_length) != 0) {
+            cerr << "ServerMain - Error in loading the server certificate!" << endl;
+        }
+        EphemeralKeyPool::getInstance();
+        CryptoExecutor::getInstance();
     } catch (const std::exception& e) {
         cerr << "Exception caught during SocketManager construction: " << e.what() << endl;
         throw EXIT_FAILURE;
@@ -25,19 +46,39 @@ ServerMain::ServerMain(){
 
 /**
  * @brief Destructor for ServerMain class.
- * @details Cleans up resources, including deleting the SocketManager and CertificateManager instances,
- * and joining all threads in the thread pool.
+ * @details Cleans up resources, including the CertificateManager, SyncManager, CryptoExecutor, EphemeralKeyPool
+ * and KeyRegistry instances, and waits for the session workers to complete.
  */
 ServerMain::~ServerMain() {
+    // Stop the server and wait for the session workers
+    stop();
+    if (m_session_pool != nullptr) {
+        m_session_pool->shutdown();
+        delete m_session_pool;
+    }
+
     // Delete the SocketManager instance
     //delete m_socket_manager;
 
     // Delete the CertificateManager instance
     CertificateManager::deleteInstance();
 
-    // Join all threads in the thread pool
-    for (auto& thread : m_thread_pool)
-        thread.join();
+    // Delete the SyncManager instance, the sessions are over
+    SyncManager::deleteInstance();
+
+    // Report the load of the crypto workers
+    CryptoExecutor::Metrics metrics = CryptoExecutor::getInstance()->getMetrics();
+    if (metrics.tasks_num > 0) {
+        cout << "ServerMain - Handshake crypto operations: " << metrics.tasks_num
+             << ", average wait " << metrics.total_wait_time / metrics.tasks_num << " us"
+             << ", max wait " << metrics.max_wait_time << " us"
+             << ", average run " << metrics.total_run_time / metrics.tasks_num << " us" << endl;
+    }
+
+    // Stop the crypto workers, the generators of the ephemeral keys and the watcher of the key directories
+    CryptoExecutor::deleteInstance();
+    EphemeralKeyPool::deleteInstance();
+    KeyRegistry::deleteInstance();
 }
 
 /**
@@ -51,58 +92,186 @@ SocketManager *ServerMain::getMSocketManager() const {
 /**
  * @brief Signal handler for the server.
  * @param signal The signal received by the server.
- * @details Handles signals like SIGINT and SIGPIPE. Exits the program on SIGINT and throws an exception on SIGPIPE.
+ * @details Handles the SIGPIPE signal throwing an exception. SIGINT and SIGTERM are not delivered to this
+ * handler: they are waited synchronously to shut the server down gracefully.
  */
 void ServerMain::serverSignalHandler(int signal) {
-    if (signal == SIGINT) {
-        cout << "Server closed!" << endl;
-        exit(EXIT_SUCCESS);
-    } else if (signal == SIGPIPE) {
+    if (signal == SIGPIPE) {
         cout << "Server: SIGPIPE signal caught!" << endl;
         throw -3;
     }
 }
 
 /**
- * @brief Pushes a new thread into the thread pool.
- * @param socket_descriptor The socket descriptor for the new thread.
- * @details Creates a new SocketManager instance for the client and pushes a new thread into the thread pool
- * to handle the client connection.
+ * @brief Start the pool of workers serving the client sessions.
+ * @param workers_num The max number of requests served at the same time.
+ * @details A worker serves a single step of a session (the handshake or a request), then the session waits
+ * for its next request in a poller, without holding the worker. The ready sessions exceeding the workers
+ * wait in a bounded queue; when the queue is full the server stops accepting and the new clients wait in
+ * the listen backlog.
  */
-void ServerMain::emplaceThread(int socket_descriptor) {
+void ServerMain::startSessionPool(unsigned int workers_num) {
+    m_session_pool = new SessionPool(workers_num, Config::SESSION_QUEUE_LEN);
+}
 
-    auto* socket = new SocketManager(socket_descriptor);
-    // Emplace a new thread into the thread pool
-    m_thread_pool.emplace_back([](SocketManager* thread_socket) {
-        Server(thread_socket).run();
-    }, socket);
+/**
+ * @brief Queue a new client connection to be served by the session workers.
+ * @param socket_descriptor The socket descriptor of the accepted connection.
+ */
+void ServerMain::submitSession(int socket_descriptor) {
+    auto* socket = SocketManager::createConnection(socket_descriptor);
+    auto* server = new Server(socket);
+    // The first step authenticates the client, each of the next ones serves a single request
+    auto step = [server, authenticated = false]() mutable {
+        if (!authenticated) {
+            authenticated = true;
+            return server->authenticate();
+        }
+        return server->handleRequest();
+    };
+    auto release = [socket, server] {
+        delete server;
+        delete socket;
+    };
+    if (!m_session_pool->submit(socket_descriptor, step, release)) {
+        release();
+    }
+}
+
+/**
+ * @brief Stop the server: no more connections are accepted and the open sessions are closed.
+ * @details Shutting the sockets down unblocks the accept() of the main loop and the receive() of the
+ * workers, which are then joined by the destructor.
+ */
+void ServerMain::stop() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+    shutdown(m_socket_manager->getListeningSocketDescriptor(), SHUT_RDWR);
+    if (m_session_pool != nullptr) {
+        m_session_pool->stop();
+    }
+}
+
+/**
+ * @brief Check if the server has been stopped.
+ * @return true if stop() has been called, false otherwise.
+ */
+bool ServerMain::isStopping() const {
+    return m_stopping;
+}
+
+/**
+ * @brief Start a thread waiting for the given signals.
+ * @param signals The signals to wait, already blocked in every thread of the process.
+ * @param wakeup_signal The signal of the set sent to the thread by the destructor to stop it.
+ * @param on_signal The routine run for each received signal.
+ */
+SignalWatcher::SignalWatcher(sigset_t signals, int wakeup_signal, function<void(int)> on_signal)
+        : m_signals(signals), m_wakeup_signal(wakeup_signal) {
+    m_thread = thread([this, on_signal = std::move(on_signal)] {
+        int signal;
+        while (sigwait(&m_signals, &signal) == 0 && !m_stopping) {
+            on_signal(signal);
+        }
+    });
+}
+
+/**
+ * @brief Wake the watcher thread and wait for it.
+ */
+SignalWatcher::~SignalWatcher() {
+    m_stopping = true;
+    pthread_kill(m_thread.native_handle(), m_wakeup_signal);
+    m_thread.join();
 }
 
 /**
  * @brief Main function for the server.
  * @details Installs signal handlers, creates a SocketManager instance, and enters the main server loop,
- * accepting client connections and pushing threads to handle them.
+ * accepting client connections and queueing them to a fixed pool of session workers, which idle sessions
+ * do not hold.
+ * With the --reactor option the connections are instead served by an epoll-based Reactor, where a few
+ * worker threads serve all the sessions as their sockets become ready.
+ * The --workers option sets the number of workers in both modes.
+ * The --io-uring option selects the io_uring transport for the client connections.
+ * On SIGINT or SIGTERM the server stops accepting connections, closes the open sessions and exits.
+ * On SIGHUP the keys of the server and of the users are reloaded, as when their directories change.
  */
-int main() {
+int main(int argc, char *argv[]) {
     // Install the signal handler
-    std::signal(SIGINT, ServerMain::serverSignalHandler);
     std::signal(SIGPIPE, ServerMain::serverSignalHandler);
 
+    // Block the termination signals in every thread, they are waited by the shutdown watcher
+    sigset_t termination_signals;
+    sigemptyset(&termination_signals);
+    sigaddset(&termination_signals, SIGINT);
+    sigaddset(&termination_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &termination_signals, nullptr);
+    sigset_t reload_signals;
+    sigemptyset(&reload_signals);
+    sigaddset(&reload_signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &reload_signals, nullptr);
+
+    // Parse the command line options
+    bool reactor_mode = false;
+    unsigned int workers_num = 0;
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--reactor") {
+            reactor_mode = true;
+        } else if (option == "--io-uring") {
+            SocketManager::setTransport(SocketManager::Transport::IO_URING);
+        } else if (option == "--workers" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            workers_num = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--reactor] [--workers N] [--io-uring]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     try {
         // Create a ServerMain instance
         ServerMain server_main;
+        // The watchers are declared after the objects they use, so they are joined before their destruction
+        SignalWatcher reload_watcher(reload_signals, SIGHUP, [](int) {
+            cout << "Server: reloading the keys" << endl;
+            KeyRegistry::getInstance()->reload();
+        });
+
+        if (reactor_mode) {
+            // Serve every session from the event loop
+            Reactor reactor(server_main.getMSocketManager(),
+                            workers_num != 0 ? workers_num : Config::REACTOR_WORKERS,
+                            Config::REACTOR_TRANSFER_WORKERS, Config::REACTOR_HANDSHAKE_WORKERS);
+            SignalWatcher shutdown_watcher(termination_signals, SIGTERM, [&reactor](int) {
+                cout << "Server closed!" << endl;
+                reactor.stop();
+            });
+            reactor.run();
+            return EXIT_SUCCESS;
+        }
+
+        server_main.startSessionPool(workers_num != 0 ? workers_num : Config::SESSION_WORKERS);
+        SignalWatcher shutdown_watcher(termination_signals, SIGTERM, [&server_main](int) {
+            cout << "Server closed!" << endl;
+            server_main.stop();
+        });
 
         // Enter the main server loop
-        while (true) {
+        while (!server_main.isStopping()) {
             // Accept a client connection
             int socket_descriptor = server_main.getMSocketManager()->accept();
             if (socket_descriptor == -1) {
-                cout << "ServerMain - Error during connection with the client!" << endl;
+                if (!server_main.isStopping()) {
+                    cout << "ServerMain - Error during connection with the client!" << endl;
+                }
                 continue;
             }
-            // Push a new thread to handle the client connection
-            server_main.emplaceThread(socket_descriptor);
+            // Queue the connection to the session workers
+            server_main.submitSession(socket_descriptor);
         }
+        return EXIT_SUCCESS;
     } catch (int exit_code) {
         // Handle the exception from the constructor
         cerr << "Exception in main: " << exit_code << endl;
@@ -1,14 +1,18 @@
 #ifndef SECURE_CLOUD_STORAGE_SERVERMAIN_H
 #define SECURE_CLOUD_STORAGE_SERVERMAIN_H
 
-#include <vector>
+#include <atomic>
+#include <csignal>
+#include <functional>
 #include <thread>
 #include "SocketManager.h"
+#include "SessionPool.h"
 
 class ServerMain {
 
     SocketManager* m_socket_manager;
-    vector<thread> m_thread_pool;
+    SessionPool* m_session_pool = nullptr;
+    atomic<bool> m_stopping{false};
 
 public:
     ServerMain();
@@ -19,7 +23,31 @@ public:
 
     static void serverSignalHandler(int signal);
 
-    void emplaceThread(int socket_descriptor);
+    void startSessionPool(unsigned int workers_num);
+
+    void submitSession(int socket_descriptor);
+
+    void stop();
+
+    bool isStopping() const;
+};
+
+/**
+ * Thread waiting for a set of signals, already blocked in every thread of the process, and running a routine
+ * for each of them. The thread is woken and joined by the destructor, so the routine can safely use objects
+ * living in the scope of the watcher.
+ */
+class SignalWatcher {
+
+    sigset_t m_signals;
+    int m_wakeup_signal;
+    atomic<bool> m_stopping{false};
+    thread m_thread;
+
+public:
+    SignalWatcher(sigset_t signals, int wakeup_signal, function<void(int)> on_signal);
+
+    ~SignalWatcher();
 };
 
 
@@ -10,6 +10,23 @@ public:
     static constexpr const char* SERVER_IP = "localhost";
     static constexpr int SERVER_PORT = 5000;
     static constexpr int MAX_REQUESTS = 10;
+    // Thread mode: number of workers serving the sessions and max number of ready sessions waiting for a worker
+    static constexpr unsigned int SESSION_WORKERS = 32;
+    static constexpr size_t SESSION_QUEUE_LEN = 64;
+    // Thread mode: max events returned by a single epoll_wait of the poller holding the idle sessions
+    static constexpr int SESSION_MAX_EVENTS = 64;
+    // io_uring transport: submission queue entries of each connection ring
+    static constexpr unsigned int URING_QUEUE_DEPTH = 64;
+    // Reactor mode: max events returned by a single epoll_wait and number of workers serving the sessions
+    static constexpr int REACTOR_MAX_EVENTS = 64;
+    static constexpr unsigned int REACTOR_WORKERS = 4;
+    // Reactor mode: workers running the file transfers, so that they do not hold the workers serving the events
+    static constexpr unsigned int REACTOR_TRANSFER_WORKERS = 16;
+    // Reactor mode: workers running the blocking handshakes, so that slow clients logging in do not hold the
+    // workers serving the requests of the logged-in sessions
+    static constexpr unsigned int REACTOR_HANDSHAKE_WORKERS = 8;
+    // Seconds a send or receive on a client connection may wait for the client before the session is dropped
+    static constexpr int SOCKET_TIMEOUT = 60;
 
     static constexpr uint8_t FILE_NAME_LEN = 35;
     static constexpr uint8_t USERNAME_LEN = 35;
@@ -20,9 +37,38 @@ public:
     static constexpr unsigned int AES_KEY_LEN = 16;
     static constexpr unsigned int AAD_LEN = 4;
     static constexpr unsigned int IV_LEN = 12;
+    static constexpr unsigned int X25519_KEY_LEN = 32; // Raw X25519 public value sent during the handshake
+    static constexpr unsigned int IV_SALT_LEN = IV_LEN - sizeof(uint32_t); // IV part fixed for a session direction
     static constexpr long KB_SIZE = 1000; // 1 KB = 1000 bytes in decimal notation
-    static constexpr long CHUNK_SIZE = KB_SIZE * KB_SIZE; // 1 MB chunk size in bytes
+    static constexpr long CHUNK_SIZE = KB_SIZE * KB_SIZE; // 1 MB default chunk size in bytes
+    // Bounds of the chunk size negotiated during the authentication
+    static constexpr long MIN_CHUNK_SIZE = 16 * KB_SIZE;
+    static constexpr long MAX_CHUNK_SIZE = 16 * KB_SIZE * KB_SIZE;
+    static constexpr size_t CHUNKS_BATCH_LEN = 4; // Chunk messages queued to the socket before a flush
+    static constexpr size_t SEALING_WINDOW = 8; // Chunks of a download being encrypted or waiting to be sent
+    static constexpr unsigned int MAX_CONNECTIONS = 16; // Sessions used to transfer the ranges of a file
+    static constexpr size_t RANGE_MIN_CHUNKS = 8; // Smallest range transferred on its own session
+    // Seconds an incomplete upload with no session writing it is kept, waiting for its missing bytes
+    static constexpr int UPLOAD_EXPIRY = 10 * 60;
+    // Page cache hints of the file transfers: chunks prefetched ahead of a sequential read, and bytes written
+    // before their writeback is started and the pages written before them are dropped from the cache
+    static constexpr long READAHEAD_CHUNKS = 4;
+    static constexpr long WRITE_BEHIND_BYTES = 8 * KB_SIZE * KB_SIZE;
     static constexpr uint32_t MAX_COUNTER_VALUE = 0xffffffff;
+    // Session messages and bytes protected by a session key, then both sides derive the next key with HKDF
+    static constexpr uint32_t REKEY_MESSAGES = 1U << 24;
+    static constexpr uint64_t REKEY_BYTES = 64UL * KB_SIZE * KB_SIZE * KB_SIZE;
+    // Ephemeral key pairs of each key exchange group generated ahead of the handshakes, and generator threads
+    static constexpr size_t EPHEMERAL_KEY_POOL_LEN = 64;
+    static constexpr unsigned int EPHEMERAL_KEY_GENERATORS = 2;
+    // Threads running the public-key operations of the handshakes and max number of operations waiting for them
+    static constexpr unsigned int CRYPTO_WORKERS = 4;
+    static constexpr size_t CRYPTO_QUEUE_LEN = 64;
+    static constexpr uint32_t TICKET_LIFETIME = 60 * 60; // Seconds a session resumption ticket is accepted
+    // Suffix of the files being uploaded, not a valid file name for the clients: the file gets its name when complete
+    static constexpr const char* TEMPORARY_FILE_SUFFIX = ".part~";
+    // Extended attribute of a partial download holding the version of the file on the server
+    static constexpr const char* PARTIAL_VERSION_ATTRIBUTE = "user.secure-cloud-storage.version";
     static constexpr size_t MAX_FILE_SIZE = 4UL * KB_SIZE * KB_SIZE * KB_SIZE;
 };
 
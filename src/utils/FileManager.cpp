@@ -1,11 +1,18 @@
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <cstring>
 #include <filesystem>
 #include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
 
 #include "FileManager.h"
 #include "Config.h"
+#include "SyncManager.h"
 
 using namespace std;
 
@@ -17,7 +24,7 @@ FileManager::FileManager() = default;
 /**
  * Constructor for the FileManager class
  * @param file_path The path to the file
- * @param open_mode The mode in which the file should be opened (READ or WRITE)
+ * @param open_mode The mode in which the file should be opened (READ, WRITE, UPDATE or MAPPED_READ)
  */
 FileManager::FileManager(const string &file_path, OpenMode open_mode)
         : m_open_mode(open_mode), m_in_file(), m_out_file(),
@@ -37,10 +44,17 @@ FileManager::~FileManager() {
  * Close the file depending on the specified mode
  */
 void FileManager::closeFile() {
+    if (m_advice_descriptor != -1) {
+        close(m_advice_descriptor);
+        m_advice_descriptor = -1;
+    }
     if (m_open_mode == OpenMode::READ) {
         m_in_file.close();
-    } else if (m_open_mode == OpenMode::WRITE) {
+    } else if (m_open_mode == OpenMode::WRITE || m_open_mode == OpenMode::UPDATE) {
         m_out_file.close();
+    } else if (m_open_mode == OpenMode::MAPPED_READ && m_mapping != nullptr) {
+        munmap(m_mapping, m_mapping_len);
+        m_mapping = nullptr;
     }
 }
 
@@ -59,6 +73,12 @@ void FileManager::openFile(const string &file_path) {
             // In read mode the member variables related to file info are initialized
             // using the file size to compute them
             initFileInfo(computeFileSize(file_path));
+            // The file is read in order: double the readahead of the kernel and prefetch the first chunks
+            m_advice_descriptor = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (m_advice_descriptor != -1) {
+                posix_fadvise(m_advice_descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+            }
+            adviseReadahead(0);
 
             // Open file in write mode
         } else if (m_open_mode == OpenMode::WRITE) {
@@ -69,6 +89,41 @@ void FileManager::openFile(const string &file_path) {
             if (!m_out_file.is_open()) {
                 throw runtime_error("Failed to open file for writing");
             }
+            m_advice_descriptor = open(file_path.c_str(), O_WRONLY | O_CLOEXEC);
+
+            // Open an existing file in update mode (ios::in avoids the truncation)
+        } else if (m_open_mode == OpenMode::UPDATE) {
+            m_out_file.open(file_path, ios::binary | ios::in | ios::out);
+            if (!m_out_file.is_open()) {
+                throw runtime_error("Failed to open file for updating");
+            }
+            m_advice_descriptor = open(file_path.c_str(), O_WRONLY | O_CLOEXEC);
+
+            // Map the whole file, the chunks are read straight from the page cache
+        } else if (m_open_mode == OpenMode::MAPPED_READ) {
+            int file_descriptor = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat file_status{};
+            if (file_descriptor == -1 || fstat(file_descriptor, &file_status) == -1) {
+                if (file_descriptor != -1) {
+                    close(file_descriptor);
+                }
+                throw runtime_error("Failed to open file for mapping");
+            }
+            m_mapping_len = static_cast<size_t>(file_status.st_size);
+            // An empty file has no chunks and is not mapped
+            if (m_mapping_len > 0) {
+                void *mapping = mmap(nullptr, m_mapping_len, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+                if (mapping == MAP_FAILED) {
+                    close(file_descriptor);
+                    throw runtime_error("Failed to map file");
+                }
+                m_mapping = static_cast<uint8_t *>(mapping);
+                // The chunks are read in order: the kernel reads ahead and drops the pages already read
+                madvise(m_mapping, m_mapping_len, MADV_SEQUENTIAL);
+            }
+            close(file_descriptor);
+            initFileInfo(static_cast<streamsize>(m_mapping_len));
+            adviseReadahead(0);
         }
     } catch (const exception &e) {
         cerr << "FileManager - Error! " << e.what() << endl;
@@ -94,14 +149,16 @@ streamsize FileManager::computeFileSize(const string& file_path) {
 /**
  * Initialize file information (size, number of chunks, last chunk size)
  * @param file_size The size of the file in bytes
+ * @param chunk_size The size of the chunks in bytes, negotiated for the session
  */
-void FileManager::initFileInfo(streamsize file_size) {
+void FileManager::initFileInfo(streamsize file_size, streamsize chunk_size) {
     m_file_size = file_size;
-    m_chunks_num = ceil((double) m_file_size / (double) Config::CHUNK_SIZE);
-    if (m_file_size % Config::CHUNK_SIZE != 0) {
-        m_last_chunk_size = m_file_size % Config::CHUNK_SIZE;
+    m_chunk_size = chunk_size;
+    m_chunks_num = ceil((double) m_file_size / (double) m_chunk_size);
+    if (m_file_size % m_chunk_size != 0) {
+        m_last_chunk_size = m_file_size % m_chunk_size;
     } else {
-        m_last_chunk_size = Config::CHUNK_SIZE;
+        m_last_chunk_size = m_chunk_size;
     }
 }
 
@@ -122,6 +179,10 @@ string FileManager::getFilesList(const string& path) {
         string filesString;
         // Iterate over the files in the specified path
         for (const auto& entry : filesystem::directory_iterator(path)) {
+            // The files still being uploaded are not listed
+            if (isTemporaryPath(entry.path().string())) {
+                continue;
+            }
             filesString += entry.path().filename().string() + ",";
         }
         // Remove the trailing "," if there are any files
@@ -159,6 +220,14 @@ streamsize FileManager::getLastChunkSize() const {
     return m_last_chunk_size;
 }
 
+/**
+ * Get the size of the chunks the file is divided into
+ * @return The size of a chunk in bytes
+ */
+streamsize FileManager::getChunkSize() const {
+    return m_chunk_size;
+}
+
 /**
  * Read a chunk of data from the file
  * @param buffer The buffer to store the read data
@@ -167,7 +236,15 @@ streamsize FileManager::getLastChunkSize() const {
  */
 int FileManager::readChunk(uint8_t *buffer, streamsize size) {
     if (m_open_mode == READ) {
+        adviseReadahead(m_position);
         m_in_file.read((char*)buffer, size);
+        m_position += size;
+    } else if (m_open_mode == MAPPED_READ) {
+        const uint8_t *chunk = mapChunk(size);
+        if (chunk == nullptr) {
+            return -1;
+        }
+        memcpy(buffer, chunk, size);
     } else {
         cerr << "FileManager - Error while reading chunk" << endl;
         return -1;
@@ -175,6 +252,81 @@ int FileManager::readChunk(uint8_t *buffer, streamsize size) {
     return 0;
 }
 
+/**
+ * Get the next chunk of data of the file in place, without copying it (MAPPED_READ mode)
+ * @param size The size of the chunk
+ * @return A pointer to the chunk in the mapping of the file, valid until the file is closed, or nullptr on failure
+ */
+const uint8_t *FileManager::mapChunk(streamsize size) {
+    if (m_open_mode != MAPPED_READ || m_mapping == nullptr || size < 0 ||
+        static_cast<size_t>(size) > m_mapping_len - m_mapping_position) {
+        cerr << "FileManager - Error while mapping chunk" << endl;
+        return nullptr;
+    }
+    adviseReadahead(static_cast<streamsize>(m_mapping_position));
+    const uint8_t *chunk = m_mapping + m_mapping_position;
+    m_mapping_position += static_cast<size_t>(size);
+    return chunk;
+}
+
+/**
+ * Ask the kernel to prefetch the next READAHEAD_CHUNKS chunks of a sequential read (READ and MAPPED_READ modes),
+ * so that the disk reads them while the previous chunks are being encrypted and sent.
+ * The next range is requested when half of the previous one has been read.
+ * @param position The position of the next read
+ */
+void FileManager::adviseReadahead(streamsize position) {
+    streamsize window = Config::READAHEAD_CHUNKS * m_chunk_size;
+    if (m_readahead_end - position > window / 2) {
+        return;
+    }
+    streamsize start = max(m_readahead_end, position);
+    streamsize end = position + window;
+    if (m_open_mode == MAPPED_READ) {
+        end = min(end, static_cast<streamsize>(m_mapping_len));
+        if (end <= start) {
+            return;
+        }
+        // The advice on a mapping starts at a page boundary
+        auto page_size = static_cast<streamsize>(sysconf(_SC_PAGESIZE));
+        streamsize aligned_start = start - start % page_size;
+        madvise(m_mapping + aligned_start, static_cast<size_t>(end - aligned_start), MADV_WILLNEED);
+    } else if (m_advice_descriptor != -1) {
+        posix_fadvise(m_advice_descriptor, start, end - start, POSIX_FADV_WILLNEED);
+    }
+    m_readahead_end = end;
+}
+
+/**
+ * Write-behind of a large sequential write (WRITE and UPDATE modes): start the writeback of the range written
+ * since the last call, then wait for the writeback of the range before it and drop its pages from the cache.
+ * The dirty pages of a transfer are bounded to about 2 * WRITE_BEHIND_BYTES and a large upload does not evict
+ * the pages of the other files from the cache.
+ */
+void FileManager::writeBehind() {
+    if (m_advice_descriptor == -1 || !m_out_file.flush()) {
+        return;
+    }
+    sync_file_range(m_advice_descriptor, m_writeback_start, m_position - m_writeback_start,
+                    SYNC_FILE_RANGE_WRITE);
+    if (m_writeback_start > m_dropped_end) {
+        sync_file_range(m_advice_descriptor, m_dropped_end, m_writeback_start - m_dropped_end,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(m_advice_descriptor, m_dropped_end, m_writeback_start - m_dropped_end,
+                      POSIX_FADV_DONTNEED);
+        m_dropped_end = m_writeback_start;
+    }
+    m_writeback_start = m_position;
+}
+
+/**
+ * Check if the file is read through a memory mapping
+ * @return True in MAPPED_READ mode, false otherwise
+ */
+bool FileManager::isMapped() const {
+    return m_open_mode == MAPPED_READ;
+}
+
 /**
  * Write a chunk of data to the file
  * @param buffer The buffer containing the data to be written
@@ -182,8 +334,16 @@ int FileManager::readChunk(uint8_t *buffer, streamsize size) {
  * @return 0 on success, -1 on failure
  */
 int FileManager::writeChunk(uint8_t *buffer, streamsize size) {
-    if (m_open_mode == WRITE) {
+    if (m_open_mode == WRITE || m_open_mode == UPDATE) {
         m_out_file.write((char*)buffer, size);
+        if (m_out_file.fail()) {
+            cerr << "FileManager - Error while writing chunk" << endl;
+            return -1;
+        }
+        m_position += size;
+        if (m_position - m_writeback_start >= Config::WRITE_BEHIND_BYTES) {
+            writeBehind();
+        }
     } else {
         cerr << "FileManager - Error while writing chunk" << endl;
         return -1;
@@ -191,6 +351,182 @@ int FileManager::writeChunk(uint8_t *buffer, streamsize size) {
     return 0;
 }
 
+/**
+ * Move the position of the next read (READ and MAPPED_READ modes) or write (WRITE and UPDATE modes)
+ * @param offset The offset from the beginning of the file
+ * @return 0 on success, -1 on failure
+ */
+int FileManager::seek(streamsize offset) {
+    if (m_open_mode == MAPPED_READ) {
+        if (offset < 0 || static_cast<size_t>(offset) > m_mapping_len) {
+            return -1;
+        }
+        m_mapping_position = static_cast<size_t>(offset);
+        m_readahead_end = offset;
+        return 0;
+    }
+    // The hints restart from the new position
+    m_position = offset;
+    m_readahead_end = offset;
+    m_writeback_start = offset;
+    m_dropped_end = offset;
+    if (m_open_mode == READ) {
+        m_in_file.seekg(offset, ios::beg);
+        return m_in_file.fail() ? -1 : 0;
+    }
+    m_out_file.seekp(offset, ios::beg);
+    return m_out_file.fail() ? -1 : 0;
+}
+
+/**
+ * Create a new file with the specified size, so that its ranges can be written in any order
+ * @param file_path The path to the file
+ * @param file_size The size of the file in bytes
+ * @return 0 on success, -1 if the file already exists or cannot be created
+ */
+int FileManager::allocateFile(const string &file_path, streamsize file_size) {
+    // Create the file exclusively, so that concurrent sessions cannot allocate the same file
+    int file_descriptor = open(file_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (file_descriptor == -1) {
+        return -1;
+    }
+    int result = ftruncate(file_descriptor, file_size);
+    close(file_descriptor);
+    return result == 0 ? 0 : -1;
+}
+
+/**
+ * Get the version of a file, its modification time in nanoseconds: a partial transfer of the file is resumed
+ * only if the version has not changed, without reading the bytes already transferred again
+ * @param file_path The path of the file
+ * @param version Set to the version of the file
+ * @return 0 on success, -1 if the file cannot be accessed
+ */
+int FileManager::getVersion(const string &file_path, uint64_t &version) {
+    struct stat file_status{};
+    if (stat(file_path.c_str(), &file_status) == -1) {
+        return -1;
+    }
+    version = static_cast<uint64_t>(file_status.st_mtim.tv_sec) * 1000000000ULL +
+              static_cast<uint64_t>(file_status.st_mtim.tv_nsec);
+    return 0;
+}
+
+/**
+ * Record the version of the file being downloaded in an extended attribute of its temporary file, so that an
+ * interrupted download is resumed only if the file has not changed on the server
+ * @param temporary_path The path of the temporary file
+ * @param version The version of the file being downloaded
+ * @return 0 on success, -1 if the attribute cannot be set (the download cannot be resumed)
+ */
+int FileManager::setPartialVersion(const string &temporary_path, uint64_t version) {
+    return setxattr(temporary_path.c_str(), Config::PARTIAL_VERSION_ATTRIBUTE, &version, sizeof(version), 0);
+}
+
+/**
+ * Get the version of the file recorded in its temporary file by setPartialVersion
+ * @param temporary_path The path of the temporary file
+ * @param version Set to the version of the file being downloaded
+ * @return 0 on success, -1 if the temporary file has no version
+ */
+int FileManager::getPartialVersion(const string &temporary_path, uint64_t &version) {
+    ssize_t size = getxattr(temporary_path.c_str(), Config::PARTIAL_VERSION_ATTRIBUTE, &version, sizeof(version));
+    return size == static_cast<ssize_t>(sizeof(version)) ? 0 : -1;
+}
+
+/**
+ * Get the path where a file is written while it is being uploaded
+ * @param file_path The path of the complete file
+ * @return The path of the temporary file
+ */
+string FileManager::getTemporaryPath(const string &file_path) {
+    return file_path + Config::TEMPORARY_FILE_SUFFIX;
+}
+
+/**
+ * Check if a path is the one of a file being uploaded
+ * @param path The path of the file
+ * @return True if the path ends with the suffix of the temporary files, false otherwise
+ */
+bool FileManager::isTemporaryPath(const string &path) {
+    size_t suffix_len = strlen(Config::TEMPORARY_FILE_SUFFIX);
+    return path.size() > suffix_len &&
+           path.compare(path.size() - suffix_len, suffix_len, Config::TEMPORARY_FILE_SUFFIX) == 0;
+}
+
+/**
+ * Check if a file name received from a client can be used in the directory of the user: it must not leave the
+ * directory nor collide with the temporary files of the uploads
+ * @param file_name The file name, without any directory
+ * @return True if the name is not empty, contains no '/' nor "..", and is not a temporary file name
+ */
+bool FileManager::isValidFileName(const string &file_name) {
+    return !file_name.empty() && file_name != "." && file_name.find('/') == string::npos &&
+           file_name.find("..") == string::npos && !isTemporaryPath(file_name);
+}
+
+/**
+ * Make a completely written file durable and give it its final name: the content of the temporary file is
+ * flushed, the file is atomically renamed, then the directory entry is flushed. The flushes are group
+ * committed with the ones of the other sessions.
+ * @param temporary_path The path of the written file
+ * @param file_path The final path of the file, which must not exist
+ * @return 0 on success, -1 if the file cannot be flushed or a file with the final name already exists
+ */
+int FileManager::commitFile(const string &temporary_path, const string &file_path) {
+    int file_descriptor = open(temporary_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor == -1) {
+        return -1;
+    }
+    int result = SyncManager::getInstance()->sync(file_descriptor, true);
+    close(file_descriptor);
+    if (result == -1) {
+        cerr << "FileManager - Error while flushing the file" << endl;
+        return -1;
+    }
+
+    // Publish the file without replacing a file created with the same name in the meantime
+    result = renameat2(AT_FDCWD, temporary_path.c_str(), AT_FDCWD, file_path.c_str(), RENAME_NOREPLACE);
+    if (result == -1 && errno == EINVAL) {
+        // File system without RENAME_NOREPLACE: link() fails as well if the name already exists
+        result = link(temporary_path.c_str(), file_path.c_str());
+        if (result == 0) {
+            unlink(temporary_path.c_str());
+        }
+    }
+    if (result == -1) {
+        cerr << "FileManager - Error while renaming the file" << endl;
+        return -1;
+    }
+
+    string directory_path = filesystem::path(file_path).parent_path().string();
+    int directory_descriptor = open(directory_path.empty() ? "." : directory_path.c_str(),
+                                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory_descriptor == -1) {
+        return -1;
+    }
+    result = SyncManager::getInstance()->sync(directory_descriptor);
+    close(directory_descriptor);
+    return result;
+}
+
+/**
+ * Remove the temporary files of the uploads interrupted by a crash of the server
+ * @param path The directory of the stored files, searched recursively
+ */
+void FileManager::removeTemporaryFiles(const string &path) {
+    error_code error;
+    for (auto entry = filesystem::recursive_directory_iterator(path, error);
+         entry != filesystem::recursive_directory_iterator(); entry.increment(error)) {
+        if (error) {
+            break;
+        }
+        if (entry->is_regular_file() && isTemporaryPath(entry->path().string())) {
+            filesystem::remove(entry->path(), error);
+        }
+    }
+}
+
 /**
  * Check if a file is present at the specified path
  * @param file_path The path to the file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include "Config.h"
 
 using std::string;
 using std::ifstream;
@@ -14,7 +15,9 @@ class FileManager {
 
 public:
     enum OpenMode {
-        READ, WRITE
+        READ, WRITE,
+        UPDATE,         // Write an existing file at any offset, without truncating it
+        MAPPED_READ     // Read the file through a memory mapping, the chunks are accessed in place
     };
 
     FileManager();
@@ -29,13 +32,21 @@ public:
 
     streamsize getLastChunkSize() const;
 
+    streamsize getChunkSize() const;
+
     void closeFile();
 
     int readChunk(uint8_t *buffer, streamsize size);
 
+    const uint8_t *mapChunk(streamsize size);
+
+    bool isMapped() const;
+
     int writeChunk(uint8_t *buffer, streamsize size);
 
-    void initFileInfo(streamsize file_size);
+    int seek(streamsize offset);
+
+    void initFileInfo(streamsize file_size, streamsize chunk_size = Config::CHUNK_SIZE);
 
     static streamsize computeFileSize(const string& file_path);
 
@@ -43,6 +54,24 @@ public:
 
     static bool isFilePresent(const string &file_path);
 
+    static int allocateFile(const string &file_path, streamsize file_size);
+
+    static int getVersion(const string &file_path, uint64_t &version);
+
+    static int setPartialVersion(const string &temporary_path, uint64_t version);
+
+    static int getPartialVersion(const string &temporary_path, uint64_t &version);
+
+    static string getTemporaryPath(const string &file_path);
+
+    static bool isTemporaryPath(const string &path);
+
+    static bool isValidFileName(const string &file_name);
+
+    static int commitFile(const string &temporary_path, const string &file_path);
+
+    static void removeTemporaryFiles(const string &path);
+
     static bool isStringValid(const string &input_string);
 
     static int getValidCode(int lowerBound, int upperBound);
@@ -51,13 +80,30 @@ private:
     OpenMode m_open_mode;
     ifstream m_in_file;
     ofstream m_out_file;
+    // Mapping of the whole file in MAPPED_READ mode and position of the next chunk
+    uint8_t *m_mapping = nullptr;
+    size_t m_mapping_len = 0;
+    size_t m_mapping_position = 0;
+    // Page cache hints: descriptor of the file used for the advice in the stream modes, position of the next
+    // read or write, end of the prefetched range, start of the range not yet written back and end of the
+    // range already dropped from the cache
+    int m_advice_descriptor = -1;
+    streamsize m_position = 0;
+    streamsize m_readahead_end = 0;
+    streamsize m_writeback_start = 0;
+    streamsize m_dropped_end = 0;
 
     streamsize m_file_size{};
     streamsize m_chunks_num{};
     streamsize m_last_chunk_size{};
+    streamsize m_chunk_size = Config::CHUNK_SIZE;
 
     void openFile(const string &file_path);
 
+    void adviseReadahead(streamsize position);
+
+    void writeBehind();
+
 
 };
 
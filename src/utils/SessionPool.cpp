@@ -0,0 +1,198 @@
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "SessionPool.h"
+#include "Config.h"
+
+/**
+ * @brief Constructor for the SessionPool class, starts the workers and the poller of the idle sessions.
+ * @param workers_num The number of worker threads serving the sessions.
+ * @param queue_capacity The max number of ready sessions waiting for a worker, 0 for no limit.
+ */
+SessionPool::SessionPool(unsigned int workers_num, size_t queue_capacity) : m_workers(workers_num, queue_capacity) {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        cerr << "SessionPool - Error during the epoll instance creation!" << endl;
+        throw EXIT_FAILURE;
+    }
+
+    // Event descriptor used to wake up the poller when the pool is shut down
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event wakeup_event{};
+    wakeup_event.events = EPOLLIN;
+    wakeup_event.data.ptr = nullptr;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wakeup_fd, &wakeup_event);
+
+    m_poller = thread(&SessionPool::pollSessions, this);
+}
+
+/**
+ * @brief Destructor for the SessionPool class, closes the open sessions and joins the threads.
+ */
+SessionPool::~SessionPool() {
+    shutdown();
+    close(m_wakeup_fd);
+    close(m_epoll_fd);
+}
+
+/**
+ * @brief Start serving a new session: its first step is run by a worker as soon as one is free.
+ * @param socket_descriptor The socket of the session, watched for the messages of the client.
+ * @param step The routine serving the next message of the client, returning 0 if the session goes on.
+ * @param release The routine releasing the resources of the session, called once when the session is over.
+ * @return true if the pool took the session, false if it is shutting down and the caller keeps the session.
+ */
+bool SessionPool::submit(int socket_descriptor, function<int()> step, function<void()> release) {
+    auto *session = new Session{socket_descriptor, std::move(step), std::move(release), false};
+    {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        if (m_stopping) {
+            delete session;
+            return false;
+        }
+        m_sessions.insert(session);
+    }
+
+    if (!m_workers.submit([this, session] { serveSession(session); })) {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        m_sessions.erase(session);
+        delete session;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stop the pool without waiting: no session is accepted anymore and the open ones are shut down.
+ * @details Shutting the sockets down unblocks the workers waiting for a client and makes the idle sessions
+ * readable, so each of them is served once more and closed.
+ */
+void SessionPool::stop() {
+    lock_guard<mutex> lock(m_sessions_mutex);
+    m_stopping = true;
+    for (Session *session : m_sessions) {
+        ::shutdown(session->socket_descriptor, SHUT_RDWR);
+    }
+}
+
+/**
+ * @brief Stop the pool, wait for the workers and the poller and release the sessions still open.
+ */
+void SessionPool::shutdown() {
+    stop();
+    // The poller may still hand an idle session to the workers, the sessions it cannot hand are closed by it
+    m_workers.shutdown();
+    if (m_poller.joinable()) {
+        uint64_t value = 1;
+        write(m_wakeup_fd, &value, sizeof(value));
+        m_poller.join();
+    }
+
+    // Release the sessions parked after the last events reported to the poller
+    for (Session *session : m_sessions) {
+        session->release();
+        delete session;
+    }
+    m_sessions.clear();
+}
+
+/**
+ * @brief Get the number of worker threads.
+ * @return The number of workers.
+ */
+unsigned int SessionPool::getWorkersNum() const {
+    return m_workers.getWorkersNum();
+}
+
+/**
+ * @brief Get the number of open sessions, being served or waiting for their client.
+ * @return The number of sessions.
+ */
+size_t SessionPool::getSessionsNum() {
+    lock_guard<mutex> lock(m_sessions_mutex);
+    return m_sessions.size();
+}
+
+/**
+ * @brief Run a step of a session on the calling worker, then park the session until its next message.
+ * @param session The session to serve.
+ */
+void SessionPool::serveSession(Session *session) {
+    int result;
+    try {
+        result = session->step();
+    } catch (...) {
+        result = -1;
+    }
+    if (result != 0 || parkSession(session) == -1) {
+        closeSession(session);
+    }
+}
+
+/**
+ * @brief Hand a session to the poller, which queues it to the workers when its socket becomes readable.
+ * @details The registration is one-shot, so the session is never queued twice, and the session must not be
+ * used by the caller after this call.
+ * @param session The session waiting for its client.
+ * @return 0 on success, -1 on error.
+ */
+int SessionPool::parkSession(Session *session) {
+    epoll_event session_event{};
+    session_event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    session_event.data.ptr = session;
+    int operation = session->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    session->registered = true;
+    if (epoll_ctl(m_epoll_fd, operation, session->socket_descriptor, &session_event) == -1) {
+        cerr << "SessionPool - Error while registering the session socket!" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Close a session, removing its socket from the poller and releasing its resources.
+ * @param session The session to close.
+ */
+void SessionPool::closeSession(Session *session) {
+    if (session->registered) {
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, session->socket_descriptor, nullptr);
+    }
+    {
+        lock_guard<mutex> lock(m_sessions_mutex);
+        m_sessions.erase(session);
+    }
+    session->release();
+    delete session;
+}
+
+/**
+ * @brief Loop of the poller: queues to the workers the idle sessions whose client sent a message (or closed
+ * the connection), until the pool is shut down.
+ */
+void SessionPool::pollSessions() {
+    epoll_event events[Config::SESSION_MAX_EVENTS];
+
+    while (true) {
+        int events_num = epoll_wait(m_epoll_fd, events, Config::SESSION_MAX_EVENTS, -1);
+        if (events_num == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "SessionPool - Error while waiting for events!" << endl;
+            return;
+        }
+
+        for (int i = 0; i < events_num; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                // Pool shut down
+                return;
+            }
+            auto *session = static_cast<Session *>(events[i].data.ptr);
+            if (!m_workers.submit([this, session] { serveSession(session); })) {
+                closeSession(session);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SECURE_CLOUD_STORAGE_SESSIONPOOL_H
+#define SECURE_CLOUD_STORAGE_SESSIONPOOL_H
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "WorkerPool.h"
+
+using namespace std;
+
+/**
+ * Pool of workers serving the connection sessions one message at a time. A worker runs a step of a session
+ * when its socket becomes readable, then parks the session in a poller thread waiting with epoll for the next
+ * message. A session waiting for its client only costs a registered descriptor, so idle clients never hold
+ * the workers and a new client is served even when more sessions than workers are open.
+ */
+class SessionPool {
+
+public:
+    SessionPool(unsigned int workers_num, size_t queue_capacity);
+
+    ~SessionPool();
+
+    bool submit(int socket_descriptor, function<int()> step, function<void()> release);
+
+    void stop();
+
+    void shutdown();
+
+    unsigned int getWorkersNum() const;
+
+    size_t getSessionsNum();
+
+private:
+    struct Session {
+        int socket_descriptor;
+        function<int()> step;       // Serves the next message of the client, returns 0 if the session goes on
+        function<void()> release;   // Releases the resources of the session, closing its socket
+        bool registered;            // Socket already registered in the poller
+    };
+
+    WorkerPool m_workers;
+    int m_epoll_fd;
+    int m_wakeup_fd;
+    thread m_poller;
+
+    unordered_set<Session *> m_sessions;
+    mutex m_sessions_mutex;
+    bool m_stopping = false;
+
+    void serveSession(Session *session);
+
+    int parkSession(Session *session);
+
+    void closeSession(Session *session);
+
+    void pollSessions();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_SESSIONPOOL_H
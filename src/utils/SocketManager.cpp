@@ -2,9 +2,18 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <vector>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include "SocketManager.h"
+#include "UringSocketManager.h"
+#include "Config.h"
+
+SocketManager::Transport SocketManager::m_transport = SocketManager::Transport::POSIX;
 
 SocketManager::SocketManager() = default;
 
@@ -88,18 +97,28 @@ SocketManager::SocketManager(const string &server_ip, int server_port) {
 
 /**
  * Constructor for creating a SocketManager instance from an existing socket descriptor.
+ * The sends and receives of the accepted connection fail if the client stays silent for more than
+ * Config::SOCKET_TIMEOUT seconds, so a stalled client cannot hold the thread serving it forever.
  *
  * @param socket_descriptor The existing socket descriptor.
  */
-SocketManager::SocketManager(int socket_descriptor) : m_socket(socket_descriptor) {
+SocketManager::SocketManager(int socket_descriptor) : m_socket(socket_descriptor), m_timeout(Config::SOCKET_TIMEOUT) {
+    timeval timeout{};
+    timeout.tv_sec = m_timeout;
+    if (setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1 ||
+        setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == -1) {
+        cerr << "SocketManager - Error while setting the socket timeouts!" << endl;
+    }
 }
 
 /**
  * Destructor for the SocketManager class.
  */
 SocketManager::~SocketManager() {
-    close(m_socket);
-    close(m_listening_socket);
+    if (m_socket != -1)
+        close(m_socket);
+    if (m_listening_socket != -1)
+        close(m_listening_socket);
 }
 
 /**
@@ -111,10 +130,55 @@ SocketManager::~SocketManager() {
  * @return 0 on success, -1 on error.
  */
 int SocketManager::send(uint8_t *message_buffer, size_t message_buffer_size) {
-    int result = ::send(m_socket, message_buffer, message_buffer_size, 0);
-    if (result == -1) {
-        cerr << "SocketManager - Error while sending the message" << endl;
-        return -1;
+    // A send interrupted by the timeout returns the bytes already sent, the rest is sent by the next call
+    size_t sent = 0;
+    while (sent < message_buffer_size) {
+        ssize_t result = ::send(m_socket, message_buffer + sent, message_buffer_size - sent, 0);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "SocketManager - Error while sending the message" << (isTimeout() ? " (timeout)" : "") << endl;
+            return -1;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    return 0;
+}
+
+/**
+ * Sends a message made of several buffers with a single sendmsg() call, without concatenating them.
+ *
+ * @param buffers The buffers of the message, in order.
+ * @param buffers_num The number of buffers.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int SocketManager::send(const iovec *buffers, int buffers_num) {
+    // The buffers are advanced past the bytes already sent if the kernel accepts only part of them
+    vector<iovec> remaining(buffers, buffers + buffers_num);
+    size_t first = 0;
+    while (first < remaining.size()) {
+        msghdr message{};
+        message.msg_iov = &remaining[first];
+        message.msg_iovlen = remaining.size() - first;
+        ssize_t result = sendmsg(m_socket, &message, 0);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "SocketManager - Error while sending the message" << (isTimeout() ? " (timeout)" : "") << endl;
+            return -1;
+        }
+        auto sent = static_cast<size_t>(result);
+        while (first < remaining.size() && sent >= remaining[first].iov_len) {
+            sent -= remaining[first].iov_len;
+            first++;
+        }
+        if (first < remaining.size()) {
+            remaining[first].iov_base = static_cast<uint8_t *>(remaining[first].iov_base) + sent;
+            remaining[first].iov_len -= sent;
+        }
     }
     return 0;
 }
@@ -133,9 +197,10 @@ int SocketManager::receive(uint8_t *message_buffer, size_t message_buffer_size)
         cout << "SocketManager - Connection closed!" << endl;
         return -2;
     } else if (result == -1) {
-        cerr << "SocketManager - Error while receiving the message!" << endl;
+        cerr << "SocketManager - Error while receiving the message" << (isTimeout() ? " (timeout)" : "") << "!" << endl;
         return -1;
     } else if (result != message_buffer_size) {
+        // MSG_WAITALL returns a partial message when the timeout expires
         cerr << "SocketManager - Error: incorrect message size!" << endl;
         return -1;
     } else {
@@ -143,6 +208,129 @@ int SocketManager::receive(uint8_t *message_buffer, size_t message_buffer_size)
     }
 }
 
+/**
+ * Waits, without any timeout, until the next message of the peer (or the connection closure) can be read.
+ * The socket timeouts bound the transfer of a message, not the time the client takes to send a new request.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int SocketManager::waitForMessage() {
+    pollfd descriptor{m_socket, POLLIN, 0};
+    while (poll(&descriptor, 1, -1) == -1) {
+        if (errno != EINTR) {
+            cerr << "SocketManager - Error while waiting for a message!" << endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Checks if the last failed send or receive was stopped by the socket timeout.
+ *
+ * @return true if the operation timed out, false otherwise.
+ */
+bool SocketManager::isTimeout() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+/**
+ * Queues a message to be sent. With the POSIX transport the message is sent immediately.
+ * The buffer must stay valid until flush() returns.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int SocketManager::queueSend(uint8_t *message_buffer, size_t message_buffer_size) {
+    return send(message_buffer, message_buffer_size);
+}
+
+/**
+ * Queues a message made of several buffers to be sent. With the POSIX transport the message is sent
+ * immediately. The buffers must stay valid until flush() returns, the array describing them is copied.
+ *
+ * @param buffers The buffers of the message, in order.
+ * @param buffers_num The number of buffers.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int SocketManager::queueSend(const iovec *buffers, int buffers_num) {
+    return send(buffers, buffers_num);
+}
+
+/**
+ * Queues a message to be received. With the POSIX transport the message is received immediately.
+ * The buffer is filled only after flush() returns.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int SocketManager::queueReceive(uint8_t *message_buffer, size_t message_buffer_size) {
+    return receive(message_buffer, message_buffer_size);
+}
+
+/**
+ * Completes all the queued operations. The POSIX transport has nothing pending.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int SocketManager::flush() {
+    return 0;
+}
+
+/**
+ * Selects the transport used by the connections created from now on.
+ *
+ * @param transport The transport to use.
+ */
+void SocketManager::setTransport(Transport transport) {
+    m_transport = transport;
+}
+
+/**
+ * Get the transport used by the new connections.
+ *
+ * @return The selected transport.
+ */
+SocketManager::Transport SocketManager::getTransport() {
+    return m_transport;
+}
+
+/**
+ * Creates a SocketManager for an accepted connection, using the selected transport.
+ * If io_uring is not supported by the kernel, the POSIX transport is used.
+ *
+ * @param socket_descriptor The socket descriptor returned by accept().
+ *
+ * @return The new SocketManager instance.
+ */
+SocketManager *SocketManager::createConnection(int socket_descriptor) {
+    if (m_transport == Transport::IO_URING && UringSocketManager::isSupported()) {
+        return new UringSocketManager(socket_descriptor);
+    }
+    return new SocketManager(socket_descriptor);
+}
+
+/**
+ * Creates a SocketManager connected to the server, using the selected transport.
+ * If io_uring is not supported by the kernel, the POSIX transport is used.
+ *
+ * @param server_ip IP of the server
+ * @param server_port Port of the server
+ *
+ * @return The new SocketManager instance.
+ */
+SocketManager *SocketManager::createConnection(const string &server_ip, int server_port) {
+    if (m_transport == Transport::IO_URING && UringSocketManager::isSupported()) {
+        return new UringSocketManager(server_ip, server_port);
+    }
+    return new SocketManager(server_ip, server_port);
+}
+
 /**
  * Accepts a connection request from a client.
  *
@@ -154,3 +342,21 @@ int SocketManager::accept() {
     return ::accept(m_listening_socket, (struct sockaddr *) &client_address,
                                      (unsigned int *) &client_address_size);
 }
+
+/**
+ * Get the descriptor of the communication socket.
+ *
+ * @return The socket descriptor, or -1 if the socket is not initialized.
+ */
+int SocketManager::getSocketDescriptor() const {
+    return m_socket;
+}
+
+/**
+ * Get the descriptor of the listening socket.
+ *
+ * @return The listening socket descriptor, or -1 if the socket is not initialized.
+ */
+int SocketManager::getListeningSocketDescriptor() const {
+    return m_listening_socket;
+}
@@ -6,11 +6,24 @@
 using namespace std;
 
 struct sockaddr_in;
+struct iovec;
 
 class SocketManager {
 
-    int m_listening_socket;
-    int m_socket;
+public:
+    // I/O backend used by the connection sockets, selected once at startup
+    enum class Transport {
+        POSIX,      // One blocking send()/recv() syscall per message
+        IO_URING    // Queued operations submitted in batches to an io_uring instance
+    };
+
+protected:
+    int m_listening_socket = -1;
+    int m_socket = -1;
+    // Seconds a send or receive of an accepted connection may wait for the peer, 0 means no timeout
+    int m_timeout = 0;
+
+    static Transport m_transport;
 
 public:
     SocketManager();
@@ -18,12 +31,29 @@ public:
     SocketManager(const string& server_ip, int server_port);
     SocketManager(int socket_descriptor);
 
-    ~SocketManager();
+    virtual ~SocketManager();
+
+    static void setTransport(Transport transport);
+    static Transport getTransport();
+    static SocketManager* createConnection(int socket_descriptor);
+    static SocketManager* createConnection(const string& server_ip, int server_port);
 
     int initSocket(const string &ip_address, int port, sockaddr_in& server_address, bool b);
     int accept();
-    int send(uint8_t *message_buffer, size_t message_buffer_size);
-    int receive(uint8_t *message_buffer, size_t message_buffer_size);
+    virtual int send(uint8_t *message_buffer, size_t message_buffer_size);
+    virtual int send(const iovec *buffers, int buffers_num);
+    virtual int receive(uint8_t *message_buffer, size_t message_buffer_size);
+    virtual int queueSend(uint8_t *message_buffer, size_t message_buffer_size);
+    virtual int queueSend(const iovec *buffers, int buffers_num);
+    virtual int queueReceive(uint8_t *message_buffer, size_t message_buffer_size);
+    virtual int flush();
+    int waitForMessage();
+
+    int getSocketDescriptor() const;
+    int getListeningSocketDescriptor() const;
+
+protected:
+    static bool isTimeout();
 };
 
 
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SyncManager.h"
+
+SyncManager* SyncManager::m_sync_manager_instance = nullptr;
+mutex SyncManager::m_instance_mutex;
+
+/**
+ * @brief Flush a file (or a directory) to the disk.
+ * @param file_descriptor The descriptor of the file, opened in any mode.
+ * @param data_only true to flush only the data and the metadata needed to read it back (fdatasync), false to
+ * flush all the metadata as well (fsync), as needed by a directory: the flush is then shared with the sessions
+ * flushing the same directory.
+ * @return 0 when the file is on the disk, -1 on failure.
+ */
+int SyncManager::sync(int file_descriptor, bool data_only) {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_requests_num++;
+    }
+    return data_only ? flush(file_descriptor, true) : syncDirectory(file_descriptor);
+}
+
+/**
+ * @brief Flush a file on the calling thread, counting the flushes running at the same time.
+ * @param file_descriptor The descriptor of the file.
+ * @param data_only true for fdatasync(), false for fsync().
+ * @return 0 on success, -1 on failure.
+ */
+int SyncManager::flush(int file_descriptor, bool data_only) {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_commits_num++;
+        m_active_flushes++;
+        m_max_active_flushes = max(m_max_active_flushes, m_active_flushes);
+    }
+    int result = data_only ? fdatasync(file_descriptor) : fsync(file_descriptor);
+    lock_guard<mutex> lock(m_mutex);
+    m_active_flushes--;
+    return result == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Flush a directory, or wait for a flush of the same directory started after this request.
+ * @details A flush in progress may have started before the caller renamed its file, so it does not count: the
+ * first request arrived after it becomes the leader of the next flush, the others wait for its result.
+ * @param directory_descriptor The descriptor of the directory.
+ * @return 0 when the directory is on the disk, -1 on failure.
+ */
+int SyncManager::syncDirectory(int directory_descriptor) {
+    struct stat directory_status{};
+    if (fstat(directory_descriptor, &directory_status) == -1) {
+        return -1;
+    }
+    pair<dev_t, ino_t> key(directory_status.st_dev, directory_status.st_ino);
+
+    unique_lock<mutex> lock(m_mutex);
+    DirectoryFlush &directory = m_directories[key];
+    directory.waiters++;
+    uint64_t target = directory.started + 1;
+    m_committed_cv.wait(lock, [&directory, target] { return !directory.flushing || directory.completed >= target; });
+    if (directory.completed < target) {
+        // Leader: the flush starts after every request waiting for it
+        directory.flushing = true;
+        directory.started++;
+        lock.unlock();
+        int result = flush(directory_descriptor, false);
+        lock.lock();
+        directory.result = result;
+        directory.completed = directory.started;
+        directory.flushing = false;
+        m_committed_cv.notify_all();
+    }
+    int result = directory.result;
+    if (--directory.waiters == 0) {
+        m_directories.erase(key);
+    }
+    return result;
+}
+
+/**
+ * @brief Get the number of flushes requested.
+ * @return The number of calls to sync().
+ */
+uint64_t SyncManager::getRequestsNum() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_requests_num;
+}
+
+/**
+ * @brief Get the number of flushes executed.
+ * @return The number of fdatasync() and fsync() calls, at most the number of requests.
+ */
+uint64_t SyncManager::getCommitsNum() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_commits_num;
+}
+
+/**
+ * @brief Get the highest number of flushes that have run at the same time.
+ * @return The peak of the concurrent flushes.
+ */
+unsigned int SyncManager::getMaxActiveFlushesNum() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_max_active_flushes;
+}
+
+/**
+ * @brief Get the manager shared by the sessions, creating it on the first call.
+ * @return The SyncManager instance.
+ */
+SyncManager* SyncManager::getInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    if (!m_sync_manager_instance) {
+        m_sync_manager_instance = new SyncManager();
+    }
+    return m_sync_manager_instance;
+}
+
+/**
+ * @brief Delete the manager instance, once no session is flushing files.
+ */
+void SyncManager::deleteInstance() {
+    lock_guard<mutex> lock(m_instance_mutex);
+    delete m_sync_manager_instance;
+    m_sync_manager_instance = nullptr;
+}
@@ -0,0 +1,57 @@
+#ifndef SECURE_CLOUD_STORAGE_SYNCMANAGER_H
+#define SECURE_CLOUD_STORAGE_SYNCMANAGER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+ * Durability flushes of the sessions. The data of a file is flushed by its session with its own fdatasync(), so
+ * the flushes of different files run in parallel and every session gets the error of its own file. The fsync()
+ * of a directory is group committed: the sessions that publish files in the same directory while its flush is in
+ * progress share the next flush, which starts after all of them and covers all their renames.
+ */
+class SyncManager {
+public:
+    int sync(int file_descriptor, bool data_only = false);
+    uint64_t getRequestsNum();
+    uint64_t getCommitsNum();
+    unsigned int getMaxActiveFlushesNum();
+
+    static SyncManager* getInstance();
+    static void deleteInstance();
+
+private:
+    // Group commit of the flushes of a directory
+    struct DirectoryFlush {
+        uint64_t started = 0;       // Flushes started, the next one covers the requests arrived since then
+        uint64_t completed = 0;     // Flushes completed
+        bool flushing = false;
+        int result = 0;             // Result of the last flush completed
+        unsigned int waiters = 0;   // Requests not returned yet, the entry is removed when there is none
+    };
+
+    static SyncManager* m_sync_manager_instance;
+    static mutex m_instance_mutex;
+
+    mutex m_mutex;
+    condition_variable m_committed_cv;
+    // Directories being flushed, keyed by device and inode
+    map<pair<dev_t, ino_t>, DirectoryFlush> m_directories;
+    uint64_t m_requests_num = 0;
+    uint64_t m_commits_num = 0;
+    unsigned int m_active_flushes = 0;
+    unsigned int m_max_active_flushes = 0;
+
+    SyncManager() = default;
+    int flush(int file_descriptor, bool data_only);
+    int syncDirectory(int directory_descriptor);
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_SYNCMANAGER_H
@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "UringSocketManager.h"
+#include "Config.h"
+
+/**
+ * Wrapper of the io_uring_setup() system call (no glibc wrapper is available).
+ */
+static int ioUringSetup(unsigned int entries, io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+/**
+ * Wrapper of the io_uring_enter() system call (no glibc wrapper is available).
+ */
+static int ioUringEnter(int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/**
+ * Wrapper of the io_uring_enter() system call waiting for the completions at most timeout seconds.
+ * If no operation completes in time, the call fails with ETIME.
+ */
+static int ioUringWait(int ring_fd, unsigned int to_submit, unsigned int min_complete, int timeout) {
+    __kernel_timespec timespec{timeout, 0};
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&timespec);
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                                    IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)));
+}
+
+/**
+ * Constructor for an accepted connection.
+ *
+ * @param socket_descriptor The existing socket descriptor.
+ */
+UringSocketManager::UringSocketManager(int socket_descriptor) : SocketManager(socket_descriptor) {
+}
+
+/**
+ * Client socket constructor
+ * @param server_ip IP of the server
+ * @param server_port Port of the server
+ */
+UringSocketManager::UringSocketManager(const string &server_ip, int server_port)
+        : SocketManager(server_ip, server_port) {
+}
+
+/**
+ * Destructor for the UringSocketManager class, completes the queued operations.
+ */
+UringSocketManager::~UringSocketManager() {
+    flush();
+}
+
+/**
+ * Checks once if the running kernel provides io_uring with the socket operations.
+ *
+ * @return true if io_uring can be used, false otherwise.
+ */
+bool UringSocketManager::isSupported() {
+    static const bool supported = [] {
+        io_uring_params params{};
+        int ring_fd = ioUringSetup(1, &params);
+        if (ring_fd == -1) {
+            cerr << "UringSocketManager - io_uring not available, using the POSIX transport" << endl;
+            return false;
+        }
+        close(ring_fd);
+        // IORING_OP_SEND/RECV came with the same kernel release as the fast poll feature
+        if (!(params.features & IORING_FEAT_FAST_POLL)) {
+            cerr << "UringSocketManager - io_uring too old, using the POSIX transport" << endl;
+            return false;
+        }
+        return true;
+    }();
+    return supported;
+}
+
+/**
+ * Gets the ring of the calling thread, creating it on the first call.
+ * The fallback to the blocking calls is reported once per process, not once per connection.
+ *
+ * @return The ring, or nullptr if the blocking calls must be used.
+ */
+UringSocketManager::Ring *UringSocketManager::getRing() const {
+    static thread_local Ring ring;
+    static atomic<bool> fallback_reported(false);
+    if (!ring.initialized) {
+        ring.initialized = true;
+        ring.init();
+    }
+    // The socket timeouts do not apply to the ring operations, they need a kernel able to bound the wait
+    if (ring.ring_fd == -1 || (m_timeout != 0 && !ring.bounded_wait)) {
+        if (!fallback_reported.exchange(true)) {
+            cerr << "UringSocketManager - Error during the ring creation, using blocking calls" << endl;
+        }
+        return nullptr;
+    }
+    return &ring;
+}
+
+/**
+ * Destructor of the ring of a thread, called when the thread exits.
+ */
+UringSocketManager::Ring::~Ring() {
+    release();
+}
+
+/**
+ * Creates the ring and maps its submission and completion queues.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int UringSocketManager::Ring::init() {
+    io_uring_params params{};
+    ring_fd = ioUringSetup(Config::URING_QUEUE_DEPTH, &params);
+    if (ring_fd == -1) {
+        return -1;
+    }
+    entries = params.sq_entries;
+    bounded_wait = params.features & IORING_FEAT_EXT_ARG;
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size = max(sq_ring_size, cq_ring_size);
+        cq_ring_size = 0;
+    }
+
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        sq_ring = nullptr;
+        release();
+        return -1;
+    }
+    if (single_mmap) {
+        cq_ring = sq_ring;
+    } else {
+        cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            cq_ring = nullptr;
+            release();
+            return -1;
+        }
+    }
+    void *sqes_mapping = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes_mapping == MAP_FAILED) {
+        release();
+        return -1;
+    }
+    sqes = static_cast<io_uring_sqe *>(sqes_mapping);
+
+    auto *sq_ring_bytes = static_cast<uint8_t *>(sq_ring);
+    sq_head = reinterpret_cast<unsigned int *>(sq_ring_bytes + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned int *>(sq_ring_bytes + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned int *>(sq_ring_bytes + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned int *>(sq_ring_bytes + params.sq_off.array);
+
+    auto *cq_ring_bytes = static_cast<uint8_t *>(cq_ring);
+    cq_head = reinterpret_cast<unsigned int *>(cq_ring_bytes + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned int *>(cq_ring_bytes + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned int *>(cq_ring_bytes + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq_ring_bytes + params.cq_off.cqes);
+    return 0;
+}
+
+/**
+ * Unmaps the queues and closes the ring.
+ */
+void UringSocketManager::Ring::release() {
+    if (sqes != nullptr) {
+        munmap(sqes, entries * sizeof(io_uring_sqe));
+        sqes = nullptr;
+    }
+    if (cq_ring != nullptr && cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+    }
+    cq_ring = nullptr;
+    if (sq_ring != nullptr) {
+        munmap(sq_ring, sq_ring_size);
+        sq_ring = nullptr;
+    }
+    if (ring_fd != -1) {
+        close(ring_fd);
+        ring_fd = -1;
+    }
+}
+
+/**
+ * Sends a message over the socket, together with the operations already queued.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int UringSocketManager::send(uint8_t *message_buffer, size_t message_buffer_size) {
+    if (queueSend(message_buffer, message_buffer_size) != 0) {
+        return -1;
+    }
+    return flush();
+}
+
+/**
+ * Sends a message made of several buffers, together with the operations already queued.
+ *
+ * @param buffers The buffers of the message, in order.
+ * @param buffers_num The number of buffers.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int UringSocketManager::send(const iovec *buffers, int buffers_num) {
+    if (queueSend(buffers, buffers_num) != 0) {
+        return -1;
+    }
+    return flush();
+}
+
+/**
+ * Receives a message from the socket, together with the operations already queued.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int UringSocketManager::receive(uint8_t *message_buffer, size_t message_buffer_size) {
+    int result = queueReceive(message_buffer, message_buffer_size);
+    if (result != 0) {
+        return result;
+    }
+    return flush();
+}
+
+/**
+ * Queues a message to be sent at the next flush(). The buffer must stay valid until flush() returns.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int UringSocketManager::queueSend(uint8_t *message_buffer, size_t message_buffer_size) {
+    return queueOperation(message_buffer, message_buffer_size, true);
+}
+
+/**
+ * Queues a message made of several buffers to be sent at the next flush() with a single IORING_OP_SENDMSG.
+ * The buffers must stay valid until flush() returns, the array describing them is copied.
+ *
+ * @param buffers The buffers of the message, in order.
+ * @param buffers_num The number of buffers.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int UringSocketManager::queueSend(const iovec *buffers, int buffers_num) {
+    // Without a ring the message is sent immediately
+    Ring *ring = getRing();
+    if (ring == nullptr) {
+        return SocketManager::send(buffers, buffers_num);
+    }
+
+    if (m_pending.size() == ring->entries) {
+        int result = flush();
+        if (result != 0) {
+            return result;
+        }
+    }
+    size_t message_size = 0;
+    for (int i = 0; i < buffers_num; ++i) {
+        message_size += buffers[i].iov_len;
+    }
+    m_pending.push_back({nullptr, message_size, true, 0, vector<iovec>(buffers, buffers + buffers_num), {}});
+    return 0;
+}
+
+/**
+ * Queues a message to be received at the next flush(). The buffer is filled only after flush() returns.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int UringSocketManager::queueReceive(uint8_t *message_buffer, size_t message_buffer_size) {
+    return queueOperation(message_buffer, message_buffer_size, false);
+}
+
+/**
+ * Adds an operation to the batch, flushing the batch first if the submission queue is full.
+ *
+ * @param message_buffer Pointer to the message buffer.
+ * @param message_buffer_size Size of the message buffer.
+ * @param is_send true for a send, false for a receive.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int UringSocketManager::queueOperation(uint8_t *message_buffer, size_t message_buffer_size, bool is_send) {
+    // Without a ring the operation is executed immediately
+    Ring *ring = getRing();
+    if (ring == nullptr) {
+        if (is_send) {
+            return SocketManager::send(message_buffer, message_buffer_size);
+        }
+        return SocketManager::receive(message_buffer, message_buffer_size);
+    }
+
+    if (m_pending.size() == ring->entries) {
+        int result = flush();
+        if (result != 0) {
+            return result;
+        }
+    }
+    m_pending.push_back({message_buffer, message_buffer_size, is_send, 0, {}, {}});
+    return 0;
+}
+
+/**
+ * Submits all the queued operations with a single system call and waits for their completion.
+ * The operations of the same direction are linked, so the kernel executes them in order.
+ * The operations are queued and flushed by the same thread, on its ring.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int UringSocketManager::flush() {
+    if (m_pending.empty()) {
+        return 0;
+    }
+    Ring &ring = *getRing();
+    // The completions are tagged with the flush, so that a flush failed with operations in flight cannot
+    // mix them with the ones of the next flush on the ring
+    uint64_t flush_tag = static_cast<uint64_t>(++ring.flushes_num) << 32;
+
+    // Find the last operation of each direction, which closes its chain of linked operations
+    size_t operations_num = m_pending.size();
+    size_t last_send = operations_num;
+    size_t last_receive = operations_num;
+    for (size_t i = 0; i < operations_num; ++i) {
+        (m_pending[i].is_send ? last_send : last_receive) = i;
+    }
+
+    // Fill the submission queue entries
+    unsigned int tail = *ring.sq_tail;
+    for (size_t i = 0; i < operations_num; ++i) {
+        Operation &operation = m_pending[i];
+        unsigned int index = tail & *ring.sq_mask;
+        io_uring_sqe *sqe = &ring.sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = m_socket;
+        if (operation.buffer == nullptr) {
+            // Vectored send, the message header stays valid in the pending operation until the completion
+            operation.message.msg_iov = operation.buffers.data();
+            operation.message.msg_iovlen = operation.buffers.size();
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->addr = reinterpret_cast<uint64_t>(&operation.message);
+            sqe->len = 1;
+        } else {
+            sqe->opcode = operation.is_send ? IORING_OP_SEND : IORING_OP_RECV;
+            sqe->addr = reinterpret_cast<uint64_t>(operation.buffer);
+            sqe->len = static_cast<uint32_t>(operation.size);
+        }
+        // A short transfer fails the operation and cancels the rest of its chain
+        sqe->msg_flags = MSG_WAITALL;
+        sqe->user_data = flush_tag | i;
+        if (i != last_send && i != last_receive) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+        ring.sq_array[index] = index;
+        tail++;
+    }
+    __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+
+    // Submit the batch and wait for all the completions
+    auto to_submit = static_cast<unsigned int>(operations_num);
+    size_t completed = 0;
+    bool timed_out = false;
+    while (completed < operations_num) {
+        int result = m_timeout != 0 ? ioUringWait(ring.ring_fd, to_submit, 1, m_timeout)
+                                    : ioUringEnter(ring.ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (result == -1 && errno == EINTR) {
+            continue;
+        }
+        if (result == -1 && errno != ETIME) {
+            cerr << "UringSocketManager - Error while submitting the operations!" << endl;
+            m_pending.clear();
+            return -1;
+        }
+        if (result > 0) {
+            to_submit -= min(to_submit, static_cast<unsigned int>(result));
+        }
+
+        size_t completed_before = completed;
+        unsigned int head = *ring.cq_head;
+        while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe &cqe = ring.cqes[head & *ring.cq_mask];
+            if ((cqe.user_data & ~0xFFFFFFFFULL) == flush_tag) {
+                m_pending[cqe.user_data & 0xFFFFFFFFULL].result = cqe.res;
+                completed++;
+            }
+            head++;
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+
+        // A bounded wait without completions expired (the error is not reported if the call also submitted)
+        if (m_timeout != 0 && completed == completed_before && !timed_out) {
+            // The peer is stalled: shutting down the socket completes the operations still in flight
+            cerr << "UringSocketManager - Timeout while waiting for the operations!" << endl;
+            shutdown(m_socket, SHUT_RDWR);
+            timed_out = true;
+        }
+    }
+
+    if (timed_out) {
+        m_pending.clear();
+        return -1;
+    }
+
+    // Complete the short or cancelled operations in their original order
+    int result = 0;
+    for (Operation &operation : m_pending) {
+        if (result == 0) {
+            result = completeOperation(operation);
+        }
+    }
+    m_pending.clear();
+    return result;
+}
+
+/**
+ * Checks the outcome of an operation, transferring the remaining bytes with a blocking call if the
+ * kernel stopped it early.
+ *
+ * @param operation The completed operation.
+ *
+ * @return 0 on success, -1 on error, -2 if the connection has been closed.
+ */
+int UringSocketManager::completeOperation(UringSocketManager::Operation &operation) {
+    if (operation.result == 0 && !operation.is_send && operation.size != 0) {
+        cout << "SocketManager - Connection closed!" << endl;
+        return -2;
+    }
+    if (operation.result < 0 && operation.result != -ECANCELED && operation.result != -EINTR &&
+        operation.result != -EAGAIN) {
+        cerr << "UringSocketManager - Error while " << (operation.is_send ? "sending" : "receiving")
+             << " the message: " << strerror(-operation.result) << endl;
+        return -1;
+    }
+
+    size_t transferred = operation.result > 0 ? static_cast<size_t>(operation.result) : 0;
+    if (transferred == operation.size) {
+        return 0;
+    }
+    if (operation.buffer == nullptr) {
+        // Skip the buffers already sent and send the rest of the message
+        size_t first = 0;
+        while (transferred >= operation.buffers[first].iov_len) {
+            transferred -= operation.buffers[first].iov_len;
+            first++;
+        }
+        operation.buffers[first].iov_base = static_cast<uint8_t *>(operation.buffers[first].iov_base) + transferred;
+        operation.buffers[first].iov_len -= transferred;
+        return SocketManager::send(&operation.buffers[first], static_cast<int>(operation.buffers.size() - first));
+    }
+    if (operation.is_send) {
+        return SocketManager::send(operation.buffer + transferred, operation.size - transferred);
+    }
+    return SocketManager::receive(operation.buffer + transferred, operation.size - transferred);
+}
@@ -0,0 +1,97 @@
+#ifndef SECURE_CLOUD_STORAGE_URINGSOCKETMANAGER_H
+#define SECURE_CLOUD_STORAGE_URINGSOCKETMANAGER_H
+
+#include <vector>
+#include <sys/socket.h>
+#include "SocketManager.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * SocketManager backed by io_uring. Sends and receives can be queued and submitted together
+ * with a single io_uring_enter() call, which also waits for their completion. The operations of the same
+ * direction are linked, so they are executed in the order they were queued.
+ * The ring is not owned by the socket: each thread creates one on its first flush and shares it with all the
+ * sockets it serves, since a flush completes all its operations before returning. Idle sessions hold no ring.
+ * If the ring cannot be created, the blocking POSIX calls of the base class are used.
+ */
+class UringSocketManager : public SocketManager {
+
+public:
+    explicit UringSocketManager(int socket_descriptor);
+
+    UringSocketManager(const string& server_ip, int server_port);
+
+    ~UringSocketManager() override;
+
+    static bool isSupported();
+
+    int send(uint8_t *message_buffer, size_t message_buffer_size) override;
+
+    int receive(uint8_t *message_buffer, size_t message_buffer_size) override;
+
+    int send(const iovec *buffers, int buffers_num) override;
+
+    int queueSend(uint8_t *message_buffer, size_t message_buffer_size) override;
+
+    int queueSend(const iovec *buffers, int buffers_num) override;
+
+    int queueReceive(uint8_t *message_buffer, size_t message_buffer_size) override;
+
+    int flush() override;
+
+private:
+    struct Operation {
+        uint8_t *buffer;
+        size_t size;
+        bool is_send;
+        int result;
+        // Buffers of a vectored send (buffer is null), described to the kernel by message
+        vector<iovec> buffers;
+        msghdr message;
+    };
+
+    // io_uring instance of a thread, created on its first use and released when the thread exits
+    struct Ring {
+        int ring_fd = -1;
+        unsigned int entries = 0;
+        bool initialized = false;
+        bool bounded_wait = false;  // The kernel can bound the wait for the completions (IORING_FEAT_EXT_ARG)
+        uint32_t flushes_num = 0;   // Tags the completions of each flush
+
+        // Submission queue ring
+        void *sq_ring = nullptr;
+        size_t sq_ring_size = 0;
+        unsigned int *sq_head = nullptr;
+        unsigned int *sq_tail = nullptr;
+        unsigned int *sq_mask = nullptr;
+        unsigned int *sq_array = nullptr;
+        io_uring_sqe *sqes = nullptr;
+
+        // Completion queue ring (may share the mapping of the submission queue ring)
+        void *cq_ring = nullptr;
+        size_t cq_ring_size = 0;
+        unsigned int *cq_head = nullptr;
+        unsigned int *cq_tail = nullptr;
+        unsigned int *cq_mask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+
+        ~Ring();
+
+        int init();
+
+        void release();
+    };
+
+    vector<Operation> m_pending;
+
+    Ring *getRing() const;
+
+    int queueOperation(uint8_t *message_buffer, size_t message_buffer_size, bool is_send);
+
+    int completeOperation(Operation &operation);
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_URINGSOCKETMANAGER_H
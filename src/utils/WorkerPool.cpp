@@ -0,0 +1,120 @@
+#include <iostream>
+#include "WorkerPool.h"
+
+/**
+ * @brief Constructor for the WorkerPool class, starts the worker threads.
+ * @param workers_num The number of worker threads (at least one is always started).
+ * @param queue_capacity The max number of pending tasks, 0 for an unbounded queue.
+ */
+WorkerPool::WorkerPool(unsigned int workers_num, size_t queue_capacity) : m_queue_capacity(queue_capacity) {
+    if (workers_num == 0) {
+        workers_num = 1;
+    }
+    m_workers.reserve(workers_num);
+    for (unsigned int i = 0; i < workers_num; ++i) {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Destructor for the WorkerPool class, waits for the queued tasks and joins the workers.
+ */
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+/**
+ * @brief Queue a task to be executed by a worker.
+ * @details If the queue is bounded and full, the caller is blocked until a worker picks up a task.
+ * @param task The task to execute.
+ * @return true if the task has been queued, false if the pool is shutting down.
+ */
+bool WorkerPool::submit(function<void()> task) {
+    unique_lock<mutex> lock(m_mutex);
+    m_slot_cv.wait(lock, [this] {
+        return m_stopping || m_queue_capacity == 0 || m_tasks.size() < m_queue_capacity;
+    });
+    if (m_stopping) {
+        return false;
+    }
+    m_tasks.push_back(std::move(task));
+    m_task_cv.notify_one();
+    return true;
+}
+
+/**
+ * @brief Stop accepting new tasks, wait for the queued ones to complete and join the workers.
+ */
+void WorkerPool::shutdown() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_stopping && m_workers.empty()) {
+            return;
+        }
+        m_stopping = true;
+    }
+    m_task_cv.notify_all();
+    m_slot_cv.notify_all();
+
+    for (auto &worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+/**
+ * @brief Get the number of worker threads.
+ * @return The number of workers.
+ */
+unsigned int WorkerPool::getWorkersNum() const {
+    return m_workers.size();
+}
+
+/**
+ * @brief Get the number of tasks waiting for a free worker.
+ * @return The number of pending tasks.
+ */
+size_t WorkerPool::getPendingTasksNum() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_tasks.size();
+}
+
+/**
+ * @brief Get the number of tasks currently executed by the workers.
+ * @return The number of running tasks.
+ */
+size_t WorkerPool::getActiveTasksNum() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_active_tasks;
+}
+
+/**
+ * @brief Worker thread body: executes the queued tasks until the pool is stopped and the queue is empty.
+ */
+void WorkerPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_task_cv.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_active_tasks++;
+        }
+        m_slot_cv.notify_one();
+
+        try {
+            task();
+        } catch (...) {
+            cerr << "WorkerPool - Unhandled exception in a task!" << endl;
+        }
+
+        lock_guard<mutex> lock(m_mutex);
+        m_active_tasks--;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SECURE_CLOUD_STORAGE_WORKERPOOL_H
+#define SECURE_CLOUD_STORAGE_WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Fixed-size pool of worker threads fed by a task queue. The number of threads never changes after the
+ * construction, so finished tasks do not leave any thread handle behind. The queue can be bounded: in
+ * that case submit() blocks the producer until a slot is released.
+ */
+class WorkerPool {
+
+public:
+    WorkerPool(unsigned int workers_num, size_t queue_capacity);
+
+    ~WorkerPool();
+
+    bool submit(function<void()> task);
+
+    void shutdown();
+
+    unsigned int getWorkersNum() const;
+
+    size_t getPendingTasksNum();
+
+    size_t getActiveTasksNum();
+
+private:
+    vector<thread> m_workers;
+    deque<function<void()>> m_tasks;
+    size_t m_queue_capacity;    // 0 means unbounded
+    size_t m_active_tasks = 0;
+    bool m_stopping = false;
+
+    mutex m_mutex;
+    condition_variable m_task_cv;   // Signaled when a task is queued or the pool is stopped
+    condition_variable m_slot_cv;   // Signaled when a queue slot is released
+
+    void workerLoop();
+};
+
+
+#endif //SECURE_CLOUD_STORAGE_WORKERPOOL_H
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <iomanip>
 #include "AesGcm.h"
+#include "SessionCipher.h"
 #include "Config.h"
 
 using namespace std;
@@ -130,6 +131,139 @@ void testEncryptionAndDecryption(AesGcm &aesGcm, const char *plaintext, int plai
     cout << "--------------------------------------------" << endl;
 }
 
+void testSessionCipher(unsigned char *key) {
+    const char plaintext[] = "Hello, this is a test!";
+    int plaintext_len = static_cast<int>(strlen(plaintext));
+    unsigned char aad[Config::AAD_LEN] = {0, 0, 0, 7};
+
+    SessionCipher client_cipher(key, SessionCipher::Role::CLIENT);
+    SessionCipher server_cipher(key, SessionCipher::Role::SERVER);
+
+    // Encrypt two messages with the client cipher
+    unsigned char iv_1[Config::IV_LEN];
+    unsigned char iv_2[Config::IV_LEN];
+    unsigned char ciphertext[sizeof(plaintext)];
+    unsigned char tag[Config::AES_TAG_LEN];
+    int res = client_cipher.encrypt(8, (unsigned char *) plaintext, plaintext_len, aad, Config::AAD_LEN,
+                                    iv_2, ciphertext, tag);
+    assert(res == plaintext_len);
+    res = client_cipher.encrypt(7, (unsigned char *) plaintext, plaintext_len, aad, Config::AAD_LEN,
+                                iv_1, ciphertext, tag);
+    assert(res == plaintext_len);
+
+    // The IVs share the salt of the direction and end with the counter
+    assert(memcmp(iv_1, iv_2, Config::IV_SALT_LEN) == 0);
+    assert(iv_1[Config::IV_LEN - 1] == 7 && iv_2[Config::IV_LEN - 1] == 8);
+    unsigned char server_iv[Config::IV_LEN];
+    server_cipher.buildIV(7, server_iv);
+    assert(memcmp(iv_1, server_iv, Config::IV_LEN) != 0);
+    cout << "Counter-derived IVs differ by counter and direction" << endl;
+
+    // Decrypt with the cipher of the other side and with a copy of it
+    unsigned char decrypted_text[sizeof(plaintext)] = {};
+    res = server_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv_1, tag, decrypted_text);
+    assert(res == plaintext_len);
+    assert(memcmp(plaintext, decrypted_text, plaintext_len) == 0);
+    SessionCipher server_cipher_copy(server_cipher);
+    res = server_cipher_copy.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv_1, tag, decrypted_text);
+    assert(res == plaintext_len);
+    cout << "Decrypted plaintext: " << decrypted_text << endl;
+
+    // A message cannot be decrypted with the IV of another counter
+    res = server_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv_2, tag, decrypted_text);
+    assert(res == -1);
+
+    // A plaintext split in two parts is encrypted as the whole one
+    unsigned char split_ciphertext[sizeof(plaintext)];
+    unsigned char split_tag[Config::AES_TAG_LEN];
+    res = client_cipher.encrypt(7, (unsigned char *) plaintext, 5, (unsigned char *) plaintext + 5,
+                                plaintext_len - 5, aad, Config::AAD_LEN, iv_2, split_ciphertext, split_tag);
+    assert(res == plaintext_len);
+    assert(memcmp(ciphertext, split_ciphertext, plaintext_len) == 0);
+    assert(memcmp(tag, split_tag, Config::AES_TAG_LEN) == 0);
+    cout << "Split plaintext encrypted as the whole one" << endl;
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testCipherSuites(unsigned char *key) {
+    const char plaintext[] = "Hello, this is a test!";
+    int plaintext_len = static_cast<int>(strlen(plaintext));
+    unsigned char aad[Config::AAD_LEN] = {0, 0, 0, 3};
+
+    assert(SessionCipher::isSupported(static_cast<uint8_t>(CipherSuite::AES_128_GCM)));
+    assert(SessionCipher::isSupported(static_cast<uint8_t>(CipherSuite::CHACHA20_POLY1305)));
+    assert(!SessionCipher::isSupported(0xff));
+
+    // Round trip with ChaCha20-Poly1305
+    SessionCipher client_cipher(key, SessionCipher::Role::CLIENT, CipherSuite::CHACHA20_POLY1305);
+    SessionCipher server_cipher(key, SessionCipher::Role::SERVER, CipherSuite::CHACHA20_POLY1305);
+    assert(server_cipher.getSuite() == CipherSuite::CHACHA20_POLY1305);
+    unsigned char iv[Config::IV_LEN];
+    unsigned char ciphertext[sizeof(plaintext)];
+    unsigned char tag[Config::AES_TAG_LEN];
+    int res = client_cipher.encrypt(3, (unsigned char *) plaintext, plaintext_len, aad, Config::AAD_LEN,
+                                    iv, ciphertext, tag);
+    assert(res == plaintext_len);
+    unsigned char decrypted_text[sizeof(plaintext)] = {};
+    res = server_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv, tag, decrypted_text);
+    assert(res == plaintext_len);
+    assert(memcmp(plaintext, decrypted_text, plaintext_len) == 0);
+    cout << "Decrypted plaintext: " << decrypted_text << endl;
+
+    // A peer using another suite cannot decrypt the message
+    SessionCipher aes_cipher(key, SessionCipher::Role::SERVER, CipherSuite::AES_128_GCM);
+    res = aes_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv, tag, decrypted_text);
+    assert(res == -1);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testRekey(unsigned char *key) {
+    const char plaintext[] = "Hello, this is a test!";
+    int plaintext_len = static_cast<int>(strlen(plaintext));
+    unsigned char aad[Config::AAD_LEN] = {};
+
+    // Both sides derive the same next key, different from the current one
+    unsigned char client_next_key[Config::AES_KEY_LEN];
+    unsigned char server_next_key[Config::AES_KEY_LEN];
+    int res = SessionCipher::deriveNextKey(key, client_next_key);
+    assert(res == 0);
+    res = SessionCipher::deriveNextKey(key, server_next_key);
+    assert(res == 0);
+    assert(memcmp(client_next_key, server_next_key, Config::AES_KEY_LEN) == 0);
+    assert(memcmp(client_next_key, key, Config::AES_KEY_LEN) != 0);
+
+    // The messages encrypted with the next key are decrypted only with the next key
+    SessionCipher client_cipher(client_next_key, SessionCipher::Role::CLIENT);
+    SessionCipher server_cipher(server_next_key, SessionCipher::Role::SERVER);
+    SessionCipher old_server_cipher(key, SessionCipher::Role::SERVER);
+    unsigned char iv[Config::IV_LEN];
+    unsigned char ciphertext[sizeof(plaintext)];
+    unsigned char tag[Config::AES_TAG_LEN];
+    res = client_cipher.encrypt(0, (unsigned char *) plaintext, plaintext_len, aad, Config::AAD_LEN,
+                                iv, ciphertext, tag);
+    assert(res == plaintext_len);
+    unsigned char decrypted_text[sizeof(plaintext)] = {};
+    res = old_server_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv, tag, decrypted_text);
+    assert(res == -1);
+    res = server_cipher.decrypt(ciphertext, plaintext_len, aad, Config::AAD_LEN, iv, tag, decrypted_text);
+    assert(res == plaintext_len);
+    assert(memcmp(plaintext, decrypted_text, plaintext_len) == 0);
+
+    // The interval bounds both the messages and the bytes protected by a key
+    assert(SessionCipher::getRekeyInterval(Config::MIN_CHUNK_SIZE) ==
+           min<uint64_t>(Config::REKEY_MESSAGES, Config::REKEY_BYTES / Config::MIN_CHUNK_SIZE));
+    assert(SessionCipher::getRekeyInterval(Config::MAX_CHUNK_SIZE) == Config::REKEY_BYTES / Config::MAX_CHUNK_SIZE);
+    cout << "Messages per key with the default chunk size: " << SessionCipher::getRekeyInterval(Config::CHUNK_SIZE)
+         << endl;
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
 int main() {
     unsigned char key[] = "0123456789abcdef";
     AesGcm aesGcm = AesGcm(key);
@@ -169,6 +303,18 @@ int main() {
     testEncryptionAndDecryption(aesGcm, plaintext, plaintext_len,
                                 aad, aad_len, 5);
 
+    // Session cipher with persistent contexts and counter-derived IVs
+    cout << "Running Test Scenario 6 (session cipher): \n" << endl;
+    testSessionCipher(key);
+
+    // Session messages encrypted with the ChaCha20-Poly1305 suite
+    cout << "Running Test Scenario 7 (cipher suites): \n" << endl;
+    testCipherSuites(key);
+
+    // Next session key derived with HKDF
+    cout << "Running Test Scenario 8 (rekey): \n" << endl;
+    testRekey(key);
+
     return 0;
 }
 
@@ -3,6 +3,8 @@
 #include <vector>
 #include <openssl/pem.h>
 #include <cassert>
+#include <filesystem>
+#include <thread>
 
 #include "../src/crypto/CertificateManager.h"
 
@@ -54,6 +56,51 @@ void serializeDeserializeCertificateTest(CertificateManager* certificate_manager
 
 }
 
+void serverCertificateTest() {
+    cout << "CertificateManagerTest - concurrent get instance test " << endl;
+    CertificateManager* instances[8] = {};
+    vector<thread> threads;
+    for (auto& instance : instances) {
+        threads.emplace_back([&instance] { instance = CertificateManager::getInstance(); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& instance : instances) {
+        assert(instance == CertificateManager::getInstance());
+    }
+    cout << "+TEST OK+" << endl;
+
+    cout << "CertificateManagerTest - server certificate test " << endl;
+    const uint8_t* serialized_certificate = nullptr;
+    int serialized_certificate_size = 0;
+    assert(CertificateManager::getInstance()->getServerCertificate(serialized_certificate,
+                                                                   serialized_certificate_size) == 0);
+    // The certificate is serialized once, the next calls return the same buffer
+    const uint8_t* cached_certificate = nullptr;
+    int cached_certificate_size = 0;
+    assert(CertificateManager::getInstance()->getServerCertificate(cached_certificate, cached_certificate_size) == 0);
+    assert(cached_certificate == serialized_certificate && cached_certificate_size == serialized_certificate_size);
+    X509* certificate = CertificateManager::getInstance()->deserializeCertificate(serialized_certificate,
+                                                                                  serialized_certificate_size);
+    assert(certificate != nullptr);
+    cout << "+TEST OK+" << endl;
+
+    cout << "CertificateManagerTest - verified certificate cache test " << endl;
+    // The second verification is answered by the cache
+    assert(CertificateManager::getInstance()->verifyCertificate(certificate));
+    assert(CertificateManager::getInstance()->verifyCertificate(certificate));
+    // A modified CRL file forgets the cache, the certificate is verified again with the new store
+    const char* crl_path = "../resources/certificates/CA_crl.pem";
+    auto crl_mtime = filesystem::last_write_time(crl_path);
+    filesystem::last_write_time(crl_path, crl_mtime + chrono::seconds(1));
+    assert(CertificateManager::getInstance()->verifyCertificate(certificate));
+    filesystem::last_write_time(crl_path, crl_mtime);
+    assert(CertificateManager::getInstance()->getFingerprint(certificate).size() == 32);
+    X509_free(certificate);
+    cout << "+TEST OK+\n" << endl;
+}
+
 
 int main() {
     cout<< "********************************\n"
@@ -63,6 +110,9 @@ int main() {
     //create Instance test(constructor)
     CertificateManager* certificate_manager = getInstanceTest();
 
+    //Serialized server certificate shared by the sessions
+    serverCertificateTest();
+
     //Make the tests on all the certificates
 
     //List of certificate names
@@ -0,0 +1,81 @@
+#include "CryptoExecutor.h"
+#include "Config.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void testRun() {
+    CryptoExecutor* executor = CryptoExecutor::getInstance();
+    assert(executor == CryptoExecutor::getInstance());
+    assert(executor->getWorkersNum() == Config::CRYPTO_WORKERS);
+
+    // The result of the task is returned to the caller, which is not the thread running the task
+    thread::id caller_id = this_thread::get_id();
+    thread::id worker_id;
+    int res = executor->run([&worker_id] {
+        worker_id = this_thread::get_id();
+        return 42;
+    });
+    assert(res == 42);
+    assert(worker_id != caller_id);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testBoundedConcurrency() {
+    CryptoExecutor* executor = CryptoExecutor::getInstance();
+    CryptoExecutor::Metrics initial_metrics = executor->getMetrics();
+
+    // Many sessions submit their operations at the same time, at most CRYPTO_WORKERS run together
+    const unsigned int sessions_num = 4 * Config::CRYPTO_WORKERS;
+    atomic<unsigned int> running{0};
+    atomic<unsigned int> max_running{0};
+    vector<thread> sessions;
+    for (unsigned int i = 0; i < sessions_num; ++i) {
+        sessions.emplace_back([executor, &running, &max_running, i] {
+            int res = executor->run([&running, &max_running, i] {
+                unsigned int now_running = ++running;
+                unsigned int observed = max_running;
+                while (now_running > observed && !max_running.compare_exchange_weak(observed, now_running)) {}
+                this_thread::sleep_for(chrono::milliseconds(20));
+                --running;
+                return static_cast<int>(i);
+            });
+            assert(res == static_cast<int>(i));
+        });
+    }
+    for (auto& session : sessions) {
+        session.join();
+    }
+    cout << "Max operations running together: " << max_running << endl;
+    assert(max_running <= Config::CRYPTO_WORKERS);
+
+    // Every operation is counted, and some of them waited in the queue
+    CryptoExecutor::Metrics metrics = executor->getMetrics();
+    assert(metrics.tasks_num == initial_metrics.tasks_num + sessions_num);
+    assert(metrics.max_wait_time > 0 && metrics.total_run_time >= sessions_num * 20000);
+    assert(metrics.pending_tasks_num == 0);
+    cout << "Average wait: " << metrics.total_wait_time / metrics.tasks_num << " us, max wait: "
+         << metrics.max_wait_time << " us" << endl;
+
+    CryptoExecutor::deleteInstance();
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+
+    cout << "\nRunning Test Scenario 1: \n" << endl;
+    testRun();
+
+    cout << "\nRunning Test Scenario 2: \n" << endl;
+    testBoundedConcurrency();
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <openssl/dh.h>
 #include <cstring>
 #include "../src/crypto/DiffieHellman.h"
+#include "Config.h"
 #include "iostream"
 
 using namespace std;
@@ -98,6 +99,50 @@ void deriveSharedSecretTest() {
     delete dh_instance_2;
 }
 
+void x25519KeyExchangeTest() {
+    DiffieHellman * dh_instance_1 = new DiffieHellman(KeyExchange::X25519);
+    DiffieHellman * dh_instance_2 = new DiffieHellman(KeyExchange::X25519);
+    assert(dh_instance_1->getDhParameters() == nullptr);
+    EVP_PKEY *ephemeral_key_1 = dh_instance_1->generateEphemeralKey();
+    EVP_PKEY *ephemeral_key_2 = dh_instance_2->generateEphemeralKey();
+    assert(ephemeral_key_1 != nullptr && ephemeral_key_2 != nullptr);
+
+    // The public value is serialized in its 32 raw bytes
+    uint8_t* serialized_ephemeral_key = nullptr;
+    int serialized_ephemeral_key_size = -1;
+    int result = dh_instance_1->serializeEphemeralKey(ephemeral_key_1, serialized_ephemeral_key,
+                                                      serialized_ephemeral_key_size);
+    assert(result == 0);
+    assert(serialized_ephemeral_key_size == static_cast<int>(Config::X25519_KEY_LEN));
+    EVP_PKEY* deserialized_ephemeral_key = dh_instance_2->deserializeEphemeralKey(serialized_ephemeral_key,
+                                                                                 serialized_ephemeral_key_size);
+    assert(deserialized_ephemeral_key != nullptr);
+    // A public value of another size is rejected
+    assert(dh_instance_2->deserializeEphemeralKey(serialized_ephemeral_key, serialized_ephemeral_key_size - 1)
+           == nullptr);
+
+    unsigned char *shared_secret_1, *shared_secret_2;
+    size_t shared_secret_size_1, shared_secret_size_2;
+    result = dh_instance_2->deriveSharedSecret(ephemeral_key_2, deserialized_ephemeral_key, shared_secret_2,
+                                               shared_secret_size_2);
+    assert(result == 0);
+    result = dh_instance_1->deriveSharedSecret(ephemeral_key_1, ephemeral_key_2, shared_secret_1,
+                                               shared_secret_size_1);
+    assert(result == 0);
+    assert(shared_secret_size_1 == shared_secret_size_2);
+    assert(memcmp(shared_secret_1, shared_secret_2, shared_secret_size_1) == 0);
+    cout << "x25519KeyExchangeTest() passed!" << endl;
+
+    delete[] shared_secret_1;
+    delete[] shared_secret_2;
+    delete[] serialized_ephemeral_key;
+    EVP_PKEY_free(deserialized_ephemeral_key);
+    EVP_PKEY_free(ephemeral_key_1);
+    EVP_PKEY_free(ephemeral_key_2);
+    delete dh_instance_1;
+    delete dh_instance_2;
+}
+
 int main() {
     GenerateLowLevelStructureTest();
     loadDHParametersTest();
@@ -105,5 +150,6 @@ int main() {
     serializeEphemeralKeyTest();
     deserializeEphemeralKeyTest();
     deriveSharedSecretTest();
+    x25519KeyExchangeTest();
     return 0;
 }
@@ -142,8 +142,48 @@ void isDSVerifiedTest(){
     BN_free(e);
 }
 
+void ed25519Test() {
+    DigitalSignatureManager signatureManager;
+
+    // Generate an Ed25519 key pair, the public key is extracted in raw format
+    EVP_PKEY* private_key = EVP_PKEY_Q_keygen(nullptr, nullptr, "ED25519");
+    assert(private_key != nullptr);
+    unsigned char raw_public_key[32];
+    size_t raw_public_key_size = sizeof(raw_public_key);
+    assert(EVP_PKEY_get_raw_public_key(private_key, raw_public_key, &raw_public_key_size) == 1);
+    EVP_PKEY* public_key = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr, raw_public_key,
+                                                       raw_public_key_size);
+    assert(public_key != nullptr);
+    cout << "ed25519Test() - Ed25519 key pair generated" << endl;
+
+    // Input data
+    unsigned char input_buffer[] = "Hello, World!";
+    long int input_buffer_size = sizeof(input_buffer);
+
+    // Sign and verify, the signature is 64 bytes long
+    unsigned char* digital_signature = nullptr;
+    unsigned int digital_signature_size = 0;
+    signatureManager.generateDS(input_buffer, input_buffer_size, digital_signature, digital_signature_size,
+                                private_key);
+    assert(digital_signature_size == 64);
+    cout << "ed25519Test() - Digital Signature Size: " << digital_signature_size << endl;
+    assert(signatureManager.isDSverified(input_buffer, input_buffer_size, digital_signature,
+                                         digital_signature_size, public_key));
+
+    // A modified input is not verified
+    input_buffer[0] ^= 1;
+    assert(!signatureManager.isDSverified(input_buffer, input_buffer_size, digital_signature,
+                                          digital_signature_size, public_key));
+    cout << "ed25519Test() passed!" << endl;
+
+    delete[] digital_signature;
+    EVP_PKEY_free(private_key);
+    EVP_PKEY_free(public_key);
+}
+
 int main() {
     generateDSTest();
     isDSVerifiedTest();
+    ed25519Test();
     return 0;
 }
@@ -0,0 +1,77 @@
+#include "EphemeralKeyPool.h"
+#include "DiffieHellman.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+void testPoolRefilled() {
+    EphemeralKeyPool* pool = EphemeralKeyPool::getInstance();
+
+    // Wait for the generators to fill the X25519 pool
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(30);
+    while (pool->getAvailableKeysNum(KeyExchange::X25519) < pool->getCapacity() &&
+           chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    cout << "Ready X25519 keys: " << pool->getAvailableKeysNum(KeyExchange::X25519) << endl;
+    assert(pool->getAvailableKeysNum(KeyExchange::X25519) == pool->getCapacity());
+
+    // A taken key is replaced
+    EVP_PKEY* key = pool->acquire(KeyExchange::X25519);
+    assert(key != nullptr);
+    deadline = chrono::steady_clock::now() + chrono::seconds(30);
+    while (pool->getAvailableKeysNum(KeyExchange::X25519) < pool->getCapacity() &&
+           chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    assert(pool->getAvailableKeysNum(KeyExchange::X25519) == pool->getCapacity());
+    EVP_PKEY_free(key);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testKeysUsable() {
+    EphemeralKeyPool* pool = EphemeralKeyPool::getInstance();
+
+    for (KeyExchange key_exchange : {KeyExchange::FFDHE_2048, KeyExchange::X25519}) {
+        // Two keys of the same group are different and agree on a shared secret
+        DiffieHellman dh_instance(key_exchange);
+        EVP_PKEY* key_1 = pool->acquire(key_exchange);
+        EVP_PKEY* key_2 = pool->acquire(key_exchange);
+        assert(key_1 != nullptr && key_2 != nullptr);
+        assert(EVP_PKEY_eq(key_1, key_2) != 1);
+
+        unsigned char *shared_secret_1, *shared_secret_2;
+        size_t shared_secret_size_1, shared_secret_size_2;
+        int res = dh_instance.deriveSharedSecret(key_1, key_2, shared_secret_1, shared_secret_size_1);
+        assert(res == 0);
+        res = dh_instance.deriveSharedSecret(key_2, key_1, shared_secret_2, shared_secret_size_2);
+        assert(res == 0);
+        assert(shared_secret_size_1 == shared_secret_size_2);
+        assert(memcmp(shared_secret_1, shared_secret_2, shared_secret_size_1) == 0);
+
+        delete[] shared_secret_1;
+        delete[] shared_secret_2;
+        EVP_PKEY_free(key_1);
+        EVP_PKEY_free(key_2);
+    }
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+
+    cout << "\nRunning Test Scenario 1: \n" << endl;
+    testPoolRefilled();
+
+    cout << "\nRunning Test Scenario 2: \n" << endl;
+    testKeysUsable();
+
+    EphemeralKeyPool::deleteInstance();
+    return 0;
+}
@@ -72,6 +72,12 @@ void testReadAndWriteChunks() {
     streamsize lastChunkSize = fm_read.getLastChunkSize();
     cout << "Last chunk size in bytes: " << lastChunkSize << endl;
     assert(lastChunkSize == 50 * Config::KB_SIZE);
+    // Check the chunks with the smallest negotiable chunk size
+    fm_read.initFileInfo(fm_read.getFileSize(), Config::MIN_CHUNK_SIZE);
+    assert(fm_read.getChunkSize() == Config::MIN_CHUNK_SIZE);
+    assert(fm_read.getChunksNum() == size / Config::MIN_CHUNK_SIZE + 1);
+    assert(fm_read.getLastChunkSize() == size % Config::MIN_CHUNK_SIZE);
+    fm_read.initFileInfo(fm_read.getFileSize());
 
     // Open another file in write mode to copy the content
     FileManager fm_write("test_2_copy.txt", FileManager::OpenMode::WRITE);
@@ -182,6 +188,145 @@ void testIsStringValid() {
     cout << "--------------------------------------------" << endl;
 }
 
+void testWriteRanges() {
+    const char first_range[] = "Hello, ";
+    const char second_range[] = "World!";
+    string file_path = "test_3.txt";
+
+    // Allocate the file with its final size
+    cout << "Allocating test_3.txt file" << endl;
+    streamsize file_size = static_cast<streamsize>(strlen(first_range) + strlen(second_range));
+    int res = FileManager::allocateFile(file_path, file_size);
+    assert(res == 0);
+    assert(FileManager::computeFileSize(file_path) == file_size);
+    // An existing file cannot be allocated again
+    res = FileManager::allocateFile(file_path, file_size);
+    assert(res == -1);
+
+    // Write the ranges in reverse order
+    cout << "Writing the ranges of test_3.txt file" << endl;
+    FileManager fm_second(file_path, FileManager::OpenMode::UPDATE);
+    res = fm_second.seek(static_cast<streamsize>(strlen(first_range)));
+    assert(res == 0);
+    res = fm_second.writeChunk((uint8_t *) second_range, static_cast<streamsize>(strlen(second_range)));
+    assert(res == 0);
+    fm_second.closeFile();
+    FileManager fm_first(file_path, FileManager::OpenMode::UPDATE);
+    res = fm_first.writeChunk((uint8_t *) first_range, static_cast<streamsize>(strlen(first_range)));
+    assert(res == 0);
+    fm_first.closeFile();
+
+    // Read the second range
+    cout << "Reading the second range of test_3.txt file" << endl;
+    FileManager fm_read(file_path, FileManager::OpenMode::READ);
+    assert(fm_read.getFileSize() == file_size);
+    char range[sizeof(second_range)] = {};
+    res = fm_read.seek(static_cast<streamsize>(strlen(first_range)));
+    assert(res == 0);
+    res = fm_read.readChunk(reinterpret_cast<uint8_t *>(range), static_cast<streamsize>(strlen(second_range)));
+    assert(res == 0);
+    assert(strcmp(range, second_range) == 0);
+    fm_read.seek(0);
+    char content[sizeof(first_range) + sizeof(second_range)] = {};
+    fm_read.readChunk(reinterpret_cast<uint8_t *>(content), file_size);
+    cout << "Data read from file: " << content << endl;
+    assert(strcmp(content, "Hello, World!") == 0);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+
+    // Delete the file
+    remove("test_3.txt");
+}
+
+void testMappedRead() {
+    const char content[] = "Hello, World!";
+    auto content_len = static_cast<streamsize>(strlen(content));
+    string file_path = "test_4.txt";
+
+    // Write the file
+    FileManager fm_write(file_path, FileManager::OpenMode::WRITE);
+    int res = fm_write.writeChunk((uint8_t *) content, content_len);
+    assert(res == 0);
+    fm_write.closeFile();
+
+    // Map the file and access the chunks in place
+    cout << "Mapping test_4.txt file" << endl;
+    FileManager fm_mapped(file_path, FileManager::OpenMode::MAPPED_READ);
+    assert(fm_mapped.isMapped());
+    assert(fm_mapped.getFileSize() == content_len && fm_mapped.getChunksNum() == 1);
+    const uint8_t *first_chunk = fm_mapped.mapChunk(7);
+    assert(first_chunk != nullptr && memcmp(first_chunk, "Hello, ", 7) == 0);
+    const uint8_t *second_chunk = fm_mapped.mapChunk(content_len - 7);
+    assert(second_chunk == first_chunk + 7 && memcmp(second_chunk, "World!", 6) == 0);
+    // No chunk beyond the end of the file
+    assert(fm_mapped.mapChunk(1) == nullptr);
+
+    // Seek and copy a chunk as in READ mode
+    res = fm_mapped.seek(7);
+    assert(res == 0);
+    char range[7] = {};
+    res = fm_mapped.readChunk(reinterpret_cast<uint8_t *>(range), 6);
+    assert(res == 0);
+    cout << "Data read from file: " << range << endl;
+    assert(strcmp(range, "World!") == 0);
+    res = fm_mapped.seek(content_len + 1);
+    assert(res == -1);
+    fm_mapped.closeFile();
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+
+    // Delete the file
+    remove("test_4.txt");
+}
+
+void testCommitFile() {
+    const char content[] = "Hello, World!";
+    string file_path = "test_5.txt";
+    string temporary_path = FileManager::getTemporaryPath(file_path);
+    assert(FileManager::isTemporaryPath(temporary_path) && !FileManager::isTemporaryPath(file_path));
+    // The clients cannot name a temporary file nor a file outside their directory
+    assert(FileManager::isValidFileName(file_path) && !FileManager::isValidFileName(temporary_path));
+    assert(!FileManager::isValidFileName("../test_5.txt") && !FileManager::isValidFileName("dir/test_5.txt"));
+    assert(!FileManager::isValidFileName("..") && !FileManager::isValidFileName(""));
+
+    // Write the temporary file
+    cout << "Writing the temporary file of test_5.txt" << endl;
+    int res = FileManager::allocateFile(temporary_path, 0);
+    assert(res == 0);
+    FileManager fm_write(temporary_path, FileManager::OpenMode::UPDATE);
+    res = fm_write.writeChunk((uint8_t *) content, static_cast<streamsize>(strlen(content)));
+    assert(res == 0);
+    fm_write.closeFile();
+    // The temporary file is not listed
+    assert(FileManager::getFilesList(".").find(temporary_path) == string::npos);
+
+    // Commit the file with its final name
+    res = FileManager::commitFile(temporary_path, file_path);
+    assert(res == 0);
+    assert(!FileManager::isFilePresent(temporary_path));
+    assert(FileManager::computeFileSize(file_path) == static_cast<streamsize>(strlen(content)));
+
+    // A file cannot replace an existing one
+    res = FileManager::allocateFile(temporary_path, 0);
+    assert(res == 0);
+    res = FileManager::commitFile(temporary_path, file_path);
+    assert(res == -1);
+    assert(FileManager::computeFileSize(file_path) == static_cast<streamsize>(strlen(content)));
+
+    // The temporary files left behind are removed
+    FileManager::removeTemporaryFiles(".");
+    assert(!FileManager::isFilePresent(temporary_path) && FileManager::isFilePresent(file_path));
+    cout << "test_5.txt committed" << endl;
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+
+    // Delete the file
+    remove("test_5.txt");
+}
+
 int main() {
 
     cout << "\nRunning Test Scenario 1: \n" << endl;
@@ -193,6 +338,15 @@ int main() {
     cout << "\nRunning Test Scenario 3: \n" << endl;
     testIsStringValid();
 
+    cout << "\nRunning Test Scenario 4: \n" << endl;
+    testWriteRanges();
+
+    cout << "\nRunning Test Scenario 5: \n" << endl;
+    testMappedRead();
+
+    cout << "\nRunning Test Scenario 6: \n" << endl;
+    testCommitFile();
+
     return 0;
 }
 
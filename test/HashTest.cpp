@@ -1,5 +1,7 @@
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include "Hash.h"
 
 using namespace std;
@@ -29,8 +31,81 @@ void generateSHA256Test() {
     delete[] digest;
 }
 
+void streamingHashTest() {
+    unsigned char input_buffer[] = "Hello, World!";
+    size_t input_buffer_size = sizeof(input_buffer);
+    unsigned char* expected_digest = nullptr;
+    unsigned int expected_digest_size = 0;
+    Hash::generateSHA256(input_buffer, input_buffer_size, expected_digest, expected_digest_size);
+
+    // The data received in pieces has the same digest as the whole data
+    Hash hash;
+    unsigned char digest[Hash::DIGEST_LEN];
+    int res = hash.update(input_buffer, 5);
+    assert(res == 0);
+    res = hash.update(input_buffer + 5, input_buffer_size - 5);
+    assert(res == 0);
+    res = hash.finalize(digest);
+    assert(res == 0);
+    assert(expected_digest_size == Hash::DIGEST_LEN && memcmp(digest, expected_digest, Hash::DIGEST_LEN) == 0);
+    cout << "streamingHashTest() - Digest of the pieces matches!" << endl;
+
+    // The hasher is reused for a new digest
+    res = hash.init();
+    assert(res == 0);
+    hash.update(input_buffer, input_buffer_size);
+    hash.finalize(digest);
+    assert(memcmp(digest, expected_digest, Hash::DIGEST_LEN) == 0);
+    cout << "streamingHashTest() passed!" << endl;
+
+    delete[] expected_digest;
+}
+
+void treeHashTest() {
+    // 10 leaves of 1000 bytes and a last leaf of 500 bytes
+    const size_t leaf_size = 1000;
+    vector<unsigned char> data(10 * leaf_size + 500);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<unsigned char>(i * 31);
+    }
+
+    // The digest does not depend on the number of threads
+    unsigned char single_thread_digest[Hash::DIGEST_LEN];
+    unsigned char parallel_digest[Hash::DIGEST_LEN];
+    int res = TreeHash::generateTreeSHA256(data.data(), data.size(), leaf_size, 1, single_thread_digest);
+    assert(res == 0);
+    res = TreeHash::generateTreeSHA256(data.data(), data.size(), leaf_size, 4, parallel_digest);
+    assert(res == 0);
+    assert(memcmp(single_thread_digest, parallel_digest, Hash::DIGEST_LEN) == 0);
+    cout << "treeHashTest() - Parallel digest matches!" << endl;
+
+    // Nor on the order of the leaves
+    TreeHash tree_hash(11);
+    unsigned char digest[Hash::DIGEST_LEN];
+    for (size_t i = 11; i > 1; --i) {
+        size_t offset = (i - 1) * leaf_size;
+        tree_hash.hashLeaf(i - 1, data.data() + offset, min(leaf_size, data.size() - offset));
+    }
+    // A missing leaf is detected
+    res = tree_hash.finalize(digest);
+    assert(res == -1);
+    tree_hash.hashLeaf(0, data.data(), leaf_size);
+    res = tree_hash.finalize(digest);
+    assert(res == 0);
+    assert(memcmp(digest, parallel_digest, Hash::DIGEST_LEN) == 0);
+
+    // A modified leaf changes the digest
+    data[leaf_size * 5] ^= 1;
+    res = TreeHash::generateTreeSHA256(data.data(), data.size(), leaf_size, 4, digest);
+    assert(res == 0);
+    assert(memcmp(digest, parallel_digest, Hash::DIGEST_LEN) != 0);
+    cout << "treeHashTest() passed!" << endl;
+}
+
 int main() {
     generateSHA256Test();
+    streamingHashTest();
+    treeHashTest();
     return 0;
 }
 
@@ -0,0 +1,77 @@
+#include "KeyRegistry.h"
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+const string TEST_PUBLIC_KEYS_PATH = "key_registry_test/";
+const string SERVER_PRIVATE_KEY_PATH = "../resources/private_keys/Server_key.pem";
+
+void testLoadAndReload() {
+    filesystem::create_directories(TEST_PUBLIC_KEYS_PATH);
+    filesystem::copy_file("../resources/public_keys/Francesco_key.pem", TEST_PUBLIC_KEYS_PATH + "Francesco_key.pem");
+
+    // The keys are loaded by the constructor
+    KeyRegistry registry(TEST_PUBLIC_KEYS_PATH, SERVER_PRIVATE_KEY_PATH);
+    assert(registry.getUsersNum() == 1);
+    assert(registry.hasUser("Francesco") && !registry.hasUser("Luca"));
+    EVP_PKEY* public_key = registry.getUserPublicKey("Francesco");
+    assert(public_key != nullptr);
+    assert(registry.getUserPublicKey("Luca") == nullptr);
+    EVP_PKEY* private_key = registry.getServerPrivateKey();
+    assert(private_key != nullptr);
+    EVP_PKEY_free(private_key);
+
+    // A new user is seen after a reload, the keys taken before stay valid
+    filesystem::copy_file("../resources/public_keys/Luca_key.pem", TEST_PUBLIC_KEYS_PATH + "Luca_key.pem");
+    int res = registry.reload();
+    assert(res == 0);
+    assert(registry.getUsersNum() == 2 && registry.hasUser("Luca"));
+    assert(EVP_PKEY_get_bits(public_key) > 0);
+    EVP_PKEY_free(public_key);
+    cout << "Users after the reload: " << registry.getUsersNum() << endl;
+
+    // A removed user is forgotten by the watcher without an explicit reload
+    registry.startWatcher();
+    this_thread::sleep_for(chrono::milliseconds(100));
+    filesystem::remove(TEST_PUBLIC_KEYS_PATH + "Luca_key.pem");
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while (registry.hasUser("Luca") && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    assert(!registry.hasUser("Luca") && registry.hasUser("Francesco"));
+
+    filesystem::remove_all(TEST_PUBLIC_KEYS_PATH);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testFailedReload() {
+    filesystem::create_directories(TEST_PUBLIC_KEYS_PATH);
+    filesystem::copy_file("../resources/public_keys/Francesco_key.pem", TEST_PUBLIC_KEYS_PATH + "Francesco_key.pem");
+
+    // Without the server private key nothing is loaded
+    KeyRegistry registry(TEST_PUBLIC_KEYS_PATH, "missing_key.pem");
+    assert(registry.getUsersNum() == 0);
+    assert(registry.getServerPrivateKey() == nullptr);
+    int res = registry.reload();
+    assert(res == -1);
+
+    filesystem::remove_all(TEST_PUBLIC_KEYS_PATH);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+
+    cout << "\nRunning Test Scenario 1: \n" << endl;
+    testLoadAndReload();
+
+    cout << "\nRunning Test Scenario 2: \n" << endl;
+    testFailedReload();
+
+    return 0;
+}
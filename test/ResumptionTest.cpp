@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <openssl/rand.h>
+#include "Resumption.h"
+#include "Authentication.h"
+#include "CodesManager.h"
+
+using namespace std;
+
+void sealAndUnsealTest() {
+    unsigned char ticket_key[Config::AES_KEY_LEN];
+    RAND_bytes(ticket_key, Config::AES_KEY_LEN);
+    uint8_t resumption_secret[RESUMPTION_SECRET_LEN];
+    RAND_bytes(resumption_secret, RESUMPTION_SECRET_LEN);
+
+    // Seal a ticket
+    SessionTicket ticket("Francesco", resumption_secret, 1234567890123ULL, 65536,
+                         static_cast<uint8_t>(CipherSuite::CHACHA20_POLY1305));
+    uint8_t* sealed_ticket = ticket.seal(ticket_key);
+    assert(sealed_ticket != nullptr);
+    cout << "sealAndUnsealTest() - Ticket sealed!" << endl;
+
+    // Unseal it with the same key
+    SessionTicket unsealed_ticket;
+    int res = SessionTicket::unseal(ticket_key, sealed_ticket, unsealed_ticket);
+    assert(res == 0);
+    assert(strcmp(unsealed_ticket.getMUsername(), "Francesco") == 0);
+    assert(memcmp(unsealed_ticket.getMResumptionSecret(), resumption_secret, RESUMPTION_SECRET_LEN) == 0);
+    assert(unsealed_ticket.getMExpirationTime() == 1234567890123ULL);
+    assert(unsealed_ticket.getMChunkSize() == 65536);
+    assert(unsealed_ticket.getMCipherSuite() == static_cast<uint8_t>(CipherSuite::CHACHA20_POLY1305));
+    cout << "sealAndUnsealTest() - Ticket unsealed!" << endl;
+
+    // A tampered ticket is rejected
+    sealed_ticket[SEALED_TICKET_LEN - 1] ^= 0x01;
+    res = SessionTicket::unseal(ticket_key, sealed_ticket, unsealed_ticket);
+    assert(res == -1);
+    cout << "sealAndUnsealTest() - Tampered ticket rejected!" << endl;
+
+    // A ticket sealed with another key is rejected
+    sealed_ticket[SEALED_TICKET_LEN - 1] ^= 0x01;
+    unsigned char other_key[Config::AES_KEY_LEN];
+    RAND_bytes(other_key, Config::AES_KEY_LEN);
+    res = SessionTicket::unseal(other_key, sealed_ticket, unsealed_ticket);
+    assert(res == -1);
+    cout << "sealAndUnsealTest() - Ticket with wrong key rejected!" << endl;
+    cout << "sealAndUnsealTest() passed!" << endl;
+
+    delete[] sealed_ticket;
+}
+
+void deriveSessionKeyTest() {
+    uint8_t resumption_secret[RESUMPTION_SECRET_LEN];
+    uint8_t client_nonce[RESUMPTION_NONCE_LEN];
+    uint8_t server_nonce[RESUMPTION_NONCE_LEN];
+    RAND_bytes(resumption_secret, RESUMPTION_SECRET_LEN);
+    RAND_bytes(client_nonce, RESUMPTION_NONCE_LEN);
+    RAND_bytes(server_nonce, RESUMPTION_NONCE_LEN);
+
+    // Both peers derive the same key
+    unsigned char client_key[Config::AES_KEY_LEN];
+    unsigned char server_key[Config::AES_KEY_LEN];
+    SessionTicket::deriveSessionKey(resumption_secret, client_nonce, server_nonce, client_key);
+    SessionTicket::deriveSessionKey(resumption_secret, client_nonce, server_nonce, server_key);
+    assert(memcmp(client_key, server_key, Config::AES_KEY_LEN) == 0);
+    cout << "deriveSessionKeyTest() - Same key on both peers!" << endl;
+
+    // A new server nonce gives a new key
+    server_nonce[0] ^= 0x01;
+    SessionTicket::deriveSessionKey(resumption_secret, client_nonce, server_nonce, server_key);
+    assert(memcmp(client_key, server_key, Config::AES_KEY_LEN) != 0);
+    cout << "deriveSessionKeyTest() - Fresh key for every session!" << endl;
+    cout << "deriveSessionKeyTest() passed!" << endl;
+}
+
+void resumptionM1SizeTest() {
+    // The server reads the fixed fields of AuthenticationM1 before telling the first messages apart
+    assert(AuthenticationM1::getHeaderSize() <= ResumptionM1::getMessageSize());
+    assert(sizeof(uint8_t) + SEALED_TICKET_LEN + RESUMPTION_NONCE_LEN <= ResumptionM1::getMessageSize());
+    cout << "resumptionM1SizeTest() passed!" << endl;
+}
+
+int main() {
+    sealAndUnsealTest();
+    deriveSessionKeyTest();
+    resumptionM1SizeTest();
+    return 0;
+}
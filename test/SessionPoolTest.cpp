@@ -0,0 +1,115 @@
+#include "SessionPool.h"
+#include "Config.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Connection of a session echoing every byte of its client: the pool serves the server end, the test acts as
+ * the client.
+ */
+struct EchoSession {
+    int server_socket;
+    int client_socket;
+};
+
+EchoSession openSession(SessionPool &pool, atomic<int> &released) {
+    int sockets[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+    assert(res == 0);
+    // A client that is never answered fails the test instead of hanging it
+    timeval timeout{};
+    timeout.tv_sec = 5;
+    setsockopt(sockets[1], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int server_socket = sockets[0];
+    bool submitted = pool.submit(server_socket, [server_socket] {
+        uint8_t byte;
+        if (recv(server_socket, &byte, 1, 0) != 1) {
+            return -1;
+        }
+        return send(server_socket, &byte, 1, 0) == 1 ? 0 : -1;
+    }, [server_socket, &released] {
+        close(server_socket);
+        released++;
+    });
+    assert(submitted);
+    return {sockets[0], sockets[1]};
+}
+
+bool echo(const EchoSession &session, uint8_t byte) {
+    uint8_t reply = 0;
+    return send(session.client_socket, &byte, 1, 0) == 1 && recv(session.client_socket, &reply, 1, 0) == 1 &&
+           reply == byte;
+}
+
+void testIdleSessionsDoNotHoldWorkers() {
+    atomic<int> released{0};
+    SessionPool pool(Config::SESSION_WORKERS, Config::SESSION_QUEUE_LEN);
+
+    // Open more sessions than workers, each served once and then left idle
+    const unsigned int IDLE_SESSIONS_NUM = Config::SESSION_WORKERS * 2;
+    vector<EchoSession> idle_sessions;
+    for (unsigned int i = 0; i < IDLE_SESSIONS_NUM; ++i) {
+        idle_sessions.push_back(openSession(pool, released));
+        assert(echo(idle_sessions.back(), static_cast<uint8_t>(i)));
+    }
+    assert(pool.getSessionsNum() == IDLE_SESSIONS_NUM);
+
+    // A new client is still served
+    auto start = chrono::steady_clock::now();
+    EchoSession new_session = openSession(pool, released);
+    assert(echo(new_session, 0xAA));
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    cout << "Idle sessions: " << IDLE_SESSIONS_NUM << ", workers: " << pool.getWorkersNum()
+         << ", new client served in " << elapsed << " ms" << endl;
+
+    // The idle sessions are served again when their clients come back
+    for (unsigned int i = 0; i < IDLE_SESSIONS_NUM; ++i) {
+        assert(echo(idle_sessions[i], static_cast<uint8_t>(i + 1)));
+    }
+
+    // A client closing its connection closes the session
+    close(new_session.client_socket);
+    while (released < 1) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    assert(pool.getSessionsNum() == IDLE_SESSIONS_NUM);
+
+    // The shutdown releases the idle sessions
+    pool.shutdown();
+    assert(released == static_cast<int>(IDLE_SESSIONS_NUM) + 1);
+    assert(pool.getSessionsNum() == 0);
+    for (const EchoSession &session : idle_sessions) {
+        close(session.client_socket);
+    }
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testSubmitAfterShutdown() {
+    SessionPool pool(2, 4);
+    pool.shutdown();
+    bool res = pool.submit(-1, [] { return 0; }, [] {});
+    assert(!res);
+    cout << "Session rejected after shutdown" << endl;
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+    cout << "--------------------------------------------" << endl;
+    cout << "SessionPoolTest - Test idle sessions do not hold the workers" << endl;
+    testIdleSessionsDoNotHoldWorkers();
+    cout << "SessionPoolTest - Test submit after shutdown" << endl;
+    testSubmitAfterShutdown();
+    return 0;
+}
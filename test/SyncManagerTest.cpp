@@ -0,0 +1,130 @@
+#include "SyncManager.h"
+#include <atomic>
+#include <cassert>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+void testSync() {
+    SyncManager* sync_manager = SyncManager::getInstance();
+    assert(sync_manager == SyncManager::getInstance());
+
+    // A written file is flushed
+    int file_descriptor = open("sync_test.txt", O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    assert(file_descriptor != -1);
+    assert(write(file_descriptor, "Hello, World!", 13) == 13);
+    int res = sync_manager->sync(file_descriptor);
+    assert(res == 0);
+    close(file_descriptor);
+    remove("sync_test.txt");
+
+    // The flush of an invalid descriptor fails
+    res = sync_manager->sync(-1);
+    assert(res == -1);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testParallelFlushes() {
+    SyncManager* sync_manager = SyncManager::getInstance();
+    uint64_t initial_requests_num = sync_manager->getRequestsNum();
+    uint64_t initial_commits_num = sync_manager->getCommitsNum();
+
+    // Many sessions flush files of a few MB at the same time, once they have all written them
+    const unsigned int sessions_num = 16;
+    const size_t file_size = 4 * 1024 * 1024;
+    atomic<unsigned int> written_num(0);
+    vector<thread> sessions;
+    for (unsigned int i = 0; i < sessions_num; ++i) {
+        sessions.emplace_back([sync_manager, i, file_size, &written_num] {
+            string file_name = "sync_test_" + to_string(i) + ".txt";
+            int file_descriptor = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+            assert(file_descriptor != -1);
+            vector<char> data(file_size, static_cast<char>('a' + i));
+            assert(write(file_descriptor, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+            written_num++;
+            while (written_num < sessions_num) {
+                this_thread::yield();
+            }
+            int res = sync_manager->sync(file_descriptor, true);
+            assert(res == 0);
+            close(file_descriptor);
+            remove(file_name.c_str());
+        });
+    }
+    for (thread& session : sessions) {
+        session.join();
+    }
+
+    // Every file is flushed by its own session, and the flushes overlap instead of running one after the other
+    uint64_t requests_num = sync_manager->getRequestsNum() - initial_requests_num;
+    uint64_t commits_num = sync_manager->getCommitsNum() - initial_commits_num;
+    unsigned int max_active_flushes = sync_manager->getMaxActiveFlushesNum();
+    cout << "Flushes requested: " << requests_num << ", executed: " << commits_num
+         << ", at most " << max_active_flushes << " at the same time" << endl;
+    assert(requests_num == sessions_num);
+    assert(commits_num == requests_num);
+    assert(max_active_flushes > 1);
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testDirectoryGroupCommit() {
+    SyncManager* sync_manager = SyncManager::getInstance();
+    uint64_t initial_requests_num = sync_manager->getRequestsNum();
+    uint64_t initial_commits_num = sync_manager->getCommitsNum();
+
+    // Many sessions publish a file in the same directory and flush it at the same time
+    const unsigned int sessions_num = 16;
+    vector<thread> sessions;
+    for (unsigned int i = 0; i < sessions_num; ++i) {
+        sessions.emplace_back([sync_manager, i] {
+            string file_name = "sync_test_dir_" + to_string(i) + ".txt";
+            int file_descriptor = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+            assert(file_descriptor != -1);
+            close(file_descriptor);
+            int directory_descriptor = open(".", O_RDONLY | O_DIRECTORY);
+            assert(directory_descriptor != -1);
+            int res = sync_manager->sync(directory_descriptor);
+            assert(res == 0);
+            close(directory_descriptor);
+            remove(file_name.c_str());
+        });
+    }
+    for (thread& session : sessions) {
+        session.join();
+    }
+
+    // Every request is committed, the concurrent ones of the directory by shared flushes
+    uint64_t requests_num = sync_manager->getRequestsNum() - initial_requests_num;
+    uint64_t commits_num = sync_manager->getCommitsNum() - initial_commits_num;
+    cout << "Directory flushes requested: " << requests_num << ", executed: " << commits_num << endl;
+    assert(requests_num == sessions_num);
+    assert(commits_num >= 1 && commits_num <= requests_num);
+
+    SyncManager::deleteInstance();
+
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+
+    cout << "\nRunning Test Scenario 1: \n" << endl;
+    testSync();
+
+    cout << "\nRunning Test Scenario 2: \n" << endl;
+    testParallelFlushes();
+
+    cout << "\nRunning Test Scenario 3: \n" << endl;
+    testDirectoryGroupCommit();
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "UringSocketManager.h"
+#include "Config.h"
+
+using namespace std;
+
+#define MSG_NUM 6
+
+/**
+ * Queue several messages (bigger than the socket buffers) and send them with a single flush,
+ * while the peer receives them with queued receives.
+ */
+void testBatchedTransfer() {
+    int descriptors[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors);
+    assert(res == 0);
+    UringSocketManager sender(descriptors[0]);
+    UringSocketManager receiver(descriptors[1]);
+
+    // Messages of different sizes, each filled with its own index
+    vector<vector<uint8_t>> messages;
+    for (int i = 0; i < MSG_NUM; ++i) {
+        messages.emplace_back(Config::CHUNK_SIZE / (i + 1) + i, static_cast<uint8_t>(i));
+    }
+
+    thread sender_thread([&sender, &messages] {
+        for (auto &message : messages) {
+            int res = sender.queueSend(message.data(), message.size());
+            assert(res == 0);
+        }
+        int res = sender.flush();
+        assert(res == 0);
+    });
+
+    vector<vector<uint8_t>> received;
+    for (auto &message : messages) {
+        received.emplace_back(message.size(), 0xff);
+    }
+    for (auto &buffer : received) {
+        res = receiver.queueReceive(buffer.data(), buffer.size());
+        assert(res == 0);
+    }
+    res = receiver.flush();
+    assert(res == 0);
+    sender_thread.join();
+
+    for (int i = 0; i < MSG_NUM; ++i) {
+        assert(received[i] == messages[i]);
+    }
+    cout << "Received " << MSG_NUM << " messages in order" << endl;
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+/**
+ * Single send and receive calls behave like the ones of the POSIX SocketManager.
+ */
+void testSendAndReceive() {
+    int descriptors[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors);
+    assert(res == 0);
+    UringSocketManager sender(descriptors[0]);
+    UringSocketManager receiver(descriptors[1]);
+
+    uint8_t message[] = "hello";
+    uint8_t buffer[sizeof(message)];
+    res = sender.send(message, sizeof(message));
+    assert(res == 0);
+    res = receiver.receive(buffer, sizeof(buffer));
+    assert(res == 0);
+    assert(memcmp(message, buffer, sizeof(message)) == 0);
+
+    // The peer closes the connection
+    shutdown(descriptors[0], SHUT_WR);
+    res = receiver.receive(buffer, sizeof(buffer));
+    assert(res == -2);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+/**
+ * Send messages made of a header and a payload with vectored sends, on both transports,
+ * and receive each of them as a single buffer.
+ */
+void testVectoredTransfer() {
+    for (bool uring : {false, true}) {
+        int descriptors[2];
+        int res = socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors);
+        assert(res == 0);
+        SocketManager *sender = uring ? new UringSocketManager(descriptors[0]) : new SocketManager(descriptors[0]);
+        UringSocketManager receiver(descriptors[1]);
+
+        // Each message has a header with its index and a payload bigger than the socket buffers
+        vector<uint8_t> headers(MSG_NUM);
+        vector<vector<uint8_t>> payloads;
+        for (int i = 0; i < MSG_NUM; ++i) {
+            headers[i] = static_cast<uint8_t>(i);
+            payloads.emplace_back(Config::CHUNK_SIZE / (i + 1), static_cast<uint8_t>(0xa0 + i));
+        }
+
+        thread sender_thread([sender, &headers, &payloads] {
+            for (int i = 0; i < MSG_NUM; ++i) {
+                iovec buffers[] = {{&headers[i], 1}, {payloads[i].data(), payloads[i].size()}};
+                int res = sender->queueSend(buffers, 2);
+                assert(res == 0);
+            }
+            int res = sender->flush();
+            assert(res == 0);
+        });
+
+        for (int i = 0; i < MSG_NUM; ++i) {
+            vector<uint8_t> buffer(1 + payloads[i].size());
+            res = receiver.receive(buffer.data(), buffer.size());
+            assert(res == 0);
+            assert(buffer[0] == headers[i]);
+            assert(memcmp(buffer.data() + 1, payloads[i].data(), payloads[i].size()) == 0);
+        }
+        sender_thread.join();
+        delete sender;
+        cout << "Received " << MSG_NUM << " vectored messages with the " << (uring ? "io_uring" : "POSIX")
+             << " transport" << endl;
+    }
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+    if (!UringSocketManager::isSupported()) {
+        cout << "UringSocketManagerTest - io_uring not supported, test skipped" << endl;
+        return 0;
+    }
+    cout << "--------------------------------------------" << endl;
+    cout << "UringSocketManagerTest - Test send and receive" << endl;
+    testSendAndReceive();
+    cout << "UringSocketManagerTest - Test batched transfer" << endl;
+    testBatchedTransfer();
+    cout << "UringSocketManagerTest - Test vectored transfer" << endl;
+    testVectoredTransfer();
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+void testAllTasksExecuted() {
+    atomic<int> executed{0};
+    const int TASKS_NUM = 1000;
+
+    // Bounded queue smaller than the number of tasks: submit() must block and resume
+    WorkerPool pool(4, 8);
+    assert(pool.getWorkersNum() == 4);
+    for (int i = 0; i < TASKS_NUM; ++i) {
+        bool res = pool.submit([&executed] { executed++; });
+        assert(res);
+    }
+    pool.shutdown();
+
+    cout << "Executed tasks: " << executed << endl;
+    assert(executed == TASKS_NUM);
+    assert(pool.getWorkersNum() == 0);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testBoundedConcurrency() {
+    atomic<int> running{0};
+    atomic<int> max_running{0};
+
+    WorkerPool pool(3, 0);
+    for (int i = 0; i < 30; ++i) {
+        pool.submit([&running, &max_running] {
+            int now = ++running;
+            int max = max_running;
+            while (now > max && !max_running.compare_exchange_weak(max, now)) {
+            }
+            this_thread::sleep_for(chrono::milliseconds(5));
+            running--;
+        });
+    }
+    pool.shutdown();
+
+    cout << "Max concurrent tasks: " << max_running << endl;
+    assert(max_running <= 3);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testSubmitAfterShutdown() {
+    WorkerPool pool(2, 4);
+    pool.shutdown();
+    bool res = pool.submit([] {});
+    assert(!res);
+    cout << "Task rejected after shutdown" << endl;
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+void testExceptionInTask() {
+    atomic<int> executed{0};
+    WorkerPool pool(1, 0);
+    pool.submit([] { throw -1; });
+    pool.submit([&executed] { executed++; });
+    pool.shutdown();
+    // The worker survives the exception and serves the next task
+    assert(executed == 1);
+    cout << "\n[+] Test Passed!" << endl;
+    cout << "--------------------------------------------" << endl;
+}
+
+int main() {
+    cout << "--------------------------------------------" << endl;
+    cout << "WorkerPoolTest - Test all tasks executed" << endl;
+    testAllTasksExecuted();
+    cout << "WorkerPoolTest - Test bounded concurrency" << endl;
+    testBoundedConcurrency();
+    cout << "WorkerPoolTest - Test submit after shutdown" << endl;
+    testSubmitAfterShutdown();
+    cout << "WorkerPoolTest - Test exception in task" << endl;
+    testExceptionInTask();
+    return 0;
+}